@@ -0,0 +1,86 @@
+#include "Checkpoint.hpp"
+#include <EEPROM.h>
+
+Checkpoint::Checkpoint() {}
+
+// PUBLIC
+
+void Checkpoint::begin() {
+    EEPROM.get(CHECKPOINT_EEPROM_ADDR, this->_data);
+}
+
+bool Checkpoint::valid() {
+    return _data.magic == CHECKPOINT_MAGIC && _data.version == CHECKPOINT_VERSION;
+}
+
+void Checkpoint::save(Solenoid &solenoid, const Sections &sections, const WindPattern &pattern, uint32_t stepCount, uint32_t subStepCount, int32_t carriagePosition, bool direction, bool mirrored, uint32_t layer) {
+    this->stage(solenoid, sections, pattern, mirrored);
+    this->progress(stepCount, subStepCount, carriagePosition, direction, layer);
+    this->commit();
+}
+
+void Checkpoint::stage(Solenoid &solenoid, const Sections &sections, const WindPattern &pattern, bool mirrored) {
+    this->_staged.magic = CHECKPOINT_MAGIC;
+    this->_staged.version = CHECKPOINT_VERSION;
+    this->_staged.gauge = solenoid.getGauge();
+    this->_staged.length = solenoid.getLength();
+    this->_staged.radius = solenoid.getRadius();
+    this->_staged.inductance = solenoid.getInductance();
+    this->_staged.mirrored = mirrored;
+    this->_staged.pattern = pattern.getType();
+    this->_staged.pitchCount = pattern.pitchCount();
+    for (uint8_t i = 0; i < PATTERN_TABLE_SIZE; i++) {
+        this->_staged.pitches[i] = i < pattern.pitchCount() ? pattern.pitches()[i] : 0;
+    }
+    this->_staged.sectionCount = sections.count();
+    this->_sections = &sections;
+}
+
+void Checkpoint::commit() {
+    if (_sections == nullptr) {
+        return;
+    }
+
+    const volatile Progress &last = _progress[_current];
+    this->_data = _staged;
+    this->_data.stepCount = last.stepCount;
+    this->_data.subStepCount = last.subStepCount;
+    this->_data.carriagePosition = last.carriagePosition;
+    this->_data.direction = last.direction;
+    this->_data.layer = last.layer;
+
+    // put() only rewrites bytes that changed
+    for (uint8_t i = 0; i < _sections->count(); i++) {
+        EEPROM.put(CHECKPOINT_SECTIONS_EEPROM_ADDR + i * sizeof(Section), _sections->get(i));
+    }
+    EEPROM.put(CHECKPOINT_EEPROM_ADDR, this->_data);
+}
+
+void Checkpoint::restore(Solenoid &solenoid, Sections &sections, WindPattern &pattern) {
+    solenoid.setLength(_data.length);
+    solenoid.setRadius(_data.radius);
+    solenoid.setInductance(_data.inductance);
+    solenoid.setGauge(static_cast<WireGauge>(_data.gauge));
+    pattern.setType(static_cast<PatternType>(_data.pattern));
+    pattern.setPitches(_data.pitches, _data.pitchCount);
+
+    sections.clear();
+    for (uint8_t i = 0; i < _data.sectionCount && i < MAX_SECTIONS; i++) {
+        Section section;
+        EEPROM.get(CHECKPOINT_SECTIONS_EEPROM_ADDR + i * sizeof(Section), section);
+        sections.add(section);
+    }
+}
+
+void Checkpoint::clear() {
+    this->_sections = nullptr;
+    if (!this->valid()) {
+        return;
+    }
+    this->_data.magic = 0;
+    EEPROM.put(CHECKPOINT_EEPROM_ADDR, this->_data.magic);
+}
+
+const JobCheckpoint &Checkpoint::data() {
+    return _data;
+}
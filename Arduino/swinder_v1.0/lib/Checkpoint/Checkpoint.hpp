@@ -0,0 +1,154 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <Arduino.h>
+#include <Solenoid.hpp>
+#include <WindPattern.hpp>
+#include <Sections.hpp>
+
+#define CHECKPOINT_EEPROM_ADDR 0 // Up to 64 bytes, FaultMonitor counters follow
+#define CHECKPOINT_SECTIONS_EEPROM_ADDR 2048 // MAX_SECTIONS sections of a multi-section job, after JobLog
+#define CHECKPOINT_MAGIC 0x5357 // "SW"
+#define CHECKPOINT_VERSION 4
+
+/**
+ * Everything needed to continue an interrupted winding job.
+ * Positions are relative to the carriage offset, same as in spin(), and are
+ * those of the plan, mirrored ones included.
+ */
+struct JobCheckpoint {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t gauge;
+    uint32_t length;
+    uint32_t radius;
+    uint32_t inductance;
+    uint32_t stepCount;
+    uint32_t subStepCount;
+    int32_t carriagePosition;
+    bool direction;
+    bool mirrored; // Wound from the far end of the winding area
+    uint8_t pattern;
+    uint8_t pitchCount;
+    uint8_t pitches[PATTERN_TABLE_SIZE];
+    uint8_t sectionCount; // 0 for a single solenoid job, the sections are stored apart
+    uint32_t layer;
+};
+
+class Checkpoint {
+public:
+    /**
+     * @brief Create a new instance of the job checkpoint store.
+     */
+    Checkpoint();
+
+    /**
+     * @brief Loads the stored checkpoint from EEPROM
+     */
+    void begin();
+
+    /**
+     * @brief Checks if there is an unfinished job stored
+     *
+     * @returns true if the stored checkpoint can be resumed
+     */
+    bool valid();
+
+    /**
+     * @brief Stores the progress of the current job
+     *
+     * Writes to EEPROM, only call on a stop (pause, fault), never per step
+     *
+     * @param solenoid parameters of the job being wound
+     * @param sections sections of the job, empty for a single solenoid job
+     * @param pattern layer pattern of the job
+     * @param stepCount completed SS steps
+     * @param subStepCount SS steps since the last CC step
+     * @param carriagePosition carriage position relative to the offset
+     * @param direction carriage direction, true = forward
+     * @param mirrored true if the job is wound from the far end of the winding area
+     * @param layer layer being wound
+     */
+    void save(Solenoid &solenoid, const Sections &sections, const WindPattern &pattern, uint32_t stepCount, uint32_t subStepCount, int32_t carriagePosition, bool direction, bool mirrored, uint32_t layer);
+
+    /**
+     * @brief Keeps the parameters of the job being wound in RAM for commit()
+     *
+     * Dropped by clear(), stage again if the job carries on after one
+     *
+     * @param solenoid parameters of the job being wound
+     * @param sections sections of the job, must stay unchanged until clear()
+     * @param pattern layer pattern of the job
+     * @param mirrored true if the job is wound from the far end of the winding area
+     */
+    void stage(Solenoid &solenoid, const Sections &sections, const WindPattern &pattern, bool mirrored);
+
+    /**
+     * @brief Keeps the progress of the job in RAM for commit(), a few stores
+     *
+     * Double buffered, an interrupt running commit() part way through still writes
+     * the last complete progress
+     *
+     * @param stepCount completed SS steps
+     * @param subStepCount SS steps since the last CC step
+     * @param carriagePosition carriage position relative to the offset
+     * @param direction carriage direction, true = forward
+     * @param layer layer being wound
+     */
+    inline void progress(uint32_t stepCount, uint32_t subStepCount, int32_t carriagePosition, bool direction, uint32_t layer) {
+        volatile Progress &next = _progress[_current ^ 1];
+        next.stepCount = stepCount;
+        next.subStepCount = subStepCount;
+        next.carriagePosition = carriagePosition;
+        next.direction = direction;
+        next.layer = layer;
+        this->_current ^= 1;
+    }
+
+    /**
+     * @brief Writes the staged job at its last progress to EEPROM
+     *
+     * Safe from an interrupt anywhere in the winding loop, does nothing if no job is staged
+     */
+    void commit();
+
+    /**
+     * @brief Restores the job parameters of the checkpoint
+     *
+     * @param solenoid solenoid to overwrite
+     * @param sections sections to overwrite
+     * @param pattern pattern to overwrite
+     */
+    void restore(Solenoid &solenoid, Sections &sections, WindPattern &pattern);
+
+    /**
+     * @brief Invalidates the stored checkpoint
+     */
+    void clear();
+
+    /**
+     * @brief Getter for the checkpoint data
+     *
+     * @returns stored checkpoint, only meaningful if valid()
+     */
+    const JobCheckpoint &data();
+
+private:
+    struct Progress {
+        uint32_t stepCount;
+        uint32_t subStepCount;
+        int32_t carriagePosition;
+        bool direction;
+        uint32_t layer;
+    };
+
+    JobCheckpoint _data;
+
+    // Job being wound, written by commit()
+    JobCheckpoint _staged;
+    const Sections *_sections = nullptr; // nullptr if no job is staged
+    volatile Progress _progress[2];
+    volatile uint8_t _current = 0; // Progress buffer last completed
+};
+
+#endif
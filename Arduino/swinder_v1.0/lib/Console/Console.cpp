@@ -0,0 +1,74 @@
+#include "Console.hpp"
+
+Console::Console() {}
+
+// PUBLIC
+
+void Console::begin(Stream &stream) {
+    this->_stream = &stream;
+    this->_lineLength = 0;
+}
+
+bool Console::addCommand(const char *name, const char *help, CommandHandler handler) {
+    if (_numCommands >= CONSOLE_MAX_COMMANDS) {
+        return false;
+    }
+    this->_commands[_numCommands++] = {name, help, handler};
+    return true;
+}
+
+void Console::poll() {
+    if (_stream == nullptr) {
+        return;
+    }
+
+    while (_stream->available() > 0) {
+        char c = _stream->read();
+        if (c == '\r') {
+            continue;
+        }
+        if (c == '\n') {
+            this->_line[_lineLength] = '\0';
+            this->dispatch();
+            this->_lineLength = 0;
+            continue;
+        }
+        // Overlong lines are truncated rather than split into two commands
+        if (_lineLength < CONSOLE_LINE_LENGTH - 1) {
+            this->_line[_lineLength++] = c;
+        }
+    }
+}
+
+Stream &Console::stream() {
+    return *_stream;
+}
+
+// PRIVATE
+
+void Console::dispatch() {
+    String line = String(_line);
+    line.trim();
+    if (line.length() == 0) {
+        return;
+    }
+
+    int split = line.indexOf(' ');
+    String name = split < 0 ? line : line.substring(0, split);
+    String args = split < 0 ? String("") : line.substring(split + 1);
+
+    if (name == "help") {
+        for (uint8_t i = 0; i < _numCommands; i++) {
+            _stream->println(String(_commands[i].name) + " - " + _commands[i].help);
+        }
+        return;
+    }
+
+    for (uint8_t i = 0; i < _numCommands; i++) {
+        if (name == _commands[i].name) {
+            _commands[i].handler(args);
+            return;
+        }
+    }
+    _stream->println("Unknown command: " + name);
+}
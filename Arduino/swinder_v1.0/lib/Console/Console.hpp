@@ -0,0 +1,65 @@
+#ifndef CONSOLE_HPP
+#define CONSOLE_HPP
+
+#include <Arduino.h>
+
+#define CONSOLE_MAX_COMMANDS 16
+#define CONSOLE_LINE_LENGTH 96
+
+typedef void (*CommandHandler)(String args);
+
+struct Command {
+    const char *name;
+    const char *help;
+    CommandHandler handler;
+};
+
+class Console {
+public:
+    /**
+     * @brief Create a new instance of the serial command console.
+     */
+    Console();
+
+    /**
+     * @brief Sets the stream commands are read from and replies are written to
+     *
+     * @param stream usually Serial
+     */
+    void begin(Stream &stream);
+
+    /**
+     * @brief Registers a command, "help" is built in
+     *
+     * @param name first word of the command line
+     * @param help one line description for help
+     * @param handler called with the rest of the line
+     * @returns false if the command table is full
+     */
+    bool addCommand(const char *name, const char *help, CommandHandler handler);
+
+    /**
+     * @brief Reads any pending characters and runs complete lines
+     *
+     * Never blocks, safe to call from screen loops
+     */
+    void poll();
+
+    /**
+     * @brief Getter for the console stream
+     *
+     * @returns stream replies should be printed to
+     */
+    Stream &stream();
+
+private:
+    void dispatch();
+
+    Stream *_stream = nullptr;
+    Command _commands[CONSOLE_MAX_COMMANDS];
+    uint8_t _numCommands = 0;
+    char _line[CONSOLE_LINE_LENGTH];
+    uint8_t _lineLength = 0;
+};
+
+#endif
@@ -0,0 +1,104 @@
+#include "DeadlineMonitor.hpp"
+#include <EEPROM.h>
+#include <string.h>
+
+DeadlineMonitor::DeadlineMonitor() {
+    memset(&this->_stored, 0, sizeof(_stored));
+    this->_stored.magic = DEADLINE_MAGIC;
+    memset(&this->_job, 0, sizeof(_job));
+}
+
+// PUBLIC
+
+void DeadlineMonitor::begin() {
+    Stored stored;
+    EEPROM.get(DEADLINE_EEPROM_ADDR, stored);
+    // Erased flash, or counters from before this layout
+    if (stored.magic != DEADLINE_MAGIC || stored.lifetime.worstSubsystem >= SUBSYSTEM_COUNT) {
+        return;
+    }
+    this->_stored = stored;
+}
+
+void DeadlineMonitor::reset() {
+    memset(&this->_job, 0, sizeof(_job));
+    this->_running = false;
+    this->_committed = false;
+}
+
+void DeadlineMonitor::start(uint32_t period, uint32_t now) {
+    this->_period = period;
+    this->_last = now;
+    this->_entered = now;
+    this->_active = Subsystem::SUB_KERNEL;
+    this->_longestSpan = 0;
+    this->_culprit = Subsystem::SUB_KERNEL;
+    this->_running = true;
+}
+
+void DeadlineMonitor::stop() {
+    this->_running = false;
+}
+
+void DeadlineMonitor::commit() {
+    this->_running = false;
+    if (_committed || _job.deadlines == 0) {
+        return;
+    }
+    this->_committed = true;
+
+    DeadlineStats &lifetime = this->_stored.lifetime;
+    lifetime.deadlines += _job.deadlines;
+    lifetime.overruns += _job.overruns;
+    if (_job.worstLateness > lifetime.worstLateness) {
+        lifetime.worstLateness = _job.worstLateness;
+        lifetime.worstSubsystem = _job.worstSubsystem;
+    }
+    for (uint8_t i = 0; i < SUBSYSTEM_COUNT; i++) {
+        lifetime.subsystemOverruns[i] += _job.subsystemOverruns[i];
+    }
+    this->save();
+}
+
+void DeadlineMonitor::recordWatchdogReset() {
+    this->_stored.watchdogResets++;
+    this->save();
+}
+
+const DeadlineStats &DeadlineMonitor::job() const {
+    return _job;
+}
+
+const DeadlineStats &DeadlineMonitor::lifetime() const {
+    return _stored.lifetime;
+}
+
+uint32_t DeadlineMonitor::watchdogResets() const {
+    return _stored.watchdogResets;
+}
+
+String DeadlineMonitor::subsystemName(Subsystem subsystem) {
+    switch (subsystem) {
+        case Subsystem::SUB_KERNEL: return "kernel";
+        case Subsystem::SUB_CONSOLE: return "console";
+        case Subsystem::SUB_DISPLAY: return "display";
+        case Subsystem::SUB_TRACE: return "trace";
+        case Subsystem::SUB_ESTIMATE: return "estimate";
+        default: return "unknown";
+    }
+}
+
+// PRIVATE
+
+FASTRUN void DeadlineMonitor::overrun(uint32_t lateness) {
+    this->_job.overruns++;
+    this->_job.subsystemOverruns[_culprit]++;
+    if (lateness > _job.worstLateness) {
+        this->_job.worstLateness = lateness;
+        this->_job.worstSubsystem = _culprit;
+    }
+}
+
+void DeadlineMonitor::save() {
+    EEPROM.put(DEADLINE_EEPROM_ADDR, this->_stored);
+}
@@ -0,0 +1,182 @@
+#ifndef DEADLINE_MONITOR_HPP
+#define DEADLINE_MONITOR_HPP
+
+#include <Arduino.h>
+
+#define DEADLINE_EEPROM_ADDR 2208 // After the wire table
+#define DEADLINE_MAGIC 0x4C44 // "DL"
+#define DEADLINE_SLACK 50 // us a deadline may be missed by before it counts as an overrun
+
+enum Subsystem { // What ran between two deadlines
+    SUB_KERNEL = 0, // Step generation and the loop itself
+    SUB_CONSOLE = 1,
+    SUB_DISPLAY = 2,
+    SUB_TRACE = 3,
+    SUB_ESTIMATE = 4,
+};
+
+#define SUBSYSTEM_COUNT 5
+
+struct DeadlineStats {
+    uint32_t deadlines; // Deadlines checked
+    uint32_t overruns;
+    uint32_t worstLateness; // us
+    uint8_t worstSubsystem;
+    uint32_t subsystemOverruns[SUBSYSTEM_COUNT];
+};
+
+/**
+ * Checks that the step loop comes round before its deadline, and blames the slowest
+ * subsystem that ran since the last one when it does not.
+ *
+ * A deadline is the previous tick plus the period, so one late step does not make
+ * the steps after it late. Counters are kept for the job and for the machine, the
+ * machine ones are saved with commit() along with the watchdog reset count.
+ */
+class DeadlineMonitor {
+public:
+    /**
+     * @brief Create a new instance of the deadline monitor, with nothing recorded.
+     */
+    DeadlineMonitor();
+
+    /**
+     * @brief Loads the machine counters from EEPROM
+     */
+    void begin();
+
+    /**
+     * @brief Clears the job counters, call when a job starts
+     */
+    void reset();
+
+    /**
+     * @brief Starts checking deadlines, call again after anything that stopped the loop
+     *
+     * @param period us between ticks
+     * @param now current time in us
+     */
+    void start(uint32_t period, uint32_t now);
+
+    /**
+     * @brief Changes the time between ticks, for a step loop with a varying rate
+     *
+     * @param period us from the last tick to the next
+     */
+    inline void setPeriod(uint32_t period) {
+        this->_period = period;
+    }
+
+    /**
+     * @brief Stops checking, the time until the next start() is not a deadline
+     */
+    void stop();
+
+    /**
+     * @brief Marks the start of a subsystem, it runs until the next enter() or tick()
+     *
+     * @param subsystem subsystem now running
+     * @param now current time in us
+     */
+    inline void enter(Subsystem subsystem, uint32_t now) {
+        this->close(now);
+        this->_active = subsystem;
+    }
+
+    /**
+     * @brief Marks the step loop back at its deadline, the step edge in GPIO stepping
+     *
+     * @param now current time in us
+     */
+    inline void tick(uint32_t now) {
+        if (!_running) {
+            return;
+        }
+        this->close(now);
+        this->_job.deadlines++;
+        const uint32_t gap = now - _last;
+        if (gap > _period + DEADLINE_SLACK) {
+            this->overrun(gap - _period);
+        }
+        this->_last = now;
+        this->_active = Subsystem::SUB_KERNEL;
+        this->_longestSpan = 0;
+        this->_culprit = Subsystem::SUB_KERNEL;
+    }
+
+    /**
+     * @brief Adds the job counters to the machine counters and saves them to EEPROM
+     * Once per job, the job counters stay readable until the next reset().
+     * Writes to EEPROM, do not call from the step loop
+     */
+    void commit();
+
+    /**
+     * @brief Counts a reset by the watchdog and saves it to EEPROM
+     */
+    void recordWatchdogReset();
+
+    /**
+     * @brief Getter for the counters of the current or last job
+     *
+     * @returns job counters
+     */
+    const DeadlineStats &job() const;
+
+    /**
+     * @brief Getter for the counters of every committed job
+     *
+     * @returns machine counters
+     */
+    const DeadlineStats &lifetime() const;
+
+    /**
+     * @brief Getter for the number of watchdog resets
+     *
+     * @returns resets since the counters were first saved
+     */
+    uint32_t watchdogResets() const;
+
+    /**
+     * @brief Provides a short name for a subsystem
+     *
+     * @param subsystem subsystem
+     * @returns name such as "console"
+     */
+    static String subsystemName(Subsystem subsystem);
+
+private:
+    // Ends the span of the running subsystem, the longest one since the tick is blamed
+    // if it took longer than the slack, otherwise the kernel is
+    inline void close(uint32_t now) {
+        const uint32_t span = now - _entered;
+        if (_active != Subsystem::SUB_KERNEL && span > DEADLINE_SLACK && span > _longestSpan) {
+            this->_longestSpan = span;
+            this->_culprit = _active;
+        }
+        this->_entered = now;
+    }
+
+    void overrun(uint32_t lateness);
+    void save();
+
+    struct Stored {
+        uint16_t magic;
+        uint32_t watchdogResets;
+        DeadlineStats lifetime;
+    };
+
+    Stored _stored;
+    DeadlineStats _job;
+
+    bool _running = false;
+    bool _committed = false;
+    uint32_t _period = 0; // us
+    uint32_t _last = 0; // us, last tick
+    uint32_t _entered = 0; // us, start of the active subsystem
+    Subsystem _active = Subsystem::SUB_KERNEL;
+    uint32_t _longestSpan = 0; // us, since the last tick
+    Subsystem _culprit = Subsystem::SUB_KERNEL;
+};
+
+#endif
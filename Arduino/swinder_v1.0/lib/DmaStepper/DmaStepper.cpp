@@ -0,0 +1,371 @@
+#include "DmaStepper.hpp"
+
+#if defined(__IMXRT1062__)
+
+// Word offsets of the GPIO registers
+#define GPIO_DR 0
+#define GPIO_GDIR 1
+#define GPIO_DR_SET 33
+#define GPIO_DR_CLEAR 34
+#define GPIO_DR_TOGGLE 35
+
+#define GPIO1_BASE 0x401B8000 // GPIO1-4 are 0x4000 apart, as are GPIO6-9
+#define GPIO6_BASE 0x42000000
+#define GPIO_SPACING 0x4000
+
+// One toggle word per slot and port, flushed from the data cache after every fill
+DMAMEM static unsigned int ssWave[DMA_WAVE_SLOTS] __attribute__((aligned(32)));
+DMAMEM static unsigned int ccWave[DMA_WAVE_SLOTS] __attribute__((aligned(32)));
+
+DmaStepper *DmaStepper::_active = nullptr;
+
+DmaStepper::DmaStepper() {}
+
+// PUBLIC
+
+bool DmaStepper::begin(uint8_t ssStepPin, uint8_t ccStepPin, uint8_t ccDirPin, bool ccForwardLevel) {
+    this->_ready = false;
+    if (!portPin(ssStepPin, _ssStep) || !portPin(ccStepPin, _ccStep) || !portPin(ccDirPin, _ccDir)) {
+        return false;
+    }
+    // The CC channel writes one toggle word for both of its pins
+    if (_ccStep.slow != _ccDir.slow) {
+        return false;
+    }
+
+    this->_ccForwardLevel = ccForwardLevel;
+    this->_ssChannel.begin();
+    this->_ccChannel.begin();
+    this->_underruns = 0;
+    this->_ready = true;
+    return true;
+}
+
+void DmaStepper::setForwardLevel(bool ccForwardLevel) {
+    this->_ccForwardLevel = ccForwardLevel;
+}
+
+void DmaStepper::attachTrace(StepTrace &trace) {
+    this->_trace = &trace;
+}
+
+void DmaStepper::start(WindKernel &kernel, uint32_t slotTime, uint16_t slotsPerStep) {
+    if (!_ready) {
+        return;
+    }
+
+    this->_kernel = &kernel;
+    this->_slotTime = slotTime < DRIVER_MIN_PULSE ? DRIVER_MIN_PULSE : slotTime;
+    this->_slotsPerStep = slotsPerStep < 2 ? 2 : slotsPerStep;
+    this->_playedSteps = 0;
+
+    // Smallest prescaler that fits the 16 bit counter
+    uint64_t counts = ((uint64_t) F_BUS_ACTUAL * _slotTime) / 1000000;
+    this->_prescale = 0;
+    while (counts > 0xFFFF && _prescale < 7) {
+        counts >>= 1;
+        this->_prescale++;
+    }
+    this->_periodCounts = counts > 0xFFFF ? 0xFFFF : counts;
+
+    // Hand the pins to the DMA accessible GPIO with STEP low and DIR matching the kernel
+    toSlow(_ssStep);
+    toSlow(_ccStep);
+    toSlow(_ccDir);
+    _ssStep.slow[GPIO_DR_CLEAR] = _ssStep.mask;
+    _ccStep.slow[GPIO_DR_CLEAR] = _ccStep.mask;
+    if (kernel.forward() ? _ccForwardLevel : !_ccForwardLevel) {
+        _ccDir.slow[GPIO_DR_SET] = _ccDir.mask;
+    } else {
+        _ccDir.slow[GPIO_DR_CLEAR] = _ccDir.mask;
+    }
+    this->_ssHigh = false;
+    this->_ccHigh = false;
+
+    // SS channel is paced by the timer and links to the CC channel after every slot
+    _ssChannel.disable();
+    _ccChannel.disable();
+    _ssChannel.sourceBuffer(ssWave, sizeof(ssWave));
+    _ssChannel.destination(*(volatile unsigned int *) &_ssStep.slow[GPIO_DR_TOGGLE]);
+    _ccChannel.sourceBuffer(ccWave, sizeof(ccWave));
+    _ccChannel.destination(*(volatile unsigned int *) &_ccStep.slow[GPIO_DR_TOGGLE]);
+    _ccChannel.triggerAtTransfersOf(_ssChannel);
+    _ssChannel.triggerAtHardwareEvent(DMAMUX_SOURCE_FLEXPWM2_WRITE0);
+    _ssChannel.interruptAtHalf();
+    _ssChannel.interruptAtCompletion();
+    _ssChannel.attachInterrupt(isr);
+    DmaStepper::_active = this;
+
+    this->_state[0] = HalfState::HALF_EMPTY;
+    this->_state[1] = HalfState::HALF_EMPTY;
+    this->_playing = 0;
+    this->fillHalf(0);
+    this->fillHalf(1);
+
+    _ccChannel.enable();
+    _ssChannel.enable();
+    this->startTimer();
+}
+
+FASTRUN bool DmaStepper::fill() {
+    if (_kernel == nullptr) {
+        return false;
+    }
+
+    // Record in play order, after an underrun both halves may have played
+    for (uint8_t i = 0; i < 2; i++) {
+        uint8_t half = _playing ^ i;
+        if (_state[half] == HalfState::HALF_PLAYED) {
+            this->_playedSteps += _ssSteps[half];
+            this->record(half, _steps[half]);
+            this->_state[half] = HalfState::HALF_EMPTY;
+        }
+    }
+
+    // Nothing left to play, pins left high are lowered by an extra half
+    if (_kernel->done() && !_ssHigh && !_ccHigh) {
+        if (_stopped && _state[0] == HalfState::HALF_EMPTY && _state[1] == HalfState::HALF_EMPTY) {
+            this->halt();
+            return false;
+        }
+        return true;
+    }
+
+    for (uint8_t i = 0; i < 2; i++) {
+        uint8_t half = _playing ^ i;
+        if (_state[half] == HalfState::HALF_EMPTY && (!_kernel->done() || _ssHigh || _ccHigh)) {
+            this->fillHalf(half);
+        }
+    }
+
+    // Buffers ran dry mid job, the ISR stopped on a half boundary so no step was torn
+    if (_stopped) {
+        this->_underruns++;
+        this->startTimer();
+    }
+    return true;
+}
+
+void DmaStepper::halt() {
+    if (_kernel == nullptr) {
+        return;
+    }
+
+    this->stopTimer();
+    // Let a transfer in flight and its interrupt finish
+    delayMicroseconds(DRIVER_MIN_PULSE);
+    _ssChannel.disable();
+    _ccChannel.disable();
+
+    for (uint8_t i = 0; i < 2; i++) {
+        uint8_t half = _playing ^ i;
+        if (_state[half] == HalfState::HALF_PLAYED) {
+            this->_playedSteps += _ssSteps[half];
+            this->record(half, _steps[half]);
+            this->_state[half] = HalfState::HALF_EMPTY;
+        }
+    }
+
+    // Rewind the kernel to the last step whose rising edge was played
+    if (_state[_playing] == HalfState::HALF_READY) {
+        int32_t played = (DMA_WAVE_SLOTS - (_ssChannel.TCD->CITER & 0x1FF)) - _playing * DMA_BLOCK_SLOTS;
+        if (played < 0) {
+            played = 0;
+        }
+        uint16_t steps = played / _slotsPerStep;
+        if (steps > _steps[_playing]) {
+            steps = _steps[_playing];
+        }
+        *_kernel = _snapshot[_playing];
+        this->record(_playing, steps);
+        // record() replays a copy, advance the kernel the same way
+        for (uint16_t i = 0; i < steps; i++) {
+            _kernel->next();
+        }
+        this->_playedSteps += _kernel->stepCount() - _snapshot[_playing].stepCount();
+    }
+    this->_state[0] = HalfState::HALF_EMPTY;
+    this->_state[1] = HalfState::HALF_EMPTY;
+
+    // Back to the fast GPIO with STEP low
+    _ssStep.slow[GPIO_DR_CLEAR] = _ssStep.mask;
+    _ccStep.slow[GPIO_DR_CLEAR] = _ccStep.mask;
+    toFast(_ssStep);
+    toFast(_ccStep);
+    toFast(_ccDir);
+
+    DmaStepper::_active = nullptr;
+    this->_kernel = nullptr;
+}
+
+FASTRUN uint32_t DmaStepper::takePlayedSteps() {
+    uint32_t steps = _playedSteps;
+    this->_playedSteps = 0;
+    return steps;
+}
+
+uint32_t DmaStepper::underruns() const {
+    return _underruns;
+}
+
+// PRIVATE
+
+FASTRUN void DmaStepper::isr() {
+    DmaStepper *self = DmaStepper::_active;
+    if (self == nullptr) {
+        return;
+    }
+    self->_ssChannel.clearInterrupt();
+
+    uint8_t half = self->_playing;
+    self->_state[half] = HalfState::HALF_PLAYED;
+    half ^= 1;
+    self->_playing = half;
+    self->_halfStart[half] = micros() + self->_slotTime;
+
+    // Stop on the boundary rather than replay a stale half
+    if (self->_state[half] != HalfState::HALF_READY) {
+        self->stopTimer();
+    }
+    asm("DSB");
+}
+
+bool DmaStepper::portPin(uint8_t pin, PortPin &result) {
+    if (pin >= CORE_NUM_DIGITAL) {
+        return false;
+    }
+    uintptr_t fast = (uintptr_t) portOutputRegister(pin);
+    uintptr_t index = (fast - GPIO6_BASE) / GPIO_SPACING;
+    if (fast < GPIO6_BASE || index > 3) {
+        return false;
+    }
+
+    result.fast = (volatile uint32_t *) fast;
+    result.slow = (volatile uint32_t *) (GPIO1_BASE + index * GPIO_SPACING);
+    result.gpr = &IOMUXC_GPR_GPR26 + index;
+    result.mask = digitalPinToBitMask(pin);
+    return true;
+}
+
+void DmaStepper::toSlow(PortPin &pin) {
+    if (*pin.fast & pin.mask) {
+        pin.slow[GPIO_DR_SET] = pin.mask;
+    } else {
+        pin.slow[GPIO_DR_CLEAR] = pin.mask;
+    }
+    pin.slow[GPIO_GDIR] |= pin.mask;
+    *pin.gpr &= ~pin.mask;
+}
+
+void DmaStepper::toFast(PortPin &pin) {
+    if (pin.slow[GPIO_DR] & pin.mask) {
+        pin.fast[GPIO_DR_SET] = pin.mask;
+    } else {
+        pin.fast[GPIO_DR_CLEAR] = pin.mask;
+    }
+    *pin.gpr |= pin.mask;
+}
+
+FASTRUN void DmaStepper::fillHalf(uint8_t half) {
+    unsigned int *ss = ssWave + half * DMA_BLOCK_SLOTS;
+    unsigned int *cc = ccWave + half * DMA_BLOCK_SLOTS;
+    memset(ss, 0, DMA_BLOCK_SLOTS * sizeof(unsigned int));
+    memset(cc, 0, DMA_BLOCK_SLOTS * sizeof(unsigned int));
+
+    this->_snapshot[half] = *_kernel;
+    uint16_t steps = 0;
+    uint16_t ssSteps = 0;
+    uint16_t slot = 0;
+    while (slot + _slotsPerStep <= DMA_BLOCK_SLOTS && !_kernel->done()) {
+        // First slot lowers the previous pulse and sets up the direction
+        if (_ssHigh) {
+            ss[slot] |= _ssStep.mask;
+        }
+        if (_ccHigh) {
+            cc[slot] |= _ccStep.mask;
+        }
+
+        uint8_t mask = _kernel->next();
+        if (mask & STEP_REVERSED) {
+            cc[slot] |= _ccDir.mask;
+        }
+
+        // Last slot raises the pulse, the spindle rests while the carriage moves between sections
+        uint16_t rise = slot + _slotsPerStep - 1;
+        this->_ssHigh = (mask & STEP_SS) != 0;
+        if (_ssHigh) {
+            ss[rise] |= _ssStep.mask;
+            ssSteps++;
+        }
+        this->_ccHigh = (mask & STEP_CC) != 0;
+        if (_ccHigh) {
+            cc[rise] |= _ccStep.mask;
+        }
+
+        slot += _slotsPerStep;
+        steps++;
+    }
+
+    // Lower the last pulse once the job is done
+    if (_kernel->done() && slot < DMA_BLOCK_SLOTS) {
+        if (_ssHigh) {
+            ss[slot] |= _ssStep.mask;
+        }
+        if (_ccHigh) {
+            cc[slot] |= _ccStep.mask;
+        }
+        this->_ssHigh = false;
+        this->_ccHigh = false;
+    }
+
+    arm_dcache_flush(ss, DMA_BLOCK_SLOTS * sizeof(unsigned int));
+    arm_dcache_flush(cc, DMA_BLOCK_SLOTS * sizeof(unsigned int));
+    this->_steps[half] = steps;
+    this->_ssSteps[half] = ssSteps;
+    this->_state[half] = HalfState::HALF_READY;
+}
+
+FASTRUN void DmaStepper::record(uint8_t half, uint16_t steps) {
+    if (_trace == nullptr || !_trace->recording()) {
+        return;
+    }
+
+    // Replay the kernel from the snapshot, times are when the slots were played
+    WindKernel replay = _snapshot[half];
+    uint32_t time = _halfStart[half];
+    const uint32_t stepTime = _slotsPerStep * _slotTime;
+    const uint32_t riseTime = (_slotsPerStep - 1) * _slotTime;
+    for (uint16_t i = 0; i < steps; i++) {
+        uint8_t mask = replay.next();
+        if (mask & STEP_REVERSED) {
+            _trace->direction(replay.forward(), replay.lastReversal(), time);
+        }
+        _trace->step(mask & (STEP_SS | STEP_CC), time + riseTime);
+        time += stepTime;
+    }
+}
+
+void DmaStepper::startTimer() {
+    // Record times of the half about to play
+    this->_halfStart[_playing] = micros() + _slotTime;
+    this->_stopped = false;
+
+    CCM_CCGR4 |= CCM_CCGR4_PWM2(CCM_CCGR_ON);
+    FLEXPWM2_MCTRL &= ~FLEXPWM_MCTRL_RUN(1);
+    FLEXPWM2_SM0CTRL2 = FLEXPWM_SMCTRL2_INDEP | FLEXPWM_SMCTRL2_WAITEN | FLEXPWM_SMCTRL2_DBGEN;
+    FLEXPWM2_SM0CTRL = FLEXPWM_SMCTRL_FULL | FLEXPWM_SMCTRL_PRSC(_prescale);
+    FLEXPWM2_SM0INIT = 0;
+    FLEXPWM2_SM0VAL0 = 0;
+    FLEXPWM2_SM0VAL1 = _periodCounts - 1;
+    FLEXPWM2_SM0DMAEN = FLEXPWM_SMDMAEN_VALDE;
+    FLEXPWM2_MCTRL |= FLEXPWM_MCTRL_LDOK(1);
+    FLEXPWM2_MCTRL |= FLEXPWM_MCTRL_RUN(1);
+}
+
+void DmaStepper::stopTimer() {
+    FLEXPWM2_MCTRL &= ~FLEXPWM_MCTRL_RUN(1);
+    FLEXPWM2_SM0DMAEN = 0;
+    this->_stopped = true;
+}
+
+#endif
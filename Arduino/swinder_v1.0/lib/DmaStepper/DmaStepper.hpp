@@ -0,0 +1,159 @@
+#ifndef DMA_STEPPER_HPP
+#define DMA_STEPPER_HPP
+
+#if defined(__IMXRT1062__)
+
+#include <Arduino.h>
+#include <DMAChannel.h>
+#include <WindKernel.hpp>
+#include <StepTrace.hpp>
+
+#define DMA_BLOCK_SLOTS 250 // Slots per half buffer, both halves must fit the 511 iteration limit of a linked channel
+#define DMA_WAVE_SLOTS (DMA_BLOCK_SLOTS * 2)
+
+enum HalfState {
+    HALF_EMPTY = 0, // Free to fill
+    HALF_READY = 1, // Filled, waiting for or being played by DMA
+    HALF_PLAYED = 2, // Played, steps not yet recorded
+};
+
+/**
+ * Step backend that plays precomputed waveforms with eDMA.
+ *
+ * A FlexPWM submodule paces the slots. Every slot the SS channel writes one word
+ * to the GPIO DR_TOGGLE register of the SS step pin and links to the CC channel,
+ * which does the same for the CC step and direction pins. Each step is
+ * slotsPerStep slots long, pins left high are lowered and the direction toggled
+ * in its first slot and the step pin rises in its last one.
+ *
+ * The waveform is double buffered, fill() replaces halves once they are played.
+ * Halves are filled from a live WindKernel, so the kernel runs up to two halves
+ * ahead of the motors. A snapshot of the kernel is kept per half so halt() can
+ * rewind it to the steps that actually played.
+ */
+class DmaStepper {
+public:
+    /**
+     * @brief Create a new instance of the DMA step backend.
+     */
+    DmaStepper();
+
+    /**
+     * @brief Looks up the GPIO ports of the pins and allocates the DMA channels
+     *
+     * @param ssStepPin solenoid spin STEP pin
+     * @param ccStepPin carriage STEP pin
+     * @param ccDirPin carriage DIR pin, must be on the same port as ccStepPin
+     * @param ccForwardLevel DIR level for forward carriage travel
+     * @returns false if the pins cannot be driven by DMA
+     */
+    bool begin(uint8_t ssStepPin, uint8_t ccStepPin, uint8_t ccDirPin, bool ccForwardLevel);
+
+    /**
+     * @brief Changes the DIR level for forward carriage travel, for a mirrored job
+     *
+     * Takes effect at the next start()
+     *
+     * @param ccForwardLevel DIR level for forward carriage travel
+     */
+    void setForwardLevel(bool ccForwardLevel);
+
+    /**
+     * @brief Sets the recorder played steps are written to
+     *
+     * @param trace step trace, only written while it is recording
+     */
+    void attachTrace(StepTrace &trace);
+
+    /**
+     * @brief Takes over the pins and starts playing the kernel
+     *
+     * @param kernel kernel to play, must stay valid until halt()
+     * @param slotTime us per slot, at least DRIVER_MIN_PULSE
+     * @param slotsPerStep slots per SS step, at least 2
+     */
+    void start(WindKernel &kernel, uint32_t slotTime, uint16_t slotsPerStep);
+
+    /**
+     * @brief Records played halves and refills them, restarts after an underrun
+     *
+     * Call often, every half lasts DMA_BLOCK_SLOTS * slotTime us
+     *
+     * @returns false once the kernel is done and every step has played
+     */
+    bool fill();
+
+    /**
+     * @brief Stops immediately and rewinds the kernel to the played steps
+     *
+     * Pins are handed back to the fast GPIO with STEP low
+     */
+    void halt();
+
+    /**
+     * @brief Getter for the steps played since the last call
+     *
+     * @returns SS steps played
+     */
+    uint32_t takePlayedSteps();
+
+    /**
+     * @brief Getter for the number of times the buffers ran dry before the job was done
+     *
+     * @returns underrun count since begin()
+     */
+    uint32_t underruns() const;
+
+private:
+    struct PortPin {
+        volatile uint32_t *fast; // GPIO6-9 DR
+        volatile uint32_t *slow; // GPIO1-4 base
+        volatile uint32_t *gpr; // IOMUXC GPR26-29 pin mux select
+        uint32_t mask;
+    };
+
+    static void isr();
+    static bool portPin(uint8_t pin, PortPin &result);
+    static void toSlow(PortPin &pin);
+    static void toFast(PortPin &pin);
+
+    void fillHalf(uint8_t half);
+    void record(uint8_t half, uint16_t steps);
+    void startTimer();
+    void stopTimer();
+
+    static DmaStepper *_active;
+
+    DMAChannel _ssChannel;
+    DMAChannel _ccChannel;
+    PortPin _ssStep;
+    PortPin _ccStep;
+    PortPin _ccDir;
+    bool _ccForwardLevel = false;
+    bool _ready = false;
+
+    WindKernel *_kernel = nullptr;
+    StepTrace *_trace = nullptr;
+    uint32_t _slotTime = 0;
+    uint16_t _slotsPerStep = 2;
+    uint32_t _periodCounts = 0;
+    uint8_t _prescale = 0;
+
+    // Pin levels at the end of the last filled slot
+    bool _ssHigh = false;
+    bool _ccHigh = false;
+
+    volatile uint8_t _state[2] = {HALF_EMPTY, HALF_EMPTY};
+    volatile uint8_t _playing = 0; // Half DMA is in or will start next
+    volatile bool _stopped = true;
+    volatile uint32_t _halfStart[2] = {0, 0}; // us
+    WindKernel _snapshot[2];
+    uint16_t _steps[2] = {0, 0}; // Kernel steps in each half
+    uint16_t _ssSteps[2] = {0, 0}; // SS steps among them, the rest move the carriage between sections
+    uint32_t _playedSteps = 0;
+    uint32_t _underruns = 0;
+};
+
+#endif
+
+#endif
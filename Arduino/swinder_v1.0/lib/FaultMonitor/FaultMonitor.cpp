@@ -0,0 +1,95 @@
+#include "FaultMonitor.hpp"
+#include <EEPROM.h>
+
+volatile uint8_t FaultMonitor::_latched = 0;
+volatile uint8_t FaultMonitor::_pending[MOTOR_COUNT] = {0, 0};
+
+FaultMonitor::FaultMonitor() {}
+
+// PUBLIC
+
+void FaultMonitor::begin(uint8_t ssPin, uint8_t ccPin) {
+    this->_pins[SS_MOTOR] = ssPin;
+    this->_pins[CC_MOTOR] = ccPin;
+
+    EEPROM.get(FAULT_COUNT_EEPROM_ADDR, this->_counts);
+    // Erased flash reads back as all ones
+    for (uint8_t i = 0; i < MOTOR_COUNT; i++) {
+        if (this->_counts[i] == 0xFFFFFFFF) {
+            this->_counts[i] = 0;
+        }
+    }
+
+    attachInterrupt(digitalPinToInterrupt(ssPin), FaultMonitor::ssIsr, FALLING);
+    attachInterrupt(digitalPinToInterrupt(ccPin), FaultMonitor::ccIsr, FALLING);
+    this->arm();
+}
+
+void FaultMonitor::arm() {
+    noInterrupts();
+    _latched = 0;
+    interrupts();
+
+    // Edge interrupts cannot see a line that is already low
+    if (digitalRead(this->_pins[SS_MOTOR]) == LOW) {
+        ssIsr();
+    }
+    if (digitalRead(this->_pins[CC_MOTOR]) == LOW) {
+        ccIsr();
+    }
+}
+
+bool FaultMonitor::tripped(Motor motor) const {
+    return (_latched & (1 << motor)) != 0;
+}
+
+bool FaultMonitor::recovered() {
+    return digitalRead(this->_pins[SS_MOTOR]) == HIGH && digitalRead(this->_pins[CC_MOTOR]) == HIGH;
+}
+
+void FaultMonitor::commit() {
+    bool changed = false;
+
+    noInterrupts();
+    for (uint8_t i = 0; i < MOTOR_COUNT; i++) {
+        if (_pending[i] > 0) {
+            this->_counts[i] += _pending[i];
+            _pending[i] = 0;
+            changed = true;
+        }
+    }
+    interrupts();
+
+    if (changed) {
+        EEPROM.put(FAULT_COUNT_EEPROM_ADDR, this->_counts);
+    }
+}
+
+uint32_t FaultMonitor::count(Motor motor) {
+    return this->_counts[motor] + _pending[motor];
+}
+
+String FaultMonitor::motorName(Motor motor) {
+    switch (motor) {
+        case Motor::SS_MOTOR: return "SS";
+        case Motor::CC_MOTOR: return "CC";
+        default: return "??";
+    }
+}
+
+// PRIVATE
+
+FASTRUN void FaultMonitor::ssIsr() {
+    // Only count the first edge of a fault, nFAULT can chatter while the bridge is disabled
+    if (!(_latched & (1 << SS_MOTOR)) && _pending[SS_MOTOR] < 0xFF) {
+        _pending[SS_MOTOR]++;
+    }
+    _latched |= (1 << SS_MOTOR);
+}
+
+FASTRUN void FaultMonitor::ccIsr() {
+    if (!(_latched & (1 << CC_MOTOR)) && _pending[CC_MOTOR] < 0xFF) {
+        _pending[CC_MOTOR]++;
+    }
+    _latched |= (1 << CC_MOTOR);
+}
@@ -0,0 +1,97 @@
+#ifndef FAULT_MONITOR_HPP
+#define FAULT_MONITOR_HPP
+
+#include <Arduino.h>
+
+#define FAULT_COUNT_EEPROM_ADDR 64 // 2x uint32_t fault counters, see Checkpoint.hpp for the region before it
+#define FAULT_RECOVERY_DELAY 2 // ms for a DRV8825 to release nFAULT after waking
+
+enum Motor {
+    SS_MOTOR = 0,
+    CC_MOTOR = 1,
+};
+
+#define MOTOR_COUNT 2
+
+class FaultMonitor {
+public:
+    /**
+     * @brief Create a new instance of the fault monitor.
+     */
+    FaultMonitor();
+
+    /**
+     * @brief Attaches falling edge interrupts to the DRV8825 nFAULT lines and loads the
+     * persistent fault counters.
+     *
+     * Only one monitor can be attached at a time as the interrupt handlers are static.
+     *
+     * @param ssPin nFAULT pin of the solenoid spin driver
+     * @param ccPin nFAULT pin of the carriage control driver
+     */
+    void begin(uint8_t ssPin, uint8_t ccPin);
+
+    /**
+     * @brief Clears the latch and samples the current line levels so a fault that is
+     * already asserted is not missed by the edge interrupts.
+     */
+    void arm();
+
+    /**
+     * @brief Checks the latch, intended to be called from the step loop
+     *
+     * @returns true if any motor has faulted since the last arm()
+     */
+    inline bool tripped() const {
+        return _latched != 0;
+    }
+
+    /**
+     * @brief Checks if a specific motor faulted since the last arm()
+     *
+     * @returns true if motor tripped the latch
+     */
+    bool tripped(Motor motor) const;
+
+    /**
+     * @brief Checks the nFAULT lines directly
+     *
+     * Drivers must be awake for a meaningful result
+     *
+     * @returns true if no driver is currently reporting a fault
+     */
+    bool recovered();
+
+    /**
+     * @brief Moves faults latched by the interrupts into the persistent counters.
+     *
+     * Writes to EEPROM, do not call from the step loop.
+     */
+    void commit();
+
+    /**
+     * @brief Getter for the lifetime fault count of a motor
+     *
+     * @returns number of faults recorded for motor
+     */
+    uint32_t count(Motor motor);
+
+    /**
+     * @brief Provides a short name for a motor
+     *
+     * @returns "SS" or "CC"
+     */
+    static String motorName(Motor motor);
+
+private:
+    static void ssIsr();
+    static void ccIsr();
+
+    static volatile uint8_t _latched;
+    static volatile uint8_t _pending[MOTOR_COUNT];
+
+    uint8_t _pins[MOTOR_COUNT] = {0, 0};
+    uint32_t _counts[MOTOR_COUNT] = {0, 0};
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include "Format.hpp"
+
+// Assumes 2 decimal place precision
+String formatVal(uint32_t num, uint32_t max) {
+    uint8_t maxLength = String(max).length() + 1; // Cannot be greater than 10
+    String returnString = "";
+    String numberString = String(num);
+
+    // At least one digit before the point, 0.05 and not .5
+    while (numberString.length() < 3) {
+        numberString = "0" + numberString;
+    }
+
+    // Add leading zeros to match length
+    for (size_t i = 0; i + numberString.length() + 1 < maxLength; i++) {
+        returnString += "0";
+    }
+
+    // Split around the point
+    returnString += numberString.substring(0, numberString.length() - 2);
+    returnString += ".";
+    returnString += numberString.substring(numberString.length() - 2);
+    return returnString;
+}
+
+bool parseVal(const String &text, uint32_t &value) {
+    uint64_t result = 0;
+    int8_t decimals = -1; // Digits seen after the point, -1 before it
+    bool digits = false;
+
+    for (size_t i = 0; i < text.length(); i++) {
+        char c = text.charAt(i);
+        if (c == '.' && decimals < 0) {
+            decimals = 0;
+            continue;
+        }
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        digits = true;
+        if (decimals >= 2) {
+            continue;
+        }
+        result = result * 10 + (c - '0');
+        if (decimals >= 0) {
+            decimals++;
+        }
+        if (result > 0xFFFFFFFFULL) {
+            return false;
+        }
+    }
+    if (!digits) {
+        return false;
+    }
+
+    // Scale to 2 decimal places
+    for (int8_t i = decimals < 0 ? 0 : decimals; i < 2; i++) {
+        result *= 10;
+    }
+    if (result > 0xFFFFFFFFULL) {
+        return false;
+    }
+    value = result;
+    return true;
+}
@@ -0,0 +1,24 @@
+#ifndef FORMAT_HPP
+#define FORMAT_HPP
+
+#include <Arduino.h>
+
+/**
+ * @brief Formats a fixed point value with 2 decimal places, zero padded to the width of max
+ *
+ * @param num value to format, 0.01 precision
+ * @param max largest value the field can hold
+ * @returns formatted value, e.g. 1234 with max 2000 is "12.34"
+ */
+String formatVal(uint32_t num, uint32_t max);
+
+/**
+ * @brief Parses a decimal number into a fixed point value with 2 decimal places
+ *
+ * @param text value such as "12.34", "12.3" or "12", further decimals are dropped
+ * @param value parsed value, 0.01 precision
+ * @returns false if text is not a number or does not fit
+ */
+bool parseVal(const String &text, uint32_t &value);
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Host stand-in for the Arduino core, only what the swinder libraries and firmware use.
+// Time is simulated: delays advance the clock instead of sleeping.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <string>
+
+#define HIGH 1
+#define LOW 0
+
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define RISING 1
+#define FALLING 2
+#define CHANGE 3
+
+// Teensy memory placement attributes have no meaning on the host
+#define FASTRUN
+#define DMAMEM
+#define FLASHMEM
+#define PROGMEM
+
+// Heap use follows the Teensy String: a buffer sized to the text, allocated or reallocated
+// on every non-empty construction, copy, concatenation or growth past it, none while empty.
+// HostArduino::stringAllocations() counts them, so host benchmarks see the target's.
+class String {
+public:
+    String() {}
+    String(const char *value);
+    String(const std::string &value);
+    String(const String &other);
+    String(String &&other);
+    explicit String(char value);
+    String(int value);
+    String(unsigned int value);
+    String(long value);
+    String(unsigned long value);
+    String(long long value);
+    String(unsigned long long value);
+    String(double value, unsigned char decimals = 2);
+    ~String();
+
+    String &operator=(const String &other);
+    String &operator=(String &&other);
+    String &operator=(const char *value);
+
+    size_t length() const { return _length; }
+    const char *c_str() const { return _buffer != nullptr ? _buffer : ""; }
+    char charAt(size_t index) const { return index < _length ? _buffer[index] : 0; }
+    char operator[](size_t index) const { return this->charAt(index); }
+
+    String substring(size_t from) const;
+    String substring(size_t from, size_t to) const;
+    int indexOf(char c) const;
+    int indexOf(char c, size_t from) const;
+    bool equalsIgnoreCase(const String &other) const;
+    bool startsWith(const String &prefix) const { return prefix._length <= _length && strncmp(this->c_str(), prefix.c_str(), prefix._length) == 0; }
+    long toInt() const { return atol(this->c_str()); }
+    void trim();
+    void reserve(size_t size);
+
+    String &operator+=(const String &other) { this->concat(other.c_str(), other._length); return *this; }
+    String &operator+=(const char *other) { this->concat(other, strlen(other)); return *this; }
+    String &operator+=(char other) { this->concat(&other, 1); return *this; }
+
+    bool operator==(const String &other) const { return _length == other._length && strcmp(this->c_str(), other.c_str()) == 0; }
+    bool operator==(const char *other) const { return strcmp(this->c_str(), other) == 0; }
+    bool operator!=(const String &other) const { return !(*this == other); }
+    bool operator!=(const char *other) const { return !(*this == other); }
+
+    // Copy of the left side grown by the right, as the Teensy StringSumHelper
+    friend String operator+(const String &a, const String &b) { String sum = a; sum += b; return sum; }
+    friend String operator+(const String &a, const char *b) { String sum = a; sum += b; return sum; }
+    friend String operator+(const char *a, const String &b) { String sum = a; sum += b; return sum; }
+
+private:
+    void copy(const char *value, size_t length);
+    void concat(const char *value, size_t length);
+
+    char *_buffer = nullptr;
+    size_t _capacity = 0; // Characters the buffer holds, the terminator not counted
+    size_t _length = 0;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    size_t write(const uint8_t *buffer, size_t size);
+    size_t print(const String &value);
+    size_t print(const char *value);
+    size_t print(char value);
+    size_t print(long value);
+    size_t print(unsigned long value);
+    size_t print(int value) { return this->print((long) value); }
+    size_t print(unsigned int value) { return this->print((unsigned long) value); }
+    size_t println(const String &value);
+    size_t println(const char *value);
+    size_t println();
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+};
+
+/**
+ * Serial on the host: writes to stdout, reads nothing unless fed
+ */
+class HostSerial : public Stream {
+public:
+    void begin(unsigned long baud) {}
+    size_t write(uint8_t c) override;
+    int available() override;
+    int read() override;
+
+    /**
+     * @brief Queues input as if it was received over serial
+     */
+    void feed(const String &input);
+
+private:
+    std::string _input;
+};
+
+extern HostSerial Serial;
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void noInterrupts();
+void interrupts();
+void attachInterrupt(uint8_t interrupt, void (*handler)(), int mode);
+void detachInterrupt(uint8_t interrupt);
+inline uint8_t digitalPinToInterrupt(uint8_t pin) { return pin; }
+
+#include "HostArduino.hpp"
+
+#endif
@@ -0,0 +1,26 @@
+#include "EEPROM.h"
+
+EEPROMClass EEPROM;
+
+EEPROMClass::EEPROMClass() {
+    // Erased flash reads back as all ones
+    memset(this->_data, 0xFF, HOST_EEPROM_SIZE);
+}
+
+uint8_t EEPROMClass::read(int address) {
+    return address >= 0 && address < HOST_EEPROM_SIZE ? _data[address] : 0xFF;
+}
+
+void EEPROMClass::write(int address, uint8_t value) {
+    if (address >= 0 && address < HOST_EEPROM_SIZE) {
+        this->_data[address] = value;
+    }
+}
+
+void EEPROMClass::update(int address, uint8_t value) {
+    this->write(address, value);
+}
+
+uint16_t EEPROMClass::length() {
+    return HOST_EEPROM_SIZE;
+}
@@ -0,0 +1,41 @@
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include "Arduino.h"
+#include <string.h>
+
+#define HOST_EEPROM_SIZE 4284 // Same as the Teensy 4.1 emulated EEPROM
+
+/**
+ * Host stand-in for the EEPROM, starts erased and lives as long as the process
+ */
+class EEPROMClass {
+public:
+    EEPROMClass();
+
+    uint8_t read(int address);
+    void write(int address, uint8_t value);
+    void update(int address, uint8_t value);
+    uint16_t length();
+
+    template <typename T> T &get(int address, T &value) {
+        if (address >= 0 && address + sizeof(T) <= HOST_EEPROM_SIZE) {
+            memcpy(&value, _data + address, sizeof(T));
+        }
+        return value;
+    }
+
+    template <typename T> const T &put(int address, const T &value) {
+        if (address >= 0 && address + sizeof(T) <= HOST_EEPROM_SIZE) {
+            memcpy(_data + address, &value, sizeof(T));
+        }
+        return value;
+    }
+
+private:
+    uint8_t _data[HOST_EEPROM_SIZE];
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
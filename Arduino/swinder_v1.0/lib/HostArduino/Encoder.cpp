@@ -0,0 +1,38 @@
+#include "Encoder.h"
+
+Encoder *Encoder::_active = nullptr;
+
+// Position change from (old state << 2 | new state), state is A << 1 | B
+static const int8_t QUADRATURE[16] = {0, 1, -1, 0, -1, 0, 0, 1, 1, 0, 0, -1, 0, -1, 1, 0};
+
+Encoder::Encoder(uint8_t pinA, uint8_t pinB) {
+    this->_pinA = pinA;
+    this->_pinB = pinB;
+    pinMode(pinA, INPUT_PULLUP);
+    pinMode(pinB, INPUT_PULLUP);
+    this->_state = (digitalRead(pinA) << 1) | digitalRead(pinB);
+
+    _active = this;
+    attachInterrupt(digitalPinToInterrupt(pinA), Encoder::isr, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(pinB), Encoder::isr, CHANGE);
+}
+
+long Encoder::read() {
+    return _position;
+}
+
+void Encoder::write(long position) {
+    this->_position = position;
+}
+
+void Encoder::isr() {
+    if (_active != nullptr) {
+        _active->decode();
+    }
+}
+
+void Encoder::decode() {
+    uint8_t state = (digitalRead(_pinA) << 1) | digitalRead(_pinB);
+    this->_position += QUADRATURE[(_state << 2) | state];
+    this->_state = state;
+}
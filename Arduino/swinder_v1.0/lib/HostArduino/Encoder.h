@@ -0,0 +1,32 @@
+#ifndef HOST_ENCODER_H
+#define HOST_ENCODER_H
+
+#include "Arduino.h"
+
+/**
+ * Host stand-in for the quadrature encoder library, decodes edges driven with
+ * HostArduino::setPin. Counts 4 per detent like the real one.
+ *
+ * Forward from the rest state (both pins high): B low, A low, B high, A high.
+ * Only one instance can be decoding at a time, the last one constructed.
+ */
+class Encoder {
+public:
+    Encoder(uint8_t pinA, uint8_t pinB);
+
+    long read();
+    void write(long position);
+
+private:
+    static void isr();
+    void decode();
+
+    static Encoder *_active;
+
+    uint8_t _pinA;
+    uint8_t _pinB;
+    uint8_t _state;
+    volatile long _position = 0;
+};
+
+#endif
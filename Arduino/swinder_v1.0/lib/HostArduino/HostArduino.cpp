@@ -0,0 +1,368 @@
+#include "Arduino.h"
+#include <strings.h>
+
+HostSerial Serial;
+
+namespace {
+
+uint64_t simTime = 0;
+uint8_t pins[HOST_PIN_COUNT] = {0};
+void (*handlers[HOST_PIN_COUNT])() = {nullptr};
+int handlerModes[HOST_PIN_COUNT] = {0};
+HostArduino::PinHook writeHook = nullptr;
+HostArduino::TimeHook advanceHook = nullptr;
+uint64_t stringAllocs = 0;
+
+void advanceTime(uint64_t us) {
+    simTime += us;
+    if (advanceHook != nullptr) {
+        advanceHook(simTime);
+    }
+}
+
+}
+
+// STRING
+
+String::String(const char *value) {
+    this->copy(value, strlen(value));
+}
+
+String::String(const std::string &value) {
+    this->copy(value.c_str(), value.length());
+}
+
+String::String(const String &other) {
+    this->copy(other.c_str(), other._length);
+}
+
+String::String(String &&other) {
+    *this = static_cast<String &&>(other);
+}
+
+String::String(char value) {
+    this->copy(&value, 1);
+}
+
+// Numbers are printed to a stack buffer and copied, as the Teensy String does
+String::String(int value) : String((long long) value) {}
+String::String(unsigned int value) : String((unsigned long long) value) {}
+String::String(long value) : String((long long) value) {}
+String::String(unsigned long value) : String((unsigned long long) value) {}
+
+String::String(long long value) {
+    char buffer[24];
+    this->copy(buffer, snprintf(buffer, sizeof(buffer), "%lld", value));
+}
+
+String::String(unsigned long long value) {
+    char buffer[24];
+    this->copy(buffer, snprintf(buffer, sizeof(buffer), "%llu", value));
+}
+
+String::String(double value, unsigned char decimals) {
+    char buffer[48];
+    this->copy(buffer, snprintf(buffer, sizeof(buffer), "%.*f", decimals, value));
+}
+
+String::~String() {
+    free(_buffer);
+}
+
+String &String::operator=(const String &other) {
+    if (this != &other) {
+        this->copy(other.c_str(), other._length);
+    }
+    return *this;
+}
+
+String &String::operator=(String &&other) {
+    if (this != &other) {
+        free(_buffer);
+        this->_buffer = other._buffer;
+        this->_capacity = other._capacity;
+        this->_length = other._length;
+        other._buffer = nullptr;
+        other._capacity = 0;
+        other._length = 0;
+    }
+    return *this;
+}
+
+String &String::operator=(const char *value) {
+    this->copy(value, strlen(value));
+    return *this;
+}
+
+String String::substring(size_t from) const {
+    return this->substring(from, _length);
+}
+
+String String::substring(size_t from, size_t to) const {
+    String result;
+    if (to > _length) {
+        to = _length;
+    }
+    if (from < to) {
+        result.copy(_buffer + from, to - from);
+    }
+    return result;
+}
+
+int String::indexOf(char c) const {
+    return this->indexOf(c, 0);
+}
+
+int String::indexOf(char c, size_t from) const {
+    for (size_t i = from; i < _length; i++) {
+        if (_buffer[i] == c) {
+            return (int) i;
+        }
+    }
+    return -1;
+}
+
+bool String::equalsIgnoreCase(const String &other) const {
+    return strcasecmp(this->c_str(), other.c_str()) == 0;
+}
+
+// In place, no allocation
+void String::trim() {
+    size_t start = 0;
+    while (start < _length && strchr(" \t\r\n", _buffer[start]) != nullptr) {
+        start++;
+    }
+    size_t end = _length;
+    while (end > start && strchr(" \t\r\n", _buffer[end - 1]) != nullptr) {
+        end--;
+    }
+    if (_buffer == nullptr) {
+        return;
+    }
+    memmove(_buffer, _buffer + start, end - start);
+    this->_length = end - start;
+    this->_buffer[_length] = 0;
+}
+
+void String::reserve(size_t size) {
+    if (_capacity >= size) {
+        return;
+    }
+    // One realloc per growth, the Teensy String sizes the buffer to exactly what is asked
+    char *buffer = (char *) realloc(_buffer, size + 1);
+    if (buffer == nullptr) {
+        abort();
+    }
+    if (_buffer == nullptr) {
+        buffer[0] = 0;
+    }
+    stringAllocs++;
+    this->_buffer = buffer;
+    this->_capacity = size;
+}
+
+void String::copy(const char *value, size_t length) {
+    if (length == 0) {
+        if (_buffer != nullptr) {
+            this->_buffer[0] = 0;
+        }
+        this->_length = 0;
+        return;
+    }
+    this->reserve(length);
+    memmove(_buffer, value, length);
+    this->_length = length;
+    this->_buffer[_length] = 0;
+}
+
+void String::concat(const char *value, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    // Appending to itself, the buffer may move
+    const bool own = _buffer != nullptr && value >= _buffer && value <= _buffer + _length;
+    const size_t offset = own ? value - _buffer : 0;
+    this->reserve(_length + length);
+    memmove(_buffer + _length, own ? _buffer + offset : value, length);
+    this->_length += length;
+    this->_buffer[_length] = 0;
+}
+
+// PRINT
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        this->write(buffer[i]);
+    }
+    return size;
+}
+
+size_t Print::print(const String &value) {
+    return this->write((const uint8_t *) value.c_str(), value.length());
+}
+
+size_t Print::print(const char *value) {
+    return this->print(String(value));
+}
+
+size_t Print::print(char value) {
+    return this->write((uint8_t) value);
+}
+
+size_t Print::print(long value) {
+    return this->print(String(value));
+}
+
+size_t Print::print(unsigned long value) {
+    return this->print(String(value));
+}
+
+size_t Print::println(const String &value) {
+    return this->print(value) + this->println();
+}
+
+size_t Print::println(const char *value) {
+    return this->print(value) + this->println();
+}
+
+size_t Print::println() {
+    return this->write('\n');
+}
+
+size_t HostSerial::write(uint8_t c) {
+    return fputc(c, stdout) == EOF ? 0 : 1;
+}
+
+int HostSerial::available() {
+    return _input.length();
+}
+
+int HostSerial::read() {
+    if (_input.empty()) {
+        return -1;
+    }
+    char c = _input[0];
+    this->_input.erase(0, 1);
+    return c;
+}
+
+void HostSerial::feed(const String &input) {
+    this->_input += input.c_str();
+}
+
+// PINS
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < HOST_PIN_COUNT && mode == INPUT_PULLUP) {
+        pins[pin] = HIGH;
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin >= HOST_PIN_COUNT) {
+        return;
+    }
+    value = value ? HIGH : LOW;
+    if (pins[pin] != value) {
+        pins[pin] = value;
+        if (writeHook != nullptr) {
+            writeHook(pin, value, simTime);
+        }
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < HOST_PIN_COUNT ? pins[pin] : LOW;
+}
+
+// TIME
+
+uint32_t millis() {
+    return simTime / 1000;
+}
+
+uint32_t micros() {
+    return simTime;
+}
+
+void delay(uint32_t ms) {
+    advanceTime((uint64_t) ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+    advanceTime(us);
+}
+
+void yield() {}
+
+// INTERRUPTS
+
+void noInterrupts() {}
+
+void interrupts() {}
+
+void attachInterrupt(uint8_t interrupt, void (*handler)(), int mode) {
+    if (interrupt < HOST_PIN_COUNT) {
+        handlers[interrupt] = handler;
+        handlerModes[interrupt] = mode;
+    }
+}
+
+void detachInterrupt(uint8_t interrupt) {
+    if (interrupt < HOST_PIN_COUNT) {
+        handlers[interrupt] = nullptr;
+    }
+}
+
+// SIMULATION
+
+namespace HostArduino {
+
+uint64_t now() {
+    return simTime;
+}
+
+uint64_t stringAllocations() {
+    return stringAllocs;
+}
+
+void advance(uint64_t us) {
+    advanceTime(us);
+}
+
+void reset() {
+    simTime = 0;
+    for (uint8_t i = 0; i < HOST_PIN_COUNT; i++) {
+        pins[i] = LOW;
+        handlers[i] = nullptr;
+    }
+    writeHook = nullptr;
+    advanceHook = nullptr;
+}
+
+void setPin(uint8_t pin, uint8_t value) {
+    if (pin >= HOST_PIN_COUNT) {
+        return;
+    }
+    value = value ? HIGH : LOW;
+    uint8_t old = pins[pin];
+    pins[pin] = value;
+
+    if (handlers[pin] == nullptr || old == value) {
+        return;
+    }
+    int mode = handlerModes[pin];
+    if (mode == CHANGE || (mode == RISING && value == HIGH) || (mode == FALLING && value == LOW)) {
+        handlers[pin]();
+    }
+}
+
+void onWrite(PinHook hook) {
+    writeHook = hook;
+}
+
+void onAdvance(TimeHook hook) {
+    advanceHook = hook;
+}
+
+}
@@ -0,0 +1,74 @@
+#ifndef HOST_ARDUINO_HPP
+#define HOST_ARDUINO_HPP
+
+#include <stdint.h>
+
+#define HOST_PIN_COUNT 64
+
+// Simulation controls for host builds
+namespace HostArduino {
+
+/**
+ * Called on every digitalWrite that changes a pin
+ */
+typedef void (*PinHook)(uint8_t pin, uint8_t value, uint64_t time);
+
+/**
+ * Called after every advance of the simulated clock, drives scripted input
+ */
+typedef void (*TimeHook)(uint64_t time);
+
+/**
+ * @brief Getter for the simulated clock
+ *
+ * @returns simulated time in us since start
+ */
+uint64_t now();
+
+/**
+ * @brief Advances the simulated clock
+ *
+ * @param us time to advance by
+ */
+void advance(uint64_t us);
+
+/**
+ * @brief Getter for the heap allocations made by String, counted as the Teensy String makes them
+ *
+ * @returns allocations and reallocations since start
+ */
+uint64_t stringAllocations();
+
+/**
+ * @brief Resets the clock, pins and hooks to their power on state
+ */
+void reset();
+
+/**
+ * @brief Drives an input pin as external hardware would, firing attached interrupts
+ *
+ * @param pin pin to drive
+ * @param value new level
+ */
+void setPin(uint8_t pin, uint8_t value);
+
+/**
+ * @brief Sets the hook called on output changes
+ *
+ * @param hook hook, nullptr to remove
+ */
+void onWrite(PinHook hook);
+
+/**
+ * @brief Sets the hook called after the clock advances
+ *
+ * Delays are where firmware waits for input, so the hook can change inputs
+ * or throw to stop a firmware loop that never returns.
+ *
+ * @param hook hook, nullptr to remove
+ */
+void onAdvance(TimeHook hook);
+
+}
+
+#endif
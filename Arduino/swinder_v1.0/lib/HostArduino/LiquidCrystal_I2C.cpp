@@ -0,0 +1,39 @@
+#include "LiquidCrystal_I2C.h"
+#include <string.h>
+
+LiquidCrystal_I2C::LiquidCrystal_I2C(uint8_t address, uint8_t columns, uint8_t rows) {
+    this->_columns = columns < HOST_LCD_MAX_COLUMNS ? columns : HOST_LCD_MAX_COLUMNS;
+    this->_rows = rows < HOST_LCD_MAX_ROWS ? rows : HOST_LCD_MAX_ROWS;
+    this->clear();
+}
+
+void LiquidCrystal_I2C::init() {
+    this->clear();
+}
+
+void LiquidCrystal_I2C::clear() {
+    for (uint8_t i = 0; i < HOST_LCD_MAX_ROWS; i++) {
+        memset(this->_text[i], ' ', _columns);
+        this->_text[i][_columns] = '\0';
+    }
+    this->_column = 0;
+    this->_row = 0;
+}
+
+void LiquidCrystal_I2C::setCursor(uint8_t column, uint8_t row) {
+    this->_column = column;
+    this->_row = row;
+}
+
+size_t LiquidCrystal_I2C::write(uint8_t c) {
+    // Text past the end of a row is lost, unlike the real controller which wraps to another row
+    if (_row < _rows && _column < _columns) {
+        this->_text[_row][_column] = c;
+    }
+    this->_column++;
+    return 1;
+}
+
+String LiquidCrystal_I2C::row(uint8_t row) const {
+    return row < _rows ? String(_text[row]) : String();
+}
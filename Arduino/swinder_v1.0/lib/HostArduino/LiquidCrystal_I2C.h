@@ -0,0 +1,43 @@
+#ifndef HOST_LIQUID_CRYSTAL_I2C_H
+#define HOST_LIQUID_CRYSTAL_I2C_H
+
+#include "Arduino.h"
+
+#define HOST_LCD_MAX_COLUMNS 20
+#define HOST_LCD_MAX_ROWS 4
+
+/**
+ * Host stand-in for the I2C character display, keeps the shown text so
+ * simulations can read the screen
+ */
+class LiquidCrystal_I2C : public Print {
+public:
+    LiquidCrystal_I2C(uint8_t address, uint8_t columns, uint8_t rows);
+
+    void init();
+    void clear();
+    void backlight() {}
+    void setCursor(uint8_t column, uint8_t row);
+    void cursor() {}
+    void noCursor() {}
+    void blink() {}
+    void noBlink() {}
+    size_t write(uint8_t c) override;
+
+    /**
+     * @brief Getter for the text of a display row
+     *
+     * @param row row index
+     * @returns text of the row, padded with spaces to the display width
+     */
+    String row(uint8_t row) const;
+
+private:
+    uint8_t _columns;
+    uint8_t _rows;
+    uint8_t _column = 0;
+    uint8_t _row = 0;
+    char _text[HOST_LCD_MAX_ROWS][HOST_LCD_MAX_COLUMNS + 1];
+};
+
+#endif
@@ -0,0 +1,83 @@
+#include "HostMachine.hpp"
+#include <Machine.hpp>
+
+namespace {
+
+int32_t position = 0;
+int32_t origin = 0; // Carriage position when the carriage model was attached
+HostArduino::PinHook forward = nullptr;
+StepperModel *ssModel = nullptr;
+StepperModel *ccModel = nullptr;
+
+void follow(uint8_t pin, uint8_t value, uint64_t time) {
+    if (pin == SS_STEP_PIN && value == HIGH && ssModel != nullptr) {
+        ssModel->step(digitalRead(SS_DIR_PIN) == SS_DIR_SET, time);
+    }
+    if (pin == SS_SLEEP_PIN && ssModel != nullptr) {
+        ssModel->enable(value == HIGH, time);
+    }
+    if (pin == CC_SLEEP_PIN && ccModel != nullptr) {
+        ccModel->enable(value == HIGH, time);
+    }
+    if (pin == CC_STEP_PIN && value == HIGH) {
+        if (ccModel != nullptr) {
+            ccModel->step(digitalRead(CC_DIR_PIN) == CC_DIR_SET, time);
+            position = origin + (int32_t) ccModel->heldStep() * DISTANCE_PER_STEP;
+        } else {
+            position += digitalRead(CC_DIR_PIN) == CC_DIR_SET ? DISTANCE_PER_STEP : -DISTANCE_PER_STEP;
+        }
+        HostArduino::setPin(LS_START_PIN, position <= 0 ? HIGH : LOW);
+    }
+    if (forward != nullptr) {
+        forward(pin, value, time);
+    }
+}
+
+}
+
+namespace HostMachine {
+
+void begin(int32_t carriage, HostArduino::PinHook edges) {
+    position = carriage;
+    forward = edges;
+    ssModel = nullptr;
+    ccModel = nullptr;
+
+    // Button up, drivers not faulted
+    HostArduino::setPin(RE_BUTTON_PIN, HIGH);
+    HostArduino::setPin(SS_FAULT_PIN, HIGH);
+    HostArduino::setPin(CC_FAULT_PIN, HIGH);
+    HostArduino::setPin(LS_START_PIN, position <= 0 ? HIGH : LOW);
+    HostArduino::onWrite(follow);
+}
+
+void attachMotors(StepperModel *ss, StepperModel *cc) {
+    ssModel = ss;
+    ccModel = cc;
+    origin = position;
+    uint64_t now = HostArduino::now();
+    if (ssModel != nullptr) {
+        ssModel->enable(digitalRead(SS_SLEEP_PIN) == HIGH, now);
+    }
+    if (ccModel != nullptr) {
+        ccModel->enable(digitalRead(CC_SLEEP_PIN) == HIGH, now);
+    }
+}
+
+int32_t carriage() {
+    return position;
+}
+
+void turn(int32_t detents) {
+    // Gray code, both pins high at rest, see the host Encoder
+    uint8_t first = detents > 0 ? RE_B_PIN : RE_A_PIN;
+    uint8_t second = detents > 0 ? RE_A_PIN : RE_B_PIN;
+    for (int32_t i = 0; i < abs(detents); i++) {
+        HostArduino::setPin(first, LOW);
+        HostArduino::setPin(second, LOW);
+        HostArduino::setPin(first, HIGH);
+        HostArduino::setPin(second, HIGH);
+    }
+}
+
+}
@@ -0,0 +1,66 @@
+#ifndef HOST_MACHINE_HPP
+#define HOST_MACHINE_HPP
+
+#include <Arduino.h>
+#include "StepperModel.hpp"
+
+// Same pins and directions as main.cpp
+#define SS_STEP_PIN 36
+#define SS_DIR_PIN 35
+#define SS_FAULT_PIN 30
+#define SS_SLEEP_PIN 37
+#define SS_DIR_SET 0
+#define CC_STEP_PIN 39
+#define CC_DIR_PIN 38
+#define CC_FAULT_PIN 29
+#define CC_SLEEP_PIN 40
+#define CC_DIR_SET 0
+#define RE_BUTTON_PIN 21
+#define RE_A_PIN 22
+#define RE_B_PIN 23
+#define LS_START_PIN 7
+
+/**
+ * The hardware around the firmware in host simulations: idle operator inputs,
+ * healthy drivers and a carriage that trips the start limit switch at 0.
+ */
+namespace HostMachine {
+
+/**
+ * @brief Sets the inputs to their idle levels and starts following the STEP and DIR pins
+ *
+ * Call before the firmware setup()
+ *
+ * @param carriage carriage position at power on, 0.001cm from the start switch
+ * @param edges called with every output change after the carriage moved, may be nullptr
+ */
+void begin(int32_t carriage, HostArduino::PinHook edges);
+
+/**
+ * @brief Drives stepper models from the STEP, DIR and SLEEP pins
+ *
+ * Call after begin(). With a carriage model the carriage follows the step its rotor
+ * holds, so missed steps move the limit switch as they would on the machine.
+ *
+ * @param ss spindle model, may be nullptr
+ * @param cc carriage model, may be nullptr
+ */
+void attachMotors(StepperModel *ss, StepperModel *cc);
+
+/**
+ * @brief Getter for the simulated carriage
+ *
+ * @returns position, 0.001cm from the start switch
+ */
+int32_t carriage();
+
+/**
+ * @brief Turns the encoder as an operator would
+ *
+ * @param detents detents to turn, negative turns back
+ */
+void turn(int32_t detents);
+
+}
+
+#endif
@@ -0,0 +1,244 @@
+#include "StepperModel.hpp"
+#include <Machine.hpp>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define POLE_PAIRS (MODEL_FULL_STEPS / 4) // Electrical cycles per revolution
+#define REST_SPEED 1e-4 // rad/s, slower counts as stopped even without friction
+#define REST_ANGLE 1e-4 // electrical radians
+
+StepperModel::StepperModel() {
+    this->begin(StepperModel::spindle());
+}
+
+// PUBLIC
+
+void StepperModel::begin(const MotorParams &params) {
+    this->_params = params;
+    this->_enabled = false;
+    this->_time = 0;
+    this->_commanded = 0;
+    this->_angle = 0;
+    this->_velocity = 0;
+    this->_settled = true;
+    this->_slips = 0;
+    this->_lastStep = 0;
+    this->_fieldVelocity = 0;
+    this->_fieldUntil = 0;
+    this->clearCounters();
+}
+
+void StepperModel::enable(bool enabled, uint64_t time) {
+    this->integrate(time);
+    this->_enabled = enabled;
+    this->_settled = false;
+}
+
+void StepperModel::step(bool forward, uint64_t time) {
+    this->integrate(time);
+    if (!_enabled) {
+        return;
+    }
+    this->_commanded += forward ? 1 : -1;
+    this->_settled = false;
+
+    // Field speed from the last step period, the rotor is damped towards it
+    const double period = (time - _lastStep) * 1e-6;
+    this->_fieldVelocity = (forward ? 2 : -2) * M_PI / _params.stepsPerRevolution / period;
+    this->_fieldUntil = time + (time - _lastStep);
+    this->_lastStep = time;
+
+    // The field leads the rotor most right after a step
+    const double stepAngle = 2 * M_PI * POLE_PAIRS / _params.stepsPerRevolution;
+    const double loadAngle = fabs(_commanded * stepAngle - _angle - _slips * 2 * M_PI);
+    if (loadAngle > _peakLoadAngle) {
+        this->_peakLoadAngle = loadAngle;
+        this->_peakTime = time;
+    }
+}
+
+void StepperModel::update(uint64_t time) {
+    this->integrate(time);
+}
+
+int64_t StepperModel::commanded() const {
+    return _commanded;
+}
+
+double StepperModel::position() const {
+    return _angle * _params.stepsPerRevolution / (2 * M_PI * POLE_PAIRS);
+}
+
+int64_t StepperModel::heldStep() const {
+    return _commanded - _slips * 4 * (int64_t) _params.stepsPerRevolution / MODEL_FULL_STEPS;
+}
+
+double StepperModel::speed() const {
+    return _velocity * _params.stepsPerRevolution / (2 * M_PI);
+}
+
+uint64_t StepperModel::missedSteps() const {
+    return _missed;
+}
+
+uint64_t StepperModel::firstMiss() const {
+    return _firstMiss;
+}
+
+double StepperModel::peakLoadAngle() const {
+    return _peakLoadAngle * 180 / M_PI;
+}
+
+uint64_t StepperModel::peakTime() const {
+    return _peakTime;
+}
+
+void StepperModel::clearCounters() {
+    this->_missed = 0;
+    this->_firstMiss = 0;
+    this->_peakLoadAngle = 0;
+    this->_peakTime = 0;
+}
+
+MotorParams StepperModel::spindle() {
+    // NEMA 17 at the DRV8825 current limit, chuck and an aluminium mandrel
+    return {SS_STEPS_PER_REVOLUTION, 0.45, 1000, 3000, 6.8e-6, 1.5e-5, 0.02, 4e-3};
+}
+
+MotorParams StepperModel::carriage() {
+    // NEMA 17, 8mm lead screw and a 0.4kg carriage reflected through it, 10N of drag
+    return {CC_STEPS_PER_REVOLUTION, 0.40, 1200, 3000, 5.4e-6, 1.7e-6, 0.03, 2.5e-3};
+}
+
+bool StepperModel::load(const char *path, MotorParams &ss, MotorParams &cc) {
+    FILE *file = fopen(path, "r");
+    if (file == nullptr) {
+        fprintf(stderr, "Cannot read motor parameters %s\n", path);
+        return false;
+    }
+
+    char line[128];
+    uint32_t number = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file) != nullptr) {
+        number++;
+        char *comment = strchr(line, '#');
+        if (comment != nullptr) {
+            *comment = '\0';
+        }
+        char key[64];
+        double value = 0;
+        int fields = sscanf(line, "%63s %lf", key, &value);
+        if (fields <= 0) {
+            continue;
+        }
+
+        MotorParams *params = nullptr;
+        if (strncmp(key, "ss.", 3) == 0) {
+            params = &ss;
+        } else if (strncmp(key, "cc.", 3) == 0) {
+            params = &cc;
+        }
+        const char *name = key + 3;
+        if (fields != 2 || params == nullptr || value < 0) {
+            ok = false;
+        } else if (strcmp(name, "steps_per_revolution") == 0) {
+            params->stepsPerRevolution = (uint32_t) value;
+            ok = params->stepsPerRevolution >= MODEL_FULL_STEPS;
+        } else if (strcmp(name, "holding_torque") == 0) {
+            params->holdingTorque = value;
+        } else if (strcmp(name, "corner_rate") == 0) {
+            params->cornerRate = value;
+        } else if (strcmp(name, "top_rate") == 0) {
+            params->topRate = value;
+        } else if (strcmp(name, "rotor_inertia") == 0) {
+            params->rotorInertia = value;
+            ok = value > 0;
+        } else if (strcmp(name, "load_inertia") == 0) {
+            params->loadInertia = value;
+        } else if (strcmp(name, "friction_torque") == 0) {
+            params->frictionTorque = value;
+        } else if (strcmp(name, "damping") == 0) {
+            params->damping = value;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            fprintf(stderr, "%s:%u: bad motor parameter\n", path, number);
+        }
+    }
+    fclose(file);
+    return ok;
+}
+
+// PRIVATE
+
+double StepperModel::availableTorque() const {
+    const double rate = fabs(_velocity) * MODEL_FULL_STEPS / (2 * M_PI); // full steps/s
+    if (rate <= _params.cornerRate) {
+        return _params.holdingTorque;
+    }
+    if (rate >= _params.topRate) {
+        return 0;
+    }
+    return _params.holdingTorque * _params.cornerRate / rate * (_params.topRate - rate) / (_params.topRate - _params.cornerRate);
+}
+
+void StepperModel::integrate(uint64_t time) {
+    if (time <= _time) {
+        return;
+    }
+    if (_settled) {
+        this->_time = time;
+        return;
+    }
+
+    const double stepAngle = 2 * M_PI * POLE_PAIRS / _params.stepsPerRevolution; // electrical
+    const double target = _commanded * stepAngle;
+    const double inertia = _params.rotorInertia + _params.loadInertia;
+    const double friction = _params.frictionTorque;
+    while (_time < time) {
+        const uint64_t span = time - _time < MODEL_TIME_STEP ? time - _time : MODEL_TIME_STEP;
+        const double dt = span * 1e-6;
+        this->_time += span;
+
+        // The rotor falls into the equilibrium nearest to it, whole electrical cycles from the field
+        const double error = target - _angle;
+        const int64_t slips = llround(error / (2 * M_PI));
+        if (slips != _slips) {
+            this->_missed += llabs(slips - _slips) * 4 * _params.stepsPerRevolution / MODEL_FULL_STEPS;
+            if (_firstMiss == 0) {
+                this->_firstMiss = _time;
+            }
+            this->_slips = slips;
+        }
+        const double loadAngle = fabs(error - slips * 2 * M_PI);
+
+        const double torque = _enabled ? this->availableTorque() * sin(error) : 0;
+        const double field = _enabled && _time <= _fieldUntil ? _fieldVelocity : 0;
+        double net;
+        if (_velocity == 0) {
+            // Stiction holds the rotor until the field pulls harder
+            if (fabs(torque) <= friction || loadAngle < REST_ANGLE) {
+                this->_settled = true;
+                this->_time = time;
+                return;
+            }
+            net = torque - copysign(friction, torque);
+        } else {
+            net = torque - copysign(friction, _velocity) - _params.damping * (_velocity - field);
+        }
+
+        double velocity = _velocity + net / inertia * dt;
+        // Stops at a turning point, stiction decides if it moves on
+        if (_velocity != 0 && (velocity > 0) != (_velocity > 0)) {
+            velocity = 0;
+        }
+        if (fabs(velocity) < REST_SPEED && loadAngle < REST_ANGLE) {
+            velocity = 0;
+        }
+        this->_velocity = velocity;
+        this->_angle += velocity * dt * POLE_PAIRS;
+    }
+}
@@ -0,0 +1,187 @@
+#ifndef STEPPER_MODEL_HPP
+#define STEPPER_MODEL_HPP
+
+#include <stdint.h>
+
+#define MODEL_FULL_STEPS 200 // Full steps per revolution of a hybrid stepper, 50 pole pairs
+#define MODEL_TIME_STEP 5 // us, integration step of the rotor
+
+// One motor with its load, SI units at the motor shaft
+struct MotorParams {
+    uint32_t stepsPerRevolution; // STEP pulses per revolution, microstepping included
+    double holdingTorque; // N.m
+    double cornerRate; // full steps/s, torque falls as 1/speed above it
+    double topRate; // full steps/s, no torque left
+    double rotorInertia; // kg.m2
+    double loadInertia; // kg.m2, mandrel, or lead screw plus the carriage reflected through it
+    double frictionTorque; // N.m, includes the lead screw load
+    double damping; // N.m.s/rad, of the rotor speed against the speed of the field
+};
+
+/**
+ * Torque-speed model of a stepper driven by a step/dir driver.
+ *
+ * The driver holds the stator field at the commanded step, the rotor is pulled towards
+ * it with the available torque times the sine of the electrical angle between them,
+ * the load angle. Available torque is the holding torque up to the corner rate and falls
+ * as 1/speed above it, as the winding current does against back EMF, tapering to nothing
+ * at the top rate where the supply cannot drive current in at all. That torque drives
+ * the rotor and load inertia against coulomb friction, and the rotor is damped towards
+ * the speed of the field, which is what settles its ringing after a step.
+ *
+ * A load angle past 180 electrical degrees pulls the rotor into the next equilibrium,
+ * four full steps away. Every such slip is counted as missed steps, the rotor carries on
+ * with the lost position as a stalled stepper does.
+ */
+class StepperModel {
+public:
+    /**
+     * @brief Create a new instance of the stepper model, at rest and disabled.
+     */
+    StepperModel();
+
+    /**
+     * @brief Sets the motor and load, clears the rotor state and the counters
+     *
+     * @param params motor and load
+     */
+    void begin(const MotorParams &params);
+
+    /**
+     * @brief Powers the driver up or down, the rotor coasts while disabled
+     *
+     * Steps while disabled are ignored, as the DRV8825 does asleep.
+     *
+     * @param enabled true once awake
+     * @param time us
+     */
+    void enable(bool enabled, uint64_t time);
+
+    /**
+     * @brief Moves the stator field one step
+     *
+     * @param forward direction of the step
+     * @param time us, not before the last call
+     */
+    void step(bool forward, uint64_t time);
+
+    /**
+     * @brief Runs the rotor on to a time without a new step
+     *
+     * @param time us, not before the last call
+     */
+    void update(uint64_t time);
+
+    /**
+     * @brief Getter for the commanded position
+     *
+     * @returns STEP pulses taken, backwards ones negative
+     */
+    int64_t commanded() const;
+
+    /**
+     * @brief Getter for the rotor position
+     *
+     * @returns rotor position in STEP pulses
+     */
+    double position() const;
+
+    /**
+     * @brief Getter for the step the rotor settles on
+     *
+     * @returns commanded position less the slipped steps
+     */
+    int64_t heldStep() const;
+
+    /**
+     * @brief Getter for the rotor speed
+     *
+     * @returns steps/s
+     */
+    double speed() const;
+
+    /**
+     * @brief Getter for the missed steps
+     *
+     * @returns steps lost to slips in either direction
+     */
+    uint64_t missedSteps() const;
+
+    /**
+     * @brief Getter for the time of the first slip
+     *
+     * @returns us, 0 if there was none
+     */
+    uint64_t firstMiss() const;
+
+    /**
+     * @brief Getter for the largest load angle, taken right after each step
+     *
+     * A step alone is 90 degrees in full steps, the rest is the rotor lagging behind.
+     * Past 180 degrees the rotor slips.
+     *
+     * @returns electrical degrees
+     */
+    double peakLoadAngle() const;
+
+    /**
+     * @brief Getter for when the largest load angle was reached
+     *
+     * @returns us
+     */
+    uint64_t peakTime() const;
+
+    /**
+     * @brief Clears the counters and the peak load angle, keeps the rotor state
+     */
+    void clearCounters();
+
+    /**
+     * @brief Provides the parameters of the spindle motor with an empty mandrel
+     *
+     * @returns defaults, measured values belong in a parameter file
+     */
+    static MotorParams spindle();
+
+    /**
+     * @brief Provides the parameters of the carriage motor and lead screw
+     *
+     * @returns defaults, measured values belong in a parameter file
+     */
+    static MotorParams carriage();
+
+    /**
+     * @brief Reads a parameter file over the given parameters
+     *
+     * Lines are "<ss|cc>.<name> <value>", # starts a comment. Names are the MotorParams
+     * fields in snake case, e.g. ss.holding_torque 0.45. Missing names keep their value.
+     *
+     * @param path file to read
+     * @param ss spindle parameters to update
+     * @param cc carriage parameters to update
+     * @returns false if the file cannot be read or has a bad line, reported on stderr
+     */
+    static bool load(const char *path, MotorParams &ss, MotorParams &cc);
+
+private:
+    double availableTorque() const;
+    void integrate(uint64_t time);
+
+    MotorParams _params;
+    bool _enabled = false;
+    uint64_t _time = 0; // us
+    int64_t _commanded = 0; // steps
+    double _angle = 0; // electrical radians
+    double _velocity = 0; // mechanical rad/s
+    uint64_t _lastStep = 0; // us
+    double _fieldVelocity = 0; // mechanical rad/s, over the last step period
+    uint64_t _fieldUntil = 0; // us, the field stands still if no step comes by then
+    bool _settled = true; // at rest against friction, nothing changes until the next step
+    int64_t _slips = 0; // electrical cycles the rotor is behind, negative if ahead
+    uint64_t _missed = 0;
+    uint64_t _firstMiss = 0; // us
+    double _peakLoadAngle = 0; // electrical radians
+    uint64_t _peakTime = 0; // us
+};
+
+#endif
@@ -0,0 +1,137 @@
+#include "JobEstimate.hpp"
+
+JobEstimate::JobEstimate() {}
+
+// PUBLIC
+
+void JobEstimate::begin(const WindKernel &kernel, uint32_t radius, uint32_t stepTime) {
+    this->_radius = radius * 100;
+    this->_stepTime = stepTime;
+    this->_rateSum = 0;
+    this->_wireTotal = 0;
+    this->_layerCount = 0;
+
+    // Start of the current layer, moved to the planned one below if the job is under way
+    this->_section = kernel.section();
+    this->_layer = kernel.layer();
+    this->_layerStart = kernel.stepCount();
+    this->_height = 0;
+    this->_circumference = this->circumference(0, kernel.plan(_section).diameter);
+    this->_wireDone = 0;
+    this->_layersDone = 0;
+
+    const WindPattern &pattern = kernel.pattern();
+    uint32_t step = 0;
+    int32_t carriage = 0;
+    for (uint8_t i = 0; i < kernel.sectionCount(); i++) {
+        const SectionPlan &plan = kernel.plan(i);
+
+        // The carriage leaves a section anywhere along it, halfway on average
+        const int32_t distance = plan.start - carriage;
+        this->_traverseSteps[i] = (distance < 0 ? -distance : distance) / DISTANCE_PER_STEP;
+        carriage = (plan.start + plan.span) / 2;
+
+        uint32_t height = 0;
+        for (uint32_t layer = 0; step < plan.endStep; layer++) {
+            const uint32_t circumference = this->circumference(height, plan.diameter);
+
+            // Last planned layer at or before the kernel one
+            if (i == kernel.section() && layer <= kernel.layer() && step <= kernel.stepCount()) {
+                this->_layer = layer;
+                this->_layerStart = step;
+                this->_height = height;
+                this->_circumference = circumference;
+                this->_wireDone = _wireTotal;
+                this->_layersDone = _layerCount;
+            }
+
+            uint32_t steps = kernel.layerSteps(i, layer);
+            if (steps > plan.endStep - step) {
+                steps = plan.endStep - step;
+            }
+            this->_wireTotal += ((uint64_t) steps * circumference) / SS_STEPS_PER_REVOLUTION;
+            this->_layerCount++;
+            step += steps;
+            height += pattern.layerHeight(layer, plan.diameter);
+        }
+    }
+}
+
+void JobEstimate::measure(uint32_t rate) {
+    if (_rateSum == 0) {
+        this->_rateSum = rate << ESTIMATE_SMOOTHING;
+    } else {
+        this->_rateSum = _rateSum - (_rateSum >> ESTIMATE_SMOOTHING) + rate;
+    }
+}
+
+void JobEstimate::update(const WindKernel &kernel) {
+    if (kernel.section() == _section && kernel.layer() == _layer) {
+        return;
+    }
+
+    // Close the layer at the height it was wound at
+    const uint32_t stepCount = kernel.stepCount();
+    if (stepCount > _layerStart) {
+        this->_wireDone += ((uint64_t) (stepCount - _layerStart) * _circumference) / SS_STEPS_PER_REVOLUTION;
+    }
+
+    const SectionPlan &plan = kernel.plan(kernel.section());
+    if (kernel.section() != _section) {
+        // The next section starts on the mandrel
+        this->_height = 0;
+    } else {
+        this->_height += kernel.pattern().layerHeight(_layer, plan.diameter);
+    }
+    this->_section = kernel.section();
+    this->_layer = kernel.layer();
+    this->_layerStart = stepCount;
+    this->_circumference = this->circumference(_height, plan.diameter);
+    this->_layersDone++;
+}
+
+uint32_t JobEstimate::rate() const {
+    if (_rateSum > 0) {
+        return _rateSum >> ESTIMATE_SMOOTHING;
+    }
+    return _stepTime > 0 ? 1000000 / _stepTime : 0;
+}
+
+uint32_t JobEstimate::remainingTime(const WindKernel &kernel) const {
+    const uint32_t rate = this->rate();
+    uint64_t time = rate > 0 ? ((uint64_t) (kernel.totalSteps() - kernel.stepCount()) * 1000000) / rate : 0; // us
+
+    // Carriage moves to the sections still to come, no SS steps while they run
+    for (uint8_t i = kernel.section() + 1; i < kernel.sectionCount(); i++) {
+        time += (uint64_t) _traverseSteps[i] * _stepTime;
+    }
+    return time / 1000000;
+}
+
+uint32_t JobEstimate::wireUsed(const WindKernel &kernel) const {
+    uint64_t wire = _wireDone;
+    if (kernel.stepCount() > _layerStart) {
+        wire += ((uint64_t) (kernel.stepCount() - _layerStart) * _circumference) / SS_STEPS_PER_REVOLUTION;
+    }
+    return wire / 1000;
+}
+
+uint32_t JobEstimate::wireTotal() const {
+    return _wireTotal / 1000;
+}
+
+uint32_t JobEstimate::layersDone() const {
+    return _layersDone;
+}
+
+uint32_t JobEstimate::layerCount() const {
+    return _layerCount;
+}
+
+// PRIVATE
+
+uint32_t JobEstimate::circumference(uint32_t height, uint32_t diameter) const {
+    // Wire centre sits half a diameter above the layers below
+    const uint64_t radius = _radius + height + diameter / 2;
+    return (2 * radius * PI_SCALED) / 10000;
+}
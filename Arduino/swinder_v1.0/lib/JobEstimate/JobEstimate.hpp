@@ -0,0 +1,121 @@
+#ifndef JOB_ESTIMATE_HPP
+#define JOB_ESTIMATE_HPP
+
+#include <Arduino.h>
+#include <WindKernel.hpp>
+#include <Machine.hpp>
+
+#define ESTIMATE_SMOOTHING 3 // Each rate window weighs 1/2^3 of the average
+#define PI_SCALED 31416 // pi, 0.0001 precision
+
+/**
+ * Time left and wire used of a planned job, read from the kernel it follows.
+ * Time comes from the measured SS step rate plus the carriage moves between sections.
+ * Wire is the turns of every layer times the circumference at the height of that layer.
+ * Lengths are um internally, mm out.
+ */
+class JobEstimate {
+public:
+    /**
+     * @brief Create a new instance of the job estimate, with nothing planned.
+     */
+    JobEstimate();
+
+    /**
+     * @brief Plans the wire of the whole job and finds where the kernel is in it
+     * Call once the kernel is planned, and restored when resuming
+     *
+     * @param kernel kernel winding the job
+     * @param radius mandrel radius, 0.01cm
+     * @param stepTime us per step, used until a rate is measured
+     */
+    void begin(const WindKernel &kernel, uint32_t radius, uint32_t stepTime);
+
+    /**
+     * @brief Adds a step rate measurement to the average
+     *
+     * @param rate SS steps/s measured over a window
+     */
+    void measure(uint32_t rate);
+
+    /**
+     * @brief Follows the kernel onto a new layer or section, call after the carriage reversed
+     *
+     * @param kernel kernel winding the job
+     */
+    void update(const WindKernel &kernel);
+
+    /**
+     * @brief Getter for the average step rate
+     *
+     * @returns SS steps/s, the planned rate until one is measured
+     */
+    uint32_t rate() const;
+
+    /**
+     * @brief Time to the end of the job at the average rate
+     *
+     * @param kernel kernel winding the job
+     * @returns seconds left
+     */
+    uint32_t remainingTime(const WindKernel &kernel) const;
+
+    /**
+     * @brief Wire wound so far
+     *
+     * @param kernel kernel winding the job
+     * @returns wire used, mm
+     */
+    uint32_t wireUsed(const WindKernel &kernel) const;
+
+    /**
+     * @brief Getter for the wire of the whole job
+     *
+     * @returns wire needed, mm
+     */
+    uint32_t wireTotal() const;
+
+    /**
+     * @brief Getter for the layers wound so far, of all sections
+     *
+     * @returns finished layers
+     */
+    uint32_t layersDone() const;
+
+    /**
+     * @brief Getter for the layers of the whole job, of all sections
+     *
+     * @returns planned layers
+     */
+    uint32_t layerCount() const;
+
+private:
+    /**
+     * @brief Circumference at the centre of a layer
+     *
+     * @param height build of the layers below, um
+     * @param diameter wire diameter, um
+     * @returns circumference, um
+     */
+    uint32_t circumference(uint32_t height, uint32_t diameter) const;
+
+    uint32_t _radius = 0; // um
+    uint32_t _stepTime = 0; // us
+    uint32_t _rateSum = 0; // Average rate shifted by ESTIMATE_SMOOTHING, 0 until measured
+
+    // Plan
+    uint64_t _wireTotal = 0; // um
+    uint32_t _layerCount = 0;
+    uint32_t _traverseSteps[MAX_SECTIONS] = {0}; // CC steps to reach each section from the last one
+
+    // Current layer
+    uint8_t _section = 0;
+    uint32_t _layer = 0;
+    uint32_t _layerStart = 0; // Step count the layer started at
+    uint32_t _height = 0; // um
+    uint32_t _circumference = 0; // um
+    uint64_t _wireDone = 0; // um before the layer
+    uint32_t _layersDone = 0;
+};
+
+#endif
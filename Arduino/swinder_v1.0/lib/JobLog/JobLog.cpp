@@ -0,0 +1,126 @@
+#include "JobLog.hpp"
+#include <EEPROM.h>
+
+JobLog::JobLog() {}
+
+// PUBLIC
+
+void JobLog::begin() {
+    uint32_t newest = 0;
+    uint32_t newestSequence = 0;
+    bool found = false;
+
+    this->_size = 0;
+    for (uint32_t slot = 0; slot < JOB_LOG_CAPACITY; slot++) {
+        uint32_t sequence;
+        EEPROM.get(this->slotAddress(slot), sequence);
+        if (sequence == JOB_LOG_EMPTY) {
+            continue;
+        }
+
+        this->_size++;
+        if (!found || sequence > newestSequence) {
+            newestSequence = sequence;
+            newest = slot;
+            found = true;
+        }
+    }
+
+    this->_next = found ? (newest + 1) % JOB_LOG_CAPACITY : 0;
+    this->_sequence = found ? newestSequence + 1 : 0;
+}
+
+void JobLog::append(JobRecord &record) {
+    record.sequence = this->_sequence++;
+    // Never write the erased marker as a sequence number
+    if (this->_sequence == JOB_LOG_EMPTY) {
+        this->_sequence = 0;
+    }
+
+    EEPROM.put(this->slotAddress(this->_next), record);
+
+    this->_next = (this->_next + 1) % JOB_LOG_CAPACITY;
+    if (this->_size < JOB_LOG_CAPACITY) {
+        this->_size++;
+    }
+}
+
+uint32_t JobLog::size() {
+    return _size;
+}
+
+bool JobLog::read(uint32_t index, JobRecord &record) {
+    if (index >= _size) {
+        return false;
+    }
+    uint32_t slot = (_next + JOB_LOG_CAPACITY - 1 - index) % JOB_LOG_CAPACITY;
+    EEPROM.get(this->slotAddress(slot), record);
+    return true;
+}
+
+JobSummary JobLog::summary() {
+    JobSummary summary = {0, 0, 0, 0};
+    uint64_t totalTime = 0;
+    uint64_t windTime = 0;
+
+    JobRecord record;
+    for (uint32_t i = 0; i < _size; i++) {
+        this->read(i, record);
+        summary.jobs++;
+        totalTime += (uint64_t) record.wallTime + record.setupTime;
+        if (record.status == JobStatus::COMPLETED) {
+            summary.completed++;
+            windTime += record.windTime;
+        }
+    }
+
+    if (totalTime > 0) {
+        // coils / h * 10 = completed * 3600000 ms * 10 / total ms
+        summary.coilsPerHourX10 = (summary.completed * 36000000ULL) / totalTime;
+    }
+    if (summary.completed > 0) {
+        summary.avgWindTime = windTime / summary.completed;
+    }
+    return summary;
+}
+
+void JobLog::dump(Print &out) {
+    out.println("seq,status,length,radius,inductance,gauge,turns,wound,wall_ms,wind_ms,avg_sps,peak_sps,pauses,faults,setup_ms");
+
+    // Oldest first
+    JobRecord record;
+    for (uint32_t i = _size; i > 0; i--) {
+        this->read(i - 1, record);
+        out.println(
+            String(record.sequence) + "," +
+            (record.status == JobStatus::COMPLETED ? "done" : "abort") + "," +
+            String(record.length) + "," +
+            String(record.radius) + "," +
+            String(record.inductance) + "," +
+            String(record.gauge) + "," +
+            String(record.turnsTarget) + "," +
+            String(record.turnsWound) + "," +
+            String(record.wallTime) + "," +
+            String(record.windTime) + "," +
+            String(record.avgRate) + "," +
+            String(record.peakRate) + "," +
+            String(record.pauses) + "," +
+            String(record.faults) + "," +
+            String(record.setupTime)
+        );
+    }
+
+    JobSummary summary = this->summary();
+    out.println(
+        "jobs=" + String(summary.jobs) +
+        " completed=" + String(summary.completed) +
+        " coils_per_hour=" + String(summary.coilsPerHourX10 / 10) + "." + String(summary.coilsPerHourX10 % 10) +
+        " avg_wind_s=" + String(summary.avgWindTime / 1000)
+    );
+}
+
+// PRIVATE
+
+uint32_t JobLog::slotAddress(uint32_t slot) {
+    return JOB_LOG_EEPROM_ADDR + slot * sizeof(JobRecord);
+}
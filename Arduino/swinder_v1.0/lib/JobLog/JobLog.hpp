@@ -0,0 +1,107 @@
+#ifndef JOB_LOG_HPP
+#define JOB_LOG_HPP
+
+#include <Arduino.h>
+
+#define JOB_LOG_EEPROM_ADDR 128 // After Checkpoint and FaultMonitor
+#define JOB_LOG_CAPACITY 48 // 48 * 40 bytes = 1920 bytes of EEPROM
+#define JOB_LOG_EMPTY 0xFFFFFFFF // Erased flash value of the sequence number
+
+enum JobStatus {
+    COMPLETED = 0,
+    ABORTED = 1,
+};
+
+/**
+ * One log entry per finished job. Rates are SS steps per second,
+ * times are in ms.
+ */
+struct JobRecord {
+    uint32_t sequence;
+    uint8_t status;
+    uint8_t gauge;
+    uint8_t pauses;
+    uint8_t faults;
+    uint16_t length;
+    uint16_t radius;
+    uint32_t inductance;
+    uint32_t turnsTarget;
+    uint32_t turnsWound;
+    uint32_t wallTime; // Start to end, including pauses and faults
+    uint32_t windTime; // Time spent stepping
+    uint16_t avgRate;
+    uint16_t peakRate;
+    uint32_t setupTime; // End of the previous job (or boot) to start of this one
+};
+
+/**
+ * Aggregate over every record still in the log
+ */
+struct JobSummary {
+    uint32_t jobs;
+    uint32_t completed;
+    uint32_t coilsPerHourX10; // Completed coils per hour of wall and setup time, 0.1 precision
+    uint32_t avgWindTime; // ms, completed jobs only
+};
+
+class JobLog {
+public:
+    /**
+     * @brief Create a new instance of the job log.
+     */
+    JobLog();
+
+    /**
+     * @brief Scans the log for the newest record to find the ring position
+     */
+    void begin();
+
+    /**
+     * @brief Appends a record, overwriting the oldest one once the log is full
+     *
+     * Each slot is only written once per JOB_LOG_CAPACITY jobs and there is no
+     * separate head pointer, so no single location wears faster than the rest.
+     *
+     * @param record record to store, sequence is assigned by the log
+     */
+    void append(JobRecord &record);
+
+    /**
+     * @brief Getter for the number of records stored
+     *
+     * @returns number of valid records
+     */
+    uint32_t size();
+
+    /**
+     * @brief Reads a record
+     *
+     * @param index 0 for the newest record, size() - 1 for the oldest
+     * @param record record to read into
+     * @returns false if index is out of range
+     */
+    bool read(uint32_t index, JobRecord &record);
+
+    /**
+     * @brief Computes throughput statistics over the whole log
+     *
+     * @returns summary of stored records
+     */
+    JobSummary summary();
+
+    /**
+     * @brief Writes every record and the summary as CSV
+     *
+     * @param out stream to print to
+     */
+    void dump(Print &out);
+
+private:
+    uint32_t slotAddress(uint32_t slot);
+
+    uint32_t _next = 0; // Slot the next record goes to
+    uint32_t _size = 0;
+    uint32_t _sequence = 0; // Sequence of the next record
+};
+
+#endif
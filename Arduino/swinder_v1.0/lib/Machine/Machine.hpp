@@ -0,0 +1,29 @@
+#ifndef MACHINE_HPP
+#define MACHINE_HPP
+
+// Machine constants shared by the firmware and the host tools
+
+// Stepper Values
+#define SS_STEPS_PER_REVOLUTION 200 // Whole steps
+#define CC_STEPS_PER_REVOLUTION 400 // Half steps
+#define DISTANCE_PER_REVOLUTION 800 // 0.8 cm of carriage travel
+#define DISTANCE_PER_STEP 2 // 0.002 cm of carriage travel
+
+// Jobs
+#define MAX_JOB_TURNS 21474836 // SS steps of a whole job fit in 32 bits
+
+// Carriage
+#define CARRIAGE_OFFSET 500 // 0.5 cm
+#define PADDING 5 // Potentially needed error correction value to add/subtract from the start and end; 0.001 accuracy
+
+// Carriage moves outside the winding, to the start and back to an interrupted job
+// Safe with the default carriage model, see ramp --motor cc --sweep
+#define CARRIAGE_RAPID_START 1000 // steps/s from rest, no ramp below it
+#define CARRIAGE_RAPID_RATE 4000 // steps/s
+#define CARRIAGE_RAPID_ACCEL 10000 // steps/s2
+
+// Timing
+#define MOTOR_DELAY 800 //ps
+#define DRIVER_MIN_PULSE 2 // us, DRV8825 needs 1.9us high and 1.9us low on STEP
+
+#endif
@@ -0,0 +1,307 @@
+#include "Menu.hpp"
+#include <Format.hpp>
+
+Menu::Menu() {}
+
+// PUBLIC
+
+void Menu::begin(LiquidCrystal_I2C &lcd) {
+    this->_lcd = &lcd;
+}
+
+void Menu::showOptions(const MenuOptions &options, uint8_t selected) {
+    this->_mode = Mode::MODE_OPTIONS;
+    this->_options = &options;
+    this->_fields = nullptr;
+    this->_count = options.count;
+    this->_selected = selected < options.count ? selected : 0;
+    this->_titleOverride = false;
+    this->_synced = false;
+    this->_pressed = true;
+    this->_dirty = Dirty::DIRTY_TITLE | Dirty::DIRTY_ROW | Dirty::DIRTY_CURSOR;
+}
+
+void Menu::showFields(const MenuField *fields, uint8_t count, uint8_t selected) {
+    this->_mode = Mode::MODE_BROWSE;
+    this->_options = nullptr;
+    this->_fields = fields;
+    this->_count = count;
+    this->_selected = selected < count ? selected : 0;
+    this->_titleOverride = false;
+    this->_editing = false;
+    this->_synced = false;
+    this->_pressed = true;
+    this->_dirty = Dirty::DIRTY_TITLE | Dirty::DIRTY_ROW | Dirty::DIRTY_CURSOR;
+}
+
+void Menu::setTitle(const String &title) {
+    this->_title = title;
+    this->_titleOverride = true;
+    this->_dirty |= Dirty::DIRTY_TITLE;
+}
+
+int16_t Menu::update(long position, bool pressed) {
+    int16_t selected = MENU_NONE;
+
+    // Rotation
+    if (!_synced) {
+        this->_position = position;
+        this->_synced = true;
+    }
+    uint32_t now = millis();
+    if (position != _position) {
+        this->move(position - _position, now);
+        this->_position = position;
+    }
+
+    // Press on the falling edge, held buttons and bounces are ignored
+    if (pressed && !_pressed && now - _lastPress >= MENU_BUTTON_LOCKOUT) {
+        this->_lastPress = now;
+        selected = this->press();
+    }
+    this->_pressed = pressed;
+
+    this->render();
+    return selected;
+}
+
+void Menu::hideCursor() {
+    if (_lcd != nullptr) {
+        _lcd->noCursor();
+        _lcd->noBlink();
+    }
+    this->_cursorShown = false;
+    this->_blinking = false;
+    this->_dirty |= Dirty::DIRTY_CURSOR;
+}
+
+void Menu::refresh() {
+    if (_mode == Mode::MODE_EDIT) {
+        this->_value = _fields[_selected].get();
+    }
+    this->_dirty |= Dirty::DIRTY_TITLE | Dirty::DIRTY_ROW | Dirty::DIRTY_CURSOR;
+}
+
+// PRIVATE
+
+void Menu::move(int32_t delta, uint32_t now) {
+    switch (_mode) {
+        case Mode::MODE_OPTIONS:
+        case Mode::MODE_BROWSE: {
+            int32_t next = (int32_t) _selected + delta;
+            if (next < 0) {
+                next = 0;
+            } else if (next >= _count) {
+                next = _count - 1;
+            }
+            if (next == _selected) {
+                return;
+            }
+            this->_selected = next;
+            this->_dirty |= _mode == Mode::MODE_OPTIONS ? Dirty::DIRTY_CURSOR : Dirty::DIRTY_TITLE | Dirty::DIRTY_ROW;
+            return;
+        }
+        case Mode::MODE_EDIT:
+            break;
+    }
+
+    const MenuField &field = _fields[_selected];
+    if (_editing && field.type == MenuFieldType::FIELD_CHOICE) {
+        int32_t next = (int32_t) _value + delta;
+        this->_value = next < 0 ? 0 : (next > (int32_t) field.max ? field.max : next);
+        this->_dirty |= Dirty::DIRTY_VALUE | Dirty::DIRTY_CURSOR;
+        return;
+    }
+    if (_editing) {
+        // Smoothed time per detent, a long pause starts slow again
+        uint32_t detents = delta > 0 ? delta : -delta;
+        uint32_t interval = (now - _lastDetent) / detents;
+        this->_lastDetent = now;
+        if (interval >= MENU_ACCEL_SLOW) {
+            this->_detentInterval = MENU_ACCEL_SLOW;
+        } else {
+            this->_detentInterval = (_detentInterval * 3 + interval) / 4;
+        }
+
+        // Each detent changes the value by the weight of the digit under the cursor, times the acceleration
+        uint64_t step = (uint64_t) this->scaler() * this->acceleration() * detents;
+        if (delta > 0) {
+            this->_value = _value + step > field.max ? field.max : _value + step;
+        } else {
+            this->_value = step > _value ? 0 : _value - step;
+        }
+        this->_dirty |= Dirty::DIRTY_VALUE | Dirty::DIRTY_CURSOR;
+        return;
+    }
+
+    // Cursor over the digits, skipping the point, then Done
+    const uint8_t width = this->valueWidth();
+    const uint8_t point = width - 3;
+    for (; delta > 0 && _cursor != MENU_DONE_COLUMN; delta--) {
+        if (field.type == MenuFieldType::FIELD_CHOICE || _cursor + 1 >= width) {
+            this->_cursor = MENU_DONE_COLUMN;
+        } else {
+            this->_cursor += (_cursor + 1 == point) ? 2 : 1;
+        }
+    }
+    for (; delta < 0 && _cursor > 0; delta++) {
+        if (_cursor == MENU_DONE_COLUMN) {
+            this->_cursor = width - 1;
+        } else if (field.type == MenuFieldType::FIELD_NUMBER) {
+            this->_cursor -= (_cursor - 1 == point) ? 2 : 1;
+        } else {
+            break;
+        }
+    }
+    this->_dirty |= Dirty::DIRTY_CURSOR;
+}
+
+uint32_t Menu::acceleration() {
+    // Quadratic in the detent rate so slow turns stay exact and fast spins cross the range
+    if (_detentInterval >= MENU_ACCEL_SLOW) {
+        return 1;
+    }
+    uint32_t ratio = MENU_ACCEL_SLOW / (_detentInterval > 0 ? _detentInterval : 1);
+    uint32_t multiple = ratio * ratio;
+    return multiple > MENU_ACCEL_MAX ? MENU_ACCEL_MAX : multiple;
+}
+
+int16_t Menu::press() {
+    switch (_mode) {
+        case Mode::MODE_OPTIONS:
+            return _selected;
+        case Mode::MODE_BROWSE:
+            if (_fields[_selected].type == MenuFieldType::FIELD_ACTION) {
+                return _selected;
+            }
+            this->startEdit();
+            return MENU_NONE;
+        case Mode::MODE_EDIT:
+            break;
+    }
+
+    if (_cursor == MENU_DONE_COLUMN) {
+        const MenuField &field = _fields[_selected];
+        if (field.set != nullptr) {
+            field.set(_value);
+        }
+        this->_mode = Mode::MODE_BROWSE;
+        this->_editing = false;
+        this->_dirty |= Dirty::DIRTY_ROW | Dirty::DIRTY_CURSOR;
+    } else {
+        this->_editing = !_editing;
+        this->_dirty |= Dirty::DIRTY_CURSOR;
+    }
+    return MENU_NONE;
+}
+
+void Menu::startEdit() {
+    this->_mode = Mode::MODE_EDIT;
+    this->_value = _fields[_selected].get();
+    this->_editing = false;
+    // Start on the last digit, or the last character of a choice
+    this->_cursor = this->valueWidth() - 1;
+    this->_dirty |= Dirty::DIRTY_ROW | Dirty::DIRTY_CURSOR;
+}
+
+void Menu::render() {
+    if (_lcd == nullptr || _dirty == 0) {
+        return;
+    }
+
+    // Rows are overwritten with padding rather than cleared to avoid flicker
+    if (_dirty & Dirty::DIRTY_TITLE) {
+        _lcd->setCursor(0, 0);
+        _lcd->print(pad(this->title(), MENU_COLUMNS));
+    }
+
+    if (_dirty & Dirty::DIRTY_ROW) {
+        String row = "";
+        if (_mode == Mode::MODE_OPTIONS) {
+            for (uint8_t i = 0; i < _count; i++) {
+                row = pad(row, this->optionColumn(i)) + _options->labels[i];
+            }
+        } else if (_mode == Mode::MODE_BROWSE) {
+            row = this->valueString(_fields[_selected].get());
+        } else {
+            row = pad(this->valueString(_value), MENU_DONE_COLUMN) + "Done";
+        }
+        _lcd->setCursor(0, 1);
+        _lcd->print(pad(row, MENU_COLUMNS));
+    } else if (_dirty & Dirty::DIRTY_VALUE) {
+        _lcd->setCursor(0, 1);
+        _lcd->print(pad(this->valueString(_value), MENU_DONE_COLUMN));
+    }
+
+    // Cursor last so it ends up where the input is
+    bool cursorShown = _mode != Mode::MODE_BROWSE;
+    bool blinking = _mode == Mode::MODE_OPTIONS || _editing;
+    if (cursorShown) {
+        _lcd->setCursor(_mode == Mode::MODE_OPTIONS ? this->optionColumn(_selected) : _cursor, 1);
+    }
+    if (cursorShown != _cursorShown) {
+        if (cursorShown) {
+            _lcd->cursor();
+        } else {
+            _lcd->noCursor();
+        }
+        this->_cursorShown = cursorShown;
+    }
+    if (blinking != _blinking) {
+        if (blinking) {
+            _lcd->blink();
+        } else {
+            _lcd->noBlink();
+        }
+        this->_blinking = blinking;
+    }
+
+    this->_dirty = 0;
+}
+
+String Menu::title() {
+    if (_titleOverride) {
+        return _title;
+    }
+    return _mode == Mode::MODE_OPTIONS ? String(_options->title) : String(_fields[_selected].title);
+}
+
+String Menu::valueString(uint32_t value) {
+    const MenuField &field = _fields[_selected];
+    if (field.format != nullptr) {
+        return field.format(value);
+    }
+    return formatVal(value, field.max);
+}
+
+uint8_t Menu::optionColumn(uint8_t option) {
+    return option * (MENU_COLUMNS / _count);
+}
+
+uint8_t Menu::valueWidth() {
+    const MenuField &field = _fields[_selected];
+    if (field.type == MenuFieldType::FIELD_NUMBER) {
+        return String(field.max).length() + 1;
+    }
+    uint8_t width = this->valueString(_value).length();
+    return width > 0 ? width : 1;
+}
+
+uint32_t Menu::scaler() {
+    // Digits after the point are worth 10 and 1, digits before it 100 and up
+    const uint8_t width = this->valueWidth();
+    uint8_t power = _cursor > width - 3 ? width - 1 - _cursor : width - 2 - _cursor;
+    uint32_t scaler = 1;
+    while (power-- > 0) {
+        scaler *= 10;
+    }
+    return scaler;
+}
+
+String Menu::pad(const String &text, uint8_t width) {
+    String padded = text;
+    while (padded.length() < width) {
+        padded += ' ';
+    }
+    return padded;
+}
@@ -0,0 +1,173 @@
+#ifndef MENU_HPP
+#define MENU_HPP
+
+#include <Arduino.h>
+#include <LiquidCrystal_I2C.h>
+
+#define MENU_COLUMNS 16
+#define MENU_DONE_COLUMN 11 // Column of "Done" while editing a field
+#define MENU_BUTTON_LOCKOUT 200 // ms after a press before another one counts
+#define MENU_NONE -1
+#define MENU_ACCEL_SLOW 60 // ms between detents below which value changes speed up
+#define MENU_ACCEL_MAX 100 // Largest multiple of the digit weight per detent
+
+enum MenuFieldType {
+    FIELD_NUMBER = 0, // Fixed point with 2 decimals up to max, edited digit by digit
+    FIELD_CHOICE = 1, // 0 to max, edited as a whole
+    FIELD_ACTION = 2, // Read only, pressing selects it
+};
+
+typedef uint32_t (*FieldGetter)();
+typedef void (*FieldSetter)(uint32_t value);
+typedef String (*FieldFormat)(uint32_t value);
+
+/**
+ * One page of a field list, title on the top row and value on the bottom row
+ */
+struct MenuField {
+    const char *key; // Name for setting the field from the console
+    const char *title;
+    MenuFieldType type;
+    uint32_t max;
+    FieldGetter get;
+    FieldSetter set; // Called once editing is done, nullptr for actions
+    FieldFormat format; // nullptr shows the value with formatVal()
+};
+
+/**
+ * A title and up to MENU_COLUMNS / 2 options spread evenly over the bottom row
+ */
+struct MenuOptions {
+    const char *title;
+    const char *const *labels;
+    uint8_t count;
+};
+
+/**
+ * Input and render core for the table driven screens.
+ * Screens are described by const MenuOptions and MenuField tables, update() takes the
+ * encoder and button state and only redraws what changed. Never blocks.
+ */
+class Menu {
+public:
+    /**
+     * @brief Create a new instance of the menu engine.
+     */
+    Menu();
+
+    /**
+     * @brief Sets the display screens are drawn on
+     *
+     * @param lcd 16x2 character display
+     */
+    void begin(LiquidCrystal_I2C &lcd);
+
+    /**
+     * @brief Shows an options screen
+     *
+     * @param options screen table, must outlive the screen
+     * @param selected option the cursor starts on
+     */
+    void showOptions(const MenuOptions &options, uint8_t selected);
+
+    /**
+     * @brief Shows a list of fields, one page per field
+     *
+     * @param fields field table, must outlive the screen
+     * @param count number of fields
+     * @param selected field shown first
+     */
+    void showFields(const MenuField *fields, uint8_t count, uint8_t selected);
+
+    /**
+     * @brief Replaces the title of the current screen until the next show
+     *
+     * @param title text for the top row
+     */
+    void setTitle(const String &title);
+
+    /**
+     * @brief Handles input and redraws changed parts of the screen
+     *
+     * The first call after a show only takes the encoder position, and a button
+     * held down when the screen was shown has to be released before it counts.
+     *
+     * @param position encoder position in detents
+     * @param pressed true while the button is held down
+     * @returns index of the selected option or action field, MENU_NONE otherwise
+     */
+    int16_t update(long position, bool pressed);
+
+    /**
+     * @brief Turns the cursor off before other code draws on the display
+     *
+     * The cursor comes back with the next update()
+     */
+    void hideCursor();
+
+    /**
+     * @brief Redraws the screen after a field was changed elsewhere
+     *
+     * A field being edited takes the new value
+     */
+    void refresh();
+
+private:
+    enum Mode {
+        MODE_OPTIONS = 0,
+        MODE_BROWSE = 1, // Moving between fields
+        MODE_EDIT = 2, // Moving between the digits of a field and Done
+    };
+
+    // Parts of the screen to redraw
+    enum Dirty {
+        DIRTY_TITLE = 0x01,
+        DIRTY_ROW = 0x02, // Whole bottom row
+        DIRTY_VALUE = 0x04, // Value of the field being edited
+        DIRTY_CURSOR = 0x08,
+    };
+
+    void move(int32_t delta, uint32_t now);
+    uint32_t acceleration();
+    int16_t press();
+    void startEdit();
+    void render();
+
+    String title();
+    String valueString(uint32_t value);
+    uint8_t optionColumn(uint8_t option);
+    uint8_t valueWidth();
+    uint32_t scaler();
+
+    static String pad(const String &text, uint8_t width);
+
+    LiquidCrystal_I2C *_lcd = nullptr;
+    Mode _mode = Mode::MODE_OPTIONS;
+    uint8_t _dirty = 0;
+
+    const MenuOptions *_options = nullptr;
+    const MenuField *_fields = nullptr;
+    uint8_t _count = 0;
+    uint8_t _selected = 0;
+    String _title;
+    bool _titleOverride = false;
+
+    // Field being edited
+    uint32_t _value = 0;
+    uint8_t _cursor = 0; // Column on the bottom row
+    bool _editing = false; // Rotation changes the value rather than moving the cursor
+    uint32_t _lastDetent = 0; // ms
+    uint32_t _detentInterval = MENU_ACCEL_SLOW; // ms, smoothed
+
+    // Input state
+    bool _synced = false;
+    long _position = 0;
+    bool _pressed = true;
+    uint32_t _lastPress = 0; // ms
+
+    // Display state, cursor and blink are only sent when they change
+    bool _cursorShown = false;
+    bool _blinking = false;
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "QuadDecoder.hpp"
+
+#if defined(__IMXRT1062__)
+
+// ENC CTRL bits, the interrupt flags are write one to clear and left at 0
+#define ENC_CTRL_SWIP ((uint16_t) (1 << 11)) // Load UINIT and LINIT into the position
+#define ENC_CTRL_REV ((uint16_t) (1 << 10)) // Count up when B leads A
+
+#define ENC_FILT(count, period) ((uint16_t) (((count) << 8) | (period)))
+
+#define XBAR_INOUT_FIRST 4 // XBAR1_INOUT04 has the first direction bit
+#define XBAR_DIR_SHIFT 16 // GPR6 bit of XBAR1_INOUT04, 0 is input
+
+// Pad with the 22k pull up and hysteresis, as INPUT_PULLUP for the GPIO library
+#define QUAD_PAD (IOMUXC_PAD_DSE(3) | IOMUXC_PAD_PKE | IOMUXC_PAD_PUE | IOMUXC_PAD_PUS(3) | IOMUXC_PAD_HYS)
+
+const QuadDecoder::XbarPin QuadDecoder::PINS[] = {
+    {2, 3, 6, nullptr, 0}, // GPIO_EMC_04
+    {3, 3, 7, nullptr, 0}, // GPIO_EMC_05
+    {4, 3, 8, nullptr, 0}, // GPIO_EMC_06
+    {5, 3, 17, &IOMUXC_XBAR1_IN17_SELECT_INPUT, 0}, // GPIO_EMC_08
+    {33, 3, 9, nullptr, 0}, // GPIO_EMC_07
+};
+
+QuadDecoder::QuadDecoder() {}
+
+// PUBLIC
+
+bool QuadDecoder::begin(uint8_t pinA, uint8_t pinB) {
+    const XbarPin *a = xbarPin(pinA);
+    const XbarPin *b = xbarPin(pinB);
+    if (a == nullptr || b == nullptr || a == b) {
+        return false;
+    }
+
+    CCM_CCGR2 |= CCM_CCGR2_XBAR1(CCM_CCGR_ON);
+    CCM_CCGR4 |= CCM_CCGR4_ENC1(CCM_CCGR_ON);
+    route(*a, QUAD_XBAR_PHASE_A);
+    route(*b, QUAD_XBAR_PHASE_B);
+
+    // Plain x4 quadrature count, no index, home or modulo
+    ENC1_CTRL = 0;
+    ENC1_CTRL2 = 0;
+    ENC1_FILT = ENC_FILT(QUAD_FILTER_COUNT, QUAD_FILTER_PERIOD);
+    ENC1_CTRL = ENC_CTRL_REV;
+    this->_ready = true;
+    this->write(0);
+    return true;
+}
+
+long QuadDecoder::read() {
+    if (!_ready) {
+        return 0;
+    }
+
+    // Reading UPOS holds LPOS, so the halves are from the same count
+    uint32_t upper = ENC1_UPOS;
+    return (long) (int32_t) ((upper << 16) | ENC1_LPOSH);
+}
+
+void QuadDecoder::write(long position) {
+    if (!_ready) {
+        return;
+    }
+    ENC1_UINIT = (uint16_t) ((uint32_t) position >> 16);
+    ENC1_LINIT = (uint16_t) position;
+    ENC1_CTRL = ENC_CTRL_REV | ENC_CTRL_SWIP;
+}
+
+// PRIVATE
+
+const QuadDecoder::XbarPin *QuadDecoder::xbarPin(uint8_t pin) {
+    for (const XbarPin &entry : PINS) {
+        if (entry.pin == pin) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void QuadDecoder::route(const XbarPin &pin, uint8_t output) {
+    *portConfigRegister(pin.pin) = pin.alt;
+    *portControlRegister(pin.pin) = QUAD_PAD;
+    if (pin.select != nullptr) {
+        *pin.select = pin.selectValue;
+    }
+    if (pin.input >= XBAR_INOUT_FIRST) {
+        IOMUXC_GPR_GPR6 &= ~(1 << (XBAR_DIR_SHIFT + pin.input - XBAR_INOUT_FIRST));
+    }
+
+    // Two outputs per select register, odd ones in the high byte
+    volatile uint16_t *select = &XBARA1_SEL0 + output / 2;
+    if (output & 1) {
+        *select = (*select & 0x00FF) | (pin.input << 8);
+    } else {
+        *select = (*select & 0xFF00) | pin.input;
+    }
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef QUAD_DECODER_HPP
+#define QUAD_DECODER_HPP
+
+#if defined(__IMXRT1062__)
+
+#include <Arduino.h>
+
+#define QUAD_XBAR_PHASE_A 66 // XBARA1_OUT66, ENC1 phase A input
+#define QUAD_XBAR_PHASE_B 67 // XBARA1_OUT67, ENC1 phase B input
+#define QUAD_FILTER_PERIOD 255 // IPG clocks between filter samples
+#define QUAD_FILTER_COUNT 7 // Consecutive samples + 3 an edge must hold, 17us at 150MHz
+
+/**
+ * Rotary encoder backend on the ENC1 hardware quadrature decoder.
+ *
+ * The encoder pins are routed to ENC1 through XBAR1, so edges are counted and
+ * glitch filtered in hardware with no interrupts, and reading the position is a
+ * register read. Counts 4 per detent with the same sign as the Encoder library,
+ * so either can be used behind the menu.
+ *
+ * Only pins with an XBAR1 input can be used: 2, 3, 4, 5 and 33.
+ */
+class QuadDecoder {
+public:
+    /**
+     * @brief Create a new instance of the quadrature decoder, not counting.
+     */
+    QuadDecoder();
+
+    /**
+     * @brief Routes the pins to ENC1 and starts counting from 0
+     *
+     * @param pinA encoder A pin
+     * @param pinB encoder B pin
+     * @returns false if a pin has no XBAR1 input
+     */
+    bool begin(uint8_t pinA, uint8_t pinB);
+
+    /**
+     * @brief Getter for the position, constant time
+     *
+     * @returns counts, 4 per detent, 0 if begin() failed
+     */
+    long read();
+
+    /**
+     * @brief Sets the position
+     *
+     * @param position new count
+     */
+    void write(long position);
+
+private:
+    struct XbarPin {
+        uint8_t pin;
+        uint8_t alt; // Mux mode of the XBAR1 function
+        uint8_t input; // XBAR1 input
+        volatile uint32_t *select; // Daisy chain register, nullptr if the input has one pad
+        uint8_t selectValue;
+    };
+
+    static const XbarPin *xbarPin(uint8_t pin);
+    static void route(const XbarPin &pin, uint8_t output);
+
+    static const XbarPin PINS[];
+
+    bool _ready = false; // ENC1 is clocked, its registers fault before
+};
+
+#endif
+
+#endif
@@ -0,0 +1,45 @@
+#include "Sections.hpp"
+
+Sections::Sections() {}
+
+// PUBLIC
+
+void Sections::clear() {
+    this->_count = 0;
+}
+
+SolenoidError Sections::add(const Section &section) {
+    if (_count >= MAX_SECTIONS || section.length == 0 || section.turns == 0 || section.gauge > MAX_GAUGE) {
+        return SolenoidError::VALUE_ERROR;
+    }
+    if (section.offset + section.length > MAX_LENGTH || section.turns > MAX_JOB_TURNS - this->totalTurns()) {
+        return SolenoidError::VALUE_ERROR;
+    }
+    // The carriage only moves on between sections, never back over a finished one
+    if (_count > 0) {
+        const Section &last = _sections[_count - 1];
+        if (section.offset < last.offset + last.length) {
+            return SolenoidError::VALUE_ERROR;
+        }
+    }
+
+    this->_sections[_count] = section;
+    this->_count++;
+    return SolenoidError::NO_ERROR;
+}
+
+uint8_t Sections::count() const {
+    return _count;
+}
+
+const Section &Sections::get(uint8_t index) const {
+    return _sections[index];
+}
+
+uint32_t Sections::totalTurns() const {
+    uint32_t turns = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+        turns += _sections[i].turns;
+    }
+    return turns;
+}
@@ -0,0 +1,73 @@
+#ifndef SECTIONS_HPP
+#define SECTIONS_HPP
+
+#include <Arduino.h>
+#include <Solenoid.hpp>
+#include <Machine.hpp>
+
+#define MAX_SECTIONS 4
+
+/**
+ * One coil of a multi-section job.
+ * Lengths are 0.01cm like Solenoid, the offset is from the start of the winding area.
+ */
+struct Section {
+    uint32_t offset;
+    uint32_t length;
+    uint32_t turns;
+    uint8_t gauge;
+};
+
+/**
+ * Several coils wound on one mandrel in a single job, ordered along the carriage.
+ * With no sections the job is the single solenoid.
+ */
+class Sections {
+public:
+    /**
+     * @brief Create a new instance of the section list, empty.
+     */
+    Sections();
+
+    /**
+     * @brief Removes all sections
+     */
+    void clear();
+
+    /**
+     * @brief Appends a section after the last one
+     *
+     * @param section section to add
+     * @returns VALUE_ERROR if the list is full, the section is empty, overlaps the last one,
+     * ends past MAX_LENGTH or takes the job past MAX_JOB_TURNS
+     */
+    SolenoidError add(const Section &section);
+
+    /**
+     * @brief Getter for the number of sections
+     *
+     * @returns sections in the job, 0 for a single solenoid job
+     */
+    uint8_t count() const;
+
+    /**
+     * @brief Getter for a section
+     *
+     * @param index section index, below count()
+     * @returns section
+     */
+    const Section &get(uint8_t index) const;
+
+    /**
+     * @brief Getter for the turns of all sections
+     *
+     * @returns total turns
+     */
+    uint32_t totalTurns() const;
+
+private:
+    Section _sections[MAX_SECTIONS];
+    uint8_t _count = 0;
+};
+
+#endif
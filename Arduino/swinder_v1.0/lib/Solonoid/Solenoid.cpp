@@ -33,6 +33,9 @@ SolenoidError Solenoid::setInductance(uint32_t inductance) {
 }
 
 SolenoidError Solenoid::setGauge(WireGauge gauge) {
+    if (gauge > MAX_GAUGE) {
+        return SolenoidError::VALUE_ERROR;
+    }
     this->_gauge = gauge;
     return SolenoidError::NO_ERROR;
 }
@@ -98,56 +101,30 @@ void Solenoid::setPreset(Preset preset) {
     }
 }
 
-uint32_t Solenoid::turnsPerPass() {
+uint32_t Solenoid::turnsPerPass(const WireTable &wires) {
     if (_length == 0) {
         return 0;
     }
-    // (_length / 10000) / (_gauge / 1000000)
-    return (_length / _gauge) * 100;
+    // (_length / 10000) / (diameter / 1000000)
+    return (_length * 100) / wires.diameter(_gauge);
 }
 
 
 String Solenoid::gaugeString() {
-    switch(_gauge) {
-        case WireGauge::AWG18: return "AWG18";
-        case WireGauge::AWG19: return "AWG19";
-        case WireGauge::AWG20: return "AWG20";
-        case WireGauge::AWG21: return "AWG21";
-        case WireGauge::AWG22: return "AWG22";
-        case WireGauge::AWG23: return "AWG23";
-        case WireGauge::AWG24: return "AWG24";
-        case WireGauge::AWG25: return "AWG25";
-        case WireGauge::AWG26: return "AWG26";
-        case WireGauge::AWG27: return "AWG27";
-        case WireGauge::AWG28: return "AWG28";
-        case WireGauge::AWG29: return "AWG29";
-        case WireGauge::AWG30: return "AWG30";
-        default: return "Error";
-    }
+    return gaugeString(_gauge);
 }
 
-uint32_t Solenoid::gaugeDiameter() {
-    
-    switch (_gauge) { // Diameter, divide by 1000000 to get m; SF 10^-6
-        case WireGauge::AWG18: return 1020; // 1.020mm
-        case WireGauge::AWG19: return 910; // 0.910mm
-        case WireGauge::AWG20: return 810; // 0.810mm
-        case WireGauge::AWG21: return 720; // 0.720mm
-        case WireGauge::AWG22: return 643; // 0.643mm
-        case WireGauge::AWG23: return 574; // 0.574mm
-        case WireGauge::AWG24: return 511; // 0.511mm
-        case WireGauge::AWG25: return 450; // 0.450mm
-        case WireGauge::AWG26: return 404; // 0.404mm
-        case WireGauge::AWG27: return 361; // 0.361mm
-        case WireGauge::AWG28: return 320; // 0.320mm
-        case WireGauge::AWG29: return 290; // 0.290mm
-        case WireGauge::AWG30: return 254; // 0.254mm
-        default: return 0;
-    }
+String Solenoid::gaugeString(WireGauge gauge) {
+    return WireTable::name(gauge);
 }
 
 // PRIVATE
 
 void Solenoid::updateTurns() {
+    // No mandrel yet, nothing to wind
+    if (_radius == 0) {
+        this->_numTurns = 0;
+        return;
+    }
     this->_numTurns = round(sqrt(((_inductance * _length * 100000000) / (_radius * _radius * K))) * UT_SCALING_FACTOR);
 }
\ No newline at end of file
@@ -2,11 +2,11 @@
 #define SOLENOID_HPP
 
 #include <Arduino.h>
+#include <WireTable.hpp>
 
 #define MAX_LENGTH 2000 // 0.2m stored with 0.01cm precision. Divide by 10000
 #define MAX_INDUCTANCE 4000000 // 40H stored with 0.01mH precision. Divide by 100000
 #define MAX_RADIUS 500 // 0.005m stored with 0.01cm precision. Divide by 10000
-#define MAX_GAUGE 12 // Semi arbitrary value representing number of gauge types
 
 #define UT_SCALING_FACTOR 10 // 10^5
 #define K 394784 // K = 4 * pi^2 * 10^-7 = ~394784 * 10^-11 for ~1.76 * 10^12 error
@@ -25,22 +25,6 @@ enum Preset {
     Debug,
 };
 
-enum WireGauge { // Diameter, divide by 1000000 to get m; SF 10^-6
-    AWG18 = 0, // 1.020mm
-    AWG19 = 1, // 0.910mm
-    AWG20 = 2, // 0.810mm
-    AWG21 = 3, // 0.720mm
-    AWG22 = 4, // 0.643mm
-    AWG23 = 5, // 0.574mm
-    AWG24 = 6, // 0.511mm
-    AWG25 = 7, // 0.450mm
-    AWG26 = 8, // 0.404mm
-    AWG27 = 9, // 0.361mm
-    AWG28 = 10, // 0.320mm
-    AWG29 = 11, // 0.290mm
-    AWG30 = 12, // 0.254mm
-};
-
 class Solenoid {
 public:
     /**
@@ -142,18 +126,20 @@ public:
     String gaugeString();
 
     /**
-     * @brief Returns real value of gauge diameter
+     * @brief Provides a string format for any gauge
      * 
-     * @returns diameter with 0.001mm precision
+     * @param gauge gauge to format
+     * @returns String representation of the gauge
      */
-    uint32_t gaugeDiameter();
+    static String gaugeString(WireGauge gauge);
 
     /**
      * @brief Returns the number of turns that can fit in one pass across the solenoid
      * 
+     * @param wires wire table giving the diameter of the gauge
      * @returns number of turns per pass
      */
-    uint32_t turnsPerPass();
+    uint32_t turnsPerPass(const WireTable &wires);
 
 private:
     /**
@@ -0,0 +1,121 @@
+#include "SpeedProfile.hpp"
+
+SpeedProfile::SpeedProfile() {
+    this->_delay[0] = MOTOR_DELAY;
+    this->_percent[0] = 100;
+    this->_reach[0] = 0;
+    this->_climb[0] = 0;
+}
+
+// PUBLIC
+
+void SpeedProfile::begin(const WindKernel &kernel, uint32_t radius) {
+    this->_radius = radius * 100;
+
+    // Height of the layer the kernel is in, it may be under way
+    this->_section = kernel.section();
+    this->_layer = 0;
+    this->_height = 0;
+    const uint32_t diameter = kernel.plan(_section).diameter;
+    for (uint32_t layer = 0; layer < kernel.layer(); layer++) {
+        this->_height += kernel.pattern().layerHeight(layer, diameter);
+    }
+    this->_layer = kernel.layer();
+    this->loadLayer(kernel);
+    this->restart();
+}
+
+void SpeedProfile::restart() {
+    this->_level = 0;
+    this->_held = 0;
+}
+
+FASTRUN uint32_t SpeedProfile::next(const WindKernel &kernel) {
+    if (kernel.section() != _section || kernel.layer() != _layer) {
+        this->loadLayer(kernel);
+    }
+
+    // SS steps since the last reversal and to the next one, the carriage steps every ratio SS steps
+    const uint32_t ratio = kernel.ratio();
+    const uint32_t subSteps = kernel.subStepCount();
+    const int32_t position = kernel.position();
+    const int32_t behind = position - kernel.lastReversal();
+    const int32_t ahead = kernel.forward() ? kernel.bound() - position : position - kernel.bound();
+    const uint32_t since = (uint32_t) (behind < 0 ? -behind : behind) / DISTANCE_PER_STEP * ratio + subSteps;
+    const uint32_t untilSteps = ahead >= 0 ? (uint32_t) (ahead / DISTANCE_PER_STEP + 1) * ratio : 0;
+    uint32_t edge = untilSteps > subSteps ? untilSteps - subSteps : 0;
+    if (since < edge) {
+        edge = since;
+    }
+    const uint32_t left = kernel.totalSteps() - kernel.stepCount();
+    if (left < edge) {
+        edge = left;
+    }
+
+    // Brakes a level at a time as the edge comes closer
+    while (_level > 0 && edge < _reach[_level]) {
+        this->_level--;
+        this->_held = 0;
+    }
+
+    // Climbs once the level below has been held long enough for the acceleration, from the start rate after a pause too
+    this->_held++;
+    if (_level + 1 < _levels && edge >= _reach[_level + 1] && _held >= _climb[_level + 1]) {
+        this->_level++;
+        this->_held = 0;
+    }
+    return _delay[_level];
+}
+
+uint32_t SpeedProfile::layerRate(uint32_t radius) {
+    if (radius == 0) {
+        return SPEED_MAX_RATE;
+    }
+
+    // One revolution pulls a circumference of wire
+    const float rate = (float) SPEED_WIRE_LIMIT * 1000 * SS_STEPS_PER_REVOLUTION / (2 * PI_FLOAT * radius);
+    return rate < SPEED_MAX_RATE ? (uint32_t) rate : SPEED_MAX_RATE;
+}
+
+// PRIVATE
+
+FASTRUN void SpeedProfile::loadLayer(const WindKernel &kernel) {
+    const uint32_t diameter = kernel.plan(kernel.section()).diameter;
+    if (kernel.section() != _section) {
+        // The next section starts on the mandrel
+        this->_height = 0;
+    } else if (kernel.layer() == _layer + 1) {
+        this->_height += kernel.pattern().layerHeight(_layer, diameter);
+    }
+    this->_section = kernel.section();
+    this->_layer = kernel.layer();
+
+    // Wire centre sits half a diameter above the layers below
+    const uint32_t top = SpeedProfile::layerRate(_radius + _height + diameter / 2);
+    const uint32_t slow = top < SPEED_START_RATE ? top : SPEED_START_RATE;
+
+    // v^2 = slow^2 + 2 * a * d, each level as far from the edge as it needs to brake to the slow rate
+    uint32_t rate = slow;
+    uint8_t level = 0;
+    while (true) {
+        this->_delay[level] = (500000 + rate / 2) / rate;
+        this->_percent[level] = (MOTOR_DELAY * 100) / _delay[level];
+        if (level == 0) {
+            this->_reach[level] = 0;
+            this->_climb[level] = 0;
+        } else {
+            const uint32_t below = rate < slow + SPEED_RATE_STEP ? slow : rate - SPEED_RATE_STEP;
+            this->_reach[level] = SPEED_REVERSAL_STEPS + (rate * rate - slow * slow + 2 * SPEED_ACCEL - 1) / (2 * SPEED_ACCEL);
+            this->_climb[level] = (rate * rate - below * below + 2 * SPEED_ACCEL - 1) / (2 * SPEED_ACCEL);
+        }
+        level++;
+        if (rate >= top || level == SPEED_LEVELS) {
+            break;
+        }
+        rate = rate + SPEED_RATE_STEP < top ? rate + SPEED_RATE_STEP : top;
+    }
+    this->_levels = level;
+    if (_level >= _levels) {
+        this->_level = _levels - 1;
+    }
+}
@@ -0,0 +1,101 @@
+#ifndef SPEED_PROFILE_HPP
+#define SPEED_PROFILE_HPP
+
+#include <Arduino.h>
+#include <WindKernel.hpp>
+#include <Machine.hpp>
+
+#define SPEED_START_RATE (500000 / MOTOR_DELAY) // SS steps/s, the fixed rate, from rest and at reversals
+#define SPEED_MAX_RATE 800 // SS steps/s, under the 846 the spindle takes without a ramp (ramp --sweep), so a pause stops it safely
+#define SPEED_ACCEL 2000 // SS steps/s2
+#define SPEED_WIRE_LIMIT 500 // mm/s, fastest the wire is pulled onto the coil
+#define SPEED_REVERSAL_STEPS (2 * SS_STEPS_PER_REVOLUTION) // SS steps at the start rate either side of a reversal
+#define SPEED_RATE_STEP 25 // SS steps/s between the levels of the ramp
+#define SPEED_LEVELS 16 // Most levels of a layer, covers the start rate to SPEED_MAX_RATE
+#define PI_FLOAT 3.14159265f
+
+/**
+ * SS step rate scheduled by carriage position and winding radius, for the kernel it follows.
+ *
+ * Each layer has a top rate, SPEED_MAX_RATE or the rate that pulls the wire at
+ * SPEED_WIRE_LIMIT at the radius of the layer, whichever is lower, so outer layers and
+ * large mandrels run slower. The turns against a reversal, at a flange or the end of the
+ * job, are wound at the start rate or the layer rate if that is lower. Between them the
+ * rate ramps at SPEED_ACCEL, braking in time for the next reversal.
+ *
+ * The ramp climbs and brakes through levels SPEED_RATE_STEP apart. Their half periods
+ * and the distances from the edge they need are worked out once per layer, so a step
+ * only compares step counts against the table.
+ */
+class SpeedProfile {
+public:
+    /**
+     * @brief Create a new instance of the speed profile, at the start rate.
+     */
+    SpeedProfile();
+
+    /**
+     * @brief Finds the layer the kernel is in, call once the kernel is planned or restored
+     *
+     * @param kernel kernel winding the job
+     * @param radius mandrel radius, 0.01cm
+     */
+    void begin(const WindKernel &kernel, uint32_t radius);
+
+    /**
+     * @brief Drops to the start rate, call when the spindle starts from rest after a pause
+     */
+    void restart();
+
+    /**
+     * @brief Rate of the SS step the kernel just planned, call once per SS step
+     *
+     * @param kernel kernel winding the job
+     * @returns half period of the step, us
+     */
+    uint32_t next(const WindKernel &kernel);
+
+    /**
+     * @brief Getter for the rate of the last step against the fixed rate, from the table
+     *
+     * @returns percent of the rate at MOTOR_DELAY
+     */
+    inline uint16_t percent() const {
+        return _percent[_level];
+    }
+
+    /**
+     * @brief Top rate of a layer
+     *
+     * @param radius winding radius at the wire centre, um
+     * @returns SS steps/s
+     */
+    static uint32_t layerRate(uint32_t radius);
+
+private:
+    /**
+     * @brief Builds the levels of the layer the kernel moved onto
+     *
+     * @param kernel kernel winding the job
+     */
+    void loadLayer(const WindKernel &kernel);
+
+    uint32_t _radius = 0; // um
+
+    // Current layer
+    uint8_t _section = 0;
+    uint32_t _layer = 0;
+    uint32_t _height = 0; // um
+
+    // Levels of the current layer, the slow rate first and the top rate last
+    uint8_t _levels = 1;
+    uint16_t _delay[SPEED_LEVELS]; // us, half period of the step
+    uint16_t _percent[SPEED_LEVELS]; // Rate against MOTOR_DELAY, for the trace
+    uint32_t _reach[SPEED_LEVELS]; // SS steps to the edge the level brakes back from in time
+    uint32_t _climb[SPEED_LEVELS]; // SS steps at the level below before the level is reached
+
+    uint8_t _level = 0; // Level of the last step
+    uint32_t _held = 0; // SS steps at that level
+};
+
+#endif
@@ -0,0 +1,29 @@
+#include "FileTraceSink.hpp"
+
+#if !defined(ARDUINO)
+
+FileTraceSink::FileTraceSink(const char *path) : _path(path) {}
+
+// PUBLIC
+
+bool FileTraceSink::open() {
+    this->_file = fopen(_path, "wb");
+    return _file != nullptr;
+}
+
+bool FileTraceSink::ready() {
+    return true;
+}
+
+bool FileTraceSink::write(const uint8_t *block) {
+    return fwrite(block, 1, TRACE_BLOCK_SIZE, _file) == TRACE_BLOCK_SIZE;
+}
+
+void FileTraceSink::close() {
+    if (_file != nullptr) {
+        fclose(_file);
+        this->_file = nullptr;
+    }
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef FILE_TRACE_SINK_HPP
+#define FILE_TRACE_SINK_HPP
+
+#if !defined(ARDUINO)
+
+#include <stdio.h>
+#include "StepTrace.hpp"
+
+/**
+ * Writes traces to a plain file, for host simulation builds
+ */
+class FileTraceSink : public TraceSink {
+public:
+    /**
+     * @brief Create a new instance of the file trace sink.
+     *
+     * @param path file to write, replaced on every open()
+     */
+    FileTraceSink(const char *path);
+
+    bool open() override;
+    bool ready() override;
+    bool write(const uint8_t *block) override;
+    void close() override;
+
+private:
+    const char *_path;
+    FILE *_file = nullptr;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,64 @@
+#include "SdTraceSink.hpp"
+
+#if defined(ARDUINO_TEENSY41)
+
+SdTraceSink::SdTraceSink() {}
+
+// PUBLIC
+
+bool SdTraceSink::open() {
+    // Mounting, the name search and the preallocation can each take a while on a slow card
+    this->wait();
+    if (!_mounted) {
+        this->_mounted = _sd.begin(SdioConfig(FIFO_SDIO));
+        this->wait();
+        if (!_mounted) {
+            return false;
+        }
+    }
+
+    // First unused name
+    uint16_t index = 0;
+    for (; index < SD_TRACE_MAX_FILES; index++) {
+        snprintf(_name, sizeof(_name), "TRACE%03u.BIN", (unsigned) index);
+        if (!_sd.exists(_name)) {
+            break;
+        }
+        this->wait();
+    }
+    if (index == SD_TRACE_MAX_FILES) {
+        return false;
+    }
+
+    if (!_file.open(&_sd, _name, O_RDWR | O_CREAT | O_TRUNC)) {
+        return false;
+    }
+    this->wait();
+    if (!_file.preAllocate(SD_TRACE_PREALLOCATE)) {
+        _file.close();
+        _sd.remove(_name);
+        return false;
+    }
+    this->wait();
+    return true;
+}
+
+bool SdTraceSink::ready() {
+    return !_file.isBusy();
+}
+
+bool SdTraceSink::write(const uint8_t *block) {
+    return _file.write(block, TRACE_BLOCK_SIZE) == TRACE_BLOCK_SIZE;
+}
+
+void SdTraceSink::close() {
+    // Trim the preallocation to what was written
+    _file.truncate();
+    _file.close();
+}
+
+String SdTraceSink::fileName() {
+    return String(_name);
+}
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef SD_TRACE_SINK_HPP
+#define SD_TRACE_SINK_HPP
+
+#if defined(ARDUINO_TEENSY41)
+
+#include <Arduino.h>
+#include <SdFat.h>
+#include "StepTrace.hpp"
+
+#define SD_TRACE_PREALLOCATE (64UL * 1024 * 1024) // Contiguous space reserved per trace, ~5 hours at 625 steps/s
+#define SD_TRACE_MAX_FILES 1000
+
+/**
+ * Writes traces to the built-in SD card of the Teensy 4.1 as TRACEnnn.BIN
+ *
+ * The file is preallocated contiguously so a block write never waits on cluster
+ * allocation, and writes only happen when the card reports it is not busy.
+ */
+class SdTraceSink : public TraceSink {
+public:
+    /**
+     * @brief Create a new instance of the SD trace sink.
+     */
+    SdTraceSink();
+
+    bool open() override;
+    bool ready() override;
+    bool write(const uint8_t *block) override;
+    void close() override;
+
+    /**
+     * @brief Getter for the name of the last opened trace
+     *
+     * @returns file name
+     */
+    String fileName();
+
+private:
+    SdFs _sd;
+    FsFile _file;
+    bool _mounted = false;
+    char _name[16];
+};
+
+#endif
+
+#endif
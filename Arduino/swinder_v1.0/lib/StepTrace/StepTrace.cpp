@@ -0,0 +1,249 @@
+#include "StepTrace.hpp"
+#include <string.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+// The decoder also builds into host tools without an Arduino core, placement has no meaning there
+#define FASTRUN
+#define DMAMEM
+#endif
+
+DMAMEM uint8_t StepTrace::_blocks[2][TRACE_BLOCK_SIZE] __attribute__((aligned(32)));
+
+StepTrace::StepTrace() {}
+
+// PUBLIC
+
+void StepTrace::begin(TraceSink &sink) {
+    this->_sink = &sink;
+}
+
+bool StepTrace::start(uint32_t time) {
+    if (_sink == nullptr || !_sink->open()) {
+        this->_recording = false;
+        return false;
+    }
+
+    this->_active = 0;
+    this->_sealed[0] = false;
+    this->_sealed[1] = false;
+    this->_sequence = 0;
+    this->_dropped = 0;
+    this->_pendingDropped = 0;
+    this->openBlock(time);
+    this->_recording = true;
+    return true;
+}
+
+void StepTrace::stop() {
+    if (!_recording) {
+        return;
+    }
+    this->_recording = false;
+
+    // Older block first
+    uint8_t other = _active ^ 1;
+    if (_sealed[other]) {
+        while (!_sink->ready()) {
+            _sink->wait();
+        }
+        _sink->write(_blocks[other]);
+        this->_sealed[other] = false;
+    }
+    if (_fill > sizeof(TraceBlockHeader)) {
+        this->seal();
+        while (!_sink->ready()) {
+            _sink->wait();
+        }
+        _sink->write(_blocks[_active]);
+        this->_sealed[_active] = false;
+    }
+    _sink->wait();
+    _sink->close();
+    _sink->wait();
+}
+
+FASTRUN void StepTrace::direction(bool forward, int32_t position, uint32_t time) {
+    if (!_recording || !this->reserve(time)) {
+        return;
+    }
+    this->put((TraceEventType::TRACE_DIR << 4) | (forward ? 1 : 0));
+    this->putVarint(time - _lastTime);
+    // Zigzag so small negative positions stay short
+    this->putVarint(((uint32_t) position << 1) ^ (uint32_t) (position >> 31));
+    this->_lastTime = time;
+}
+
+FASTRUN void StepTrace::speedOverride(uint16_t percent, uint32_t time) {
+    if (!_recording || !this->reserve(time)) {
+        return;
+    }
+    this->put(TraceEventType::TRACE_OVERRIDE << 4);
+    this->putVarint(time - _lastTime);
+    this->putVarint(percent);
+    this->_lastTime = time;
+}
+
+FASTRUN void StepTrace::mark(TraceMark mark, uint32_t time) {
+    if (!_recording || !this->reserve(time)) {
+        return;
+    }
+    this->put((TraceEventType::TRACE_MARK << 4) | mark);
+    this->putVarint(time - _lastTime);
+    this->_lastTime = time;
+}
+
+void StepTrace::meta(TraceMeta key, uint32_t value, uint32_t time) {
+    if (!_recording || !this->reserve(time)) {
+        return;
+    }
+    this->put((TraceEventType::TRACE_META << 4) | key);
+    this->putVarint(time - _lastTime);
+    this->putVarint(value);
+    this->_lastTime = time;
+}
+
+FASTRUN void StepTrace::service() {
+    uint8_t other = _active ^ 1;
+    if (!_sealed[other] || !_sink->ready()) {
+        return;
+    }
+    _sink->write(_blocks[other]);
+    this->_sealed[other] = false;
+}
+
+uint32_t StepTrace::dropped() const {
+    return _dropped;
+}
+
+// PRIVATE
+
+FASTRUN bool StepTrace::rotate(uint32_t time) {
+    uint8_t other = _active ^ 1;
+    if (_sealed[other]) {
+        // Sink has not caught up, drop instead of waiting
+        this->_dropped++;
+        this->_pendingDropped++;
+        return false;
+    }
+
+    this->seal();
+    this->_active = other;
+    this->openBlock(time);
+    return true;
+}
+
+FASTRUN void StepTrace::seal() {
+    TraceBlockHeader header;
+    header.magic = TRACE_MAGIC;
+    header.sequence = _sequence++;
+    header.baseTime = _baseTime;
+    header.used = _fill - sizeof(TraceBlockHeader);
+    header.dropped = _activeDropped;
+
+    memcpy(_blocks[_active], &header, sizeof(header));
+    memset(_blocks[_active] + _fill, 0, TRACE_BLOCK_SIZE - _fill);
+    this->_sealed[_active] = true;
+}
+
+FASTRUN void StepTrace::openBlock(uint32_t time) {
+    this->_fill = sizeof(TraceBlockHeader);
+    this->_baseTime = time;
+    this->_lastTime = time;
+    this->_activeDropped = _pendingDropped > 0xFFFF ? 0xFFFF : _pendingDropped;
+    this->_pendingDropped = 0;
+}
+
+// READER
+
+StepTraceReader::StepTraceReader() {}
+
+bool StepTraceReader::load(const uint8_t *block) {
+    TraceBlockHeader header;
+    memcpy(&header, block, sizeof(header));
+    if (header.magic != TRACE_MAGIC || header.used > TRACE_BLOCK_SIZE - sizeof(header)) {
+        return false;
+    }
+
+    memcpy(this->_block, block, TRACE_BLOCK_SIZE);
+    this->_used = sizeof(header) + header.used;
+    this->_pos = sizeof(header);
+    this->_dropped += header.dropped;
+
+    if (_started) {
+        this->_missing += header.sequence - _sequence - 1;
+        // Extend the 32 bit clock, blocks are never more than one wrap apart
+        this->_time += (uint32_t) (header.baseTime - _lastTime32);
+    } else {
+        this->_time = header.baseTime;
+        this->_started = true;
+    }
+    this->_sequence = header.sequence;
+    this->_lastTime32 = header.baseTime;
+    return true;
+}
+
+bool StepTraceReader::next(TraceEvent &event) {
+    if (_pos >= _used) {
+        return false;
+    }
+
+    uint8_t header = _block[_pos++];
+    uint32_t delta;
+    if (!this->getVarint(delta)) {
+        return false;
+    }
+    this->_time += delta;
+    this->_lastTime32 += delta;
+
+    event.time = _time;
+    event.type = header >> 4;
+    event.flags = header & 0x0F;
+    event.value = 0;
+
+    uint32_t payload;
+    switch (event.type) {
+        case TraceEventType::TRACE_DIR:
+            if (!this->getVarint(payload)) {
+                return false;
+            }
+            event.value = (int32_t) ((payload >> 1) ^ (~(payload & 1) + 1));
+            break;
+        case TraceEventType::TRACE_OVERRIDE:
+        case TraceEventType::TRACE_META:
+            if (!this->getVarint(payload)) {
+                return false;
+            }
+            event.value = (int32_t) payload;
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+uint32_t StepTraceReader::dropped() const {
+    return _dropped;
+}
+
+uint32_t StepTraceReader::missingBlocks() const {
+    return _missing;
+}
+
+// PRIVATE
+
+bool StepTraceReader::getVarint(uint32_t &value) {
+    value = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        if (_pos >= _used) {
+            return false;
+        }
+        uint8_t byte = _block[_pos++];
+        value |= (uint32_t) (byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
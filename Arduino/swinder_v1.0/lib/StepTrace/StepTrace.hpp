@@ -0,0 +1,320 @@
+#ifndef STEP_TRACE_HPP
+#define STEP_TRACE_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+Step trace format
+The file is a sequence of TRACE_BLOCK_SIZE blocks, each one self contained so a
+dropped or torn block only loses its own events.
+
+Block: TraceBlockHeader, then `used` bytes of events, zero padded
+Event: header byte (type << 4 | flags), varint time delta in us, optional payload
+  STEP      flags = motor mask (TRACE_SS | TRACE_CC)
+  DIR       flags = 1 if forward, payload = zigzag varint carriage position
+  OVERRIDE  payload = varint speed override in percent
+  MARK      flags = TraceMark
+  META      flags = TraceMeta, payload = varint value
+The first event of a block is relative to the block base time, every other event
+is relative to the event before it.
+*/
+
+#define TRACE_BLOCK_SIZE 512 // One SD sector
+#define TRACE_MAGIC 0x43525453 // "STRC"
+#define TRACE_MAX_EVENT 11 // Header + 2 varints
+
+#define TRACE_SS 0x01
+#define TRACE_CC 0x02
+
+enum TraceEventType {
+    TRACE_STEP = 1,
+    TRACE_DIR = 2,
+    TRACE_OVERRIDE = 3,
+    TRACE_MARK = 4,
+    TRACE_META = 5,
+};
+
+enum TraceMark {
+    MARK_JOB_START = 0,
+    MARK_JOB_END = 1,
+    MARK_PAUSE = 2,
+    MARK_RESUME = 3,
+    MARK_FAULT = 4,
+};
+
+enum TraceMeta {
+    META_LENGTH = 0,
+    META_RADIUS = 1,
+    META_INDUCTANCE = 2,
+    META_GAUGE = 3,
+    META_TURNS = 4,
+    META_STEP_COUNT = 5, // SS steps already wound when the trace started
+};
+
+struct TraceBlockHeader {
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t baseTime; // us, same clock as the event times
+    uint16_t used;
+    uint16_t dropped; // Events lost before this block because both buffers were full
+};
+
+/**
+ * Destination for sealed trace blocks
+ */
+class TraceSink {
+public:
+    virtual ~TraceSink() {}
+
+    /**
+     * @brief Opens a new trace
+     *
+     * @returns false if the medium is not available
+     */
+    virtual bool open() = 0;
+
+    /**
+     * @brief Checks if a block can be written without waiting
+     *
+     * @returns true if write() would return immediately
+     */
+    virtual bool ready() = 0;
+
+    /**
+     * @brief Writes one TRACE_BLOCK_SIZE block
+     *
+     * @returns false on a write error
+     */
+    virtual bool write(const uint8_t *block) = 0;
+
+    /**
+     * @brief Finishes the trace, may block
+     */
+    virtual void close() = 0;
+
+    /**
+     * @brief Sets the function called while the medium keeps the sink or the recorder waiting
+     *
+     * @param wait called between the slow steps, e.g. to feed a watchdog, nullptr for none
+     */
+    inline void setWait(void (*wait)()) {
+        this->_wait = wait;
+    }
+
+    /**
+     * @brief Calls the wait function if one is set
+     */
+    inline void wait() {
+        if (_wait != nullptr) {
+            _wait();
+        }
+    }
+
+protected:
+    void (*_wait)() = nullptr;
+};
+
+class StepTrace {
+public:
+    /**
+     * @brief Create a new instance of the step trace recorder.
+     */
+    StepTrace();
+
+    /**
+     * @brief Sets the sink sealed blocks are written to
+     *
+     * @param sink trace destination
+     */
+    void begin(TraceSink &sink);
+
+    /**
+     * @brief Opens the sink and starts recording
+     *
+     * @param time current time in us
+     * @returns false if the sink could not be opened, nothing is recorded then
+     */
+    bool start(uint32_t time);
+
+    /**
+     * @brief Flushes the partial block and closes the sink
+     *
+     * Blocks until everything is written, do not call from the step loop
+     */
+    void stop();
+
+    /**
+     * @brief Checks if a trace is being recorded
+     *
+     * @returns true between a successful start() and stop()
+     */
+    inline bool recording() const {
+        return _recording;
+    }
+
+    /**
+     * @brief Records a step pulse
+     *
+     * @param motors TRACE_SS and/or TRACE_CC
+     * @param time time of the rising edge in us
+     */
+    inline void step(uint8_t motors, uint32_t time) {
+        if (!_recording || !this->reserve(time)) {
+            return;
+        }
+        this->put((TraceEventType::TRACE_STEP << 4) | motors);
+        this->putVarint(time - _lastTime);
+        this->_lastTime = time;
+    }
+
+    /**
+     * @brief Records a carriage direction change
+     *
+     * @param forward new direction
+     * @param position carriage position at the change, 0.001cm
+     * @param time time of the change in us
+     */
+    void direction(bool forward, int32_t position, uint32_t time);
+
+    /**
+     * @brief Records a speed override change
+     *
+     * @param percent new override, 100 is nominal speed
+     * @param time time of the change in us
+     */
+    void speedOverride(uint16_t percent, uint32_t time);
+
+    /**
+     * @brief Records a job event
+     *
+     * @param mark event to record
+     * @param time time of the event in us
+     */
+    void mark(TraceMark mark, uint32_t time);
+
+    /**
+     * @brief Records a job parameter
+     *
+     * @param key parameter
+     * @param value parameter value in its usual fixed point unit
+     * @param time current time in us
+     */
+    void meta(TraceMeta key, uint32_t value, uint32_t time);
+
+    /**
+     * @brief Writes a sealed block if the sink is ready
+     *
+     * Never waits for the sink, call whenever the step loop has idle time
+     */
+    void service();
+
+    /**
+     * @brief Getter for the number of events lost in this trace
+     *
+     * @returns number of dropped events
+     */
+    uint32_t dropped() const;
+
+private:
+    inline bool reserve(uint32_t time) {
+        if (_fill + TRACE_MAX_EVENT <= TRACE_BLOCK_SIZE) {
+            return true;
+        }
+        return this->rotate(time);
+    }
+
+    bool rotate(uint32_t time);
+    void seal();
+    void openBlock(uint32_t time);
+
+    inline void put(uint8_t value) {
+        _blocks[_active][_fill++] = value;
+    }
+
+    inline void putVarint(uint32_t value) {
+        while (value >= 0x80) {
+            this->put((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        this->put(value);
+    }
+
+    // Sector sized and cache line aligned so DMA writes need no bounce buffer, in DMAMEM to keep DTCM for the stack
+    static uint8_t _blocks[2][TRACE_BLOCK_SIZE] __attribute__((aligned(32)));
+
+    TraceSink *_sink = nullptr;
+    bool _recording = false;
+    uint8_t _active = 0;
+    bool _sealed[2] = {false, false};
+    uint16_t _fill = 0;
+    uint32_t _baseTime = 0;
+    uint32_t _lastTime = 0;
+    uint32_t _sequence = 0;
+    uint32_t _dropped = 0;
+    uint16_t _activeDropped = 0; // Dropped count stored in the header of the active block
+    uint32_t _pendingDropped = 0; // Dropped since the active block was opened
+};
+
+/**
+ * A decoded trace event, times are extended to 64 bits
+ */
+struct TraceEvent {
+    uint64_t time;
+    uint8_t type;
+    uint8_t flags;
+    int32_t value;
+};
+
+class StepTraceReader {
+public:
+    /**
+     * @brief Create a new instance of the step trace decoder.
+     */
+    StepTraceReader();
+
+    /**
+     * @brief Loads the next block of a trace
+     *
+     * @param block TRACE_BLOCK_SIZE bytes
+     * @returns false if the block is not a trace block
+     */
+    bool load(const uint8_t *block);
+
+    /**
+     * @brief Decodes the next event of the loaded block
+     *
+     * @param event event to decode into
+     * @returns false once the block is exhausted
+     */
+    bool next(TraceEvent &event);
+
+    /**
+     * @brief Getter for the number of events lost in the blocks loaded so far
+     *
+     * @returns number of dropped events
+     */
+    uint32_t dropped() const;
+
+    /**
+     * @brief Getter for the number of blocks missing from the sequence so far
+     *
+     * @returns number of lost blocks
+     */
+    uint32_t missingBlocks() const;
+
+private:
+    bool getVarint(uint32_t &value);
+
+    uint8_t _block[TRACE_BLOCK_SIZE];
+    uint16_t _used = 0;
+    uint16_t _pos = 0;
+    bool _started = false;
+    uint32_t _sequence = 0;
+    uint32_t _lastTime32 = 0;
+    uint64_t _time = 0;
+    uint32_t _dropped = 0;
+    uint32_t _missing = 0;
+};
+
+#endif
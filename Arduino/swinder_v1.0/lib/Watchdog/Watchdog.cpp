@@ -0,0 +1,46 @@
+#include "Watchdog.hpp"
+
+void (*Watchdog::_warning)() = nullptr;
+
+Watchdog::Watchdog() {}
+
+// PUBLIC
+
+void Watchdog::begin(void (*warning)()) {
+    _warning = warning;
+
+    #if defined(__IMXRT1062__)
+        CCM_CCGR3 |= CCM_CCGR3_WDOG1(CCM_CCGR_ON);
+
+        // Power down counter would reset the chip 16s after boot on its own
+        WDOG1_WMCR = 0;
+
+        // Warning interrupt, cleared by writing the status bit
+        WDOG1_WICR = WDOG_WICR_WIE | WDOG_WICR_WTIS | WDOG_WICR_WICT(WATCHDOG_WARNING * 2);
+        attachInterruptVector(IRQ_WDOG1, isr);
+        NVIC_ENABLE_IRQ(IRQ_WDOG1);
+
+        // Timeout is (WT + 1) * 0.5s, SRS and WDA high so only the timeout resets
+        WDOG1_WCR = WDOG_WCR_WT(WATCHDOG_TIMEOUT * 2 - 1) | WDOG_WCR_SRS | WDOG_WCR_WDA | WDOG_WCR_WDE;
+        this->feed();
+    #endif
+}
+
+bool Watchdog::causedReset() {
+    #if defined(__IMXRT1062__)
+        return (WDOG1_WRSR & WDOG_WRSR_TOUT) != 0;
+    #else
+        return false;
+    #endif
+}
+
+// PRIVATE
+
+FASTRUN void Watchdog::isr() {
+    #if defined(__IMXRT1062__)
+        WDOG1_WICR |= WDOG_WICR_WTIS;
+    #endif
+    if (_warning != nullptr) {
+        _warning();
+    }
+}
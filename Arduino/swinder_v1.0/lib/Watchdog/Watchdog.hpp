@@ -0,0 +1,55 @@
+#ifndef WATCHDOG_HPP
+#define WATCHDOG_HPP
+
+#include <Arduino.h>
+
+#define WATCHDOG_TIMEOUT 4 // s without a feed before the reset, 0.5s steps
+#define WATCHDOG_WARNING 1 // s before the reset the warning runs, 0.5s steps
+
+/**
+ * Hardware watchdog on WDOG1 of the i.MX RT1062.
+ *
+ * Once started it cannot be stopped, every loop that can run for seconds must feed it.
+ * A warning interrupt runs shortly before the reset so the machine can be left safe,
+ * it does not run if the hang has interrupts disabled. Does nothing on the host.
+ */
+class Watchdog {
+public:
+    /**
+     * @brief Create a new instance of the watchdog, not running.
+     */
+    Watchdog();
+
+    /**
+     * @brief Starts the watchdog
+     *
+     * Only one watchdog can be started as the interrupt handler is static.
+     *
+     * @param warning called from the warning interrupt, keep it short and safe to run anywhere
+     */
+    void begin(void (*warning)());
+
+    /**
+     * @brief Restarts the timeout, constant time
+     */
+    inline void feed() {
+        #if defined(__IMXRT1062__)
+            WDOG1_WSR = 0x5555;
+            WDOG1_WSR = 0xAAAA;
+        #endif
+    }
+
+    /**
+     * @brief Checks the reset status, call once at startup
+     *
+     * @returns true if the last reset was a watchdog timeout
+     */
+    static bool causedReset();
+
+private:
+    static void isr();
+
+    static void (*_warning)();
+};
+
+#endif
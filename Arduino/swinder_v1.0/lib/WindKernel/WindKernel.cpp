@@ -0,0 +1,232 @@
+#include "WindKernel.hpp"
+
+WindKernel::WindKernel() {}
+
+// PUBLIC
+
+void WindKernel::begin(Solenoid &solenoid) {
+    this->begin(solenoid, WindPattern(), WireTable());
+}
+
+void WindKernel::begin(Solenoid &solenoid, const WindPattern &pattern, const WireTable &wires) {
+    this->_pattern = pattern;
+    this->_sectionCount = 0;
+    this->_totalSteps = 0;
+    this->planSection(0, solenoid.getLength(), solenoid.getTurns(), wires.diameter(solenoid.getGauge()));
+
+    this->restore(0, 0, 0, true, 0);
+}
+
+void WindKernel::begin(const Sections &sections, const WindPattern &pattern, const WireTable &wires) {
+    this->_pattern = pattern;
+    this->_sectionCount = 0;
+    this->_totalSteps = 0;
+    for (uint8_t i = 0; i < sections.count(); i++) {
+        const Section &section = sections.get(i);
+        this->planSection(section.offset, section.length, section.turns, wires.diameter(static_cast<WireGauge>(section.gauge)));
+    }
+    if (_sectionCount == 0) {
+        // Nothing to wind
+        this->planSection(0, 0, 0, wires.diameter(WireGauge::AWG24));
+    }
+
+    this->restore(0, 0, 0, true, 0);
+}
+
+void WindKernel::restore(uint32_t stepCount, uint32_t subStepCount, int32_t position, bool forward, uint32_t layer) {
+    // Section the step count falls in, a step count at the end of one is the start of the next
+    uint8_t section = 0;
+    while (section + 1 < _sectionCount && stepCount >= _plans[section].endStep) {
+        section++;
+    }
+    this->loadSection(section);
+
+    this->_stepCount = stepCount;
+    this->_subStepCount = subStepCount;
+    this->_position = position;
+    this->_forward = forward;
+    this->_reversal = position;
+    this->_layer = layer;
+    this->loadLayer();
+
+    // Only a section that has not started yet still needs the carriage moved
+    const uint32_t sectionStart = section > 0 ? _plans[section - 1].endStep : 0;
+    this->_traversing = stepCount == sectionStart;
+    this->updatePercent();
+}
+
+FASTRUN uint32_t WindKernel::stepCount() const {
+    return _stepCount;
+}
+
+FASTRUN uint32_t WindKernel::subStepCount() const {
+    return _subStepCount;
+}
+
+FASTRUN uint32_t WindKernel::totalSteps() const {
+    return _totalSteps;
+}
+
+FASTRUN int32_t WindKernel::position() const {
+    return _position;
+}
+
+FASTRUN bool WindKernel::forward() const {
+    return _forward;
+}
+
+FASTRUN int32_t WindKernel::lastReversal() const {
+    return _reversal;
+}
+
+FASTRUN int32_t WindKernel::bound() const {
+    return _forward ? _upperBound : _lowerBound;
+}
+
+int32_t WindKernel::mirrorEnd() const {
+    int32_t lowest = _plans[0].start + PADDING;
+    int32_t highest = _plans[0].span;
+    for (uint8_t i = 1; i < _sectionCount; i++) {
+        if (_plans[i].start + PADDING < lowest) {
+            lowest = _plans[i].start + PADDING;
+        }
+        if (_plans[i].span > highest) {
+            highest = _plans[i].span;
+        }
+    }
+    return lowest + highest;
+}
+
+FASTRUN uint32_t WindKernel::ratio() const {
+    return _ratio;
+}
+
+FASTRUN uint32_t WindKernel::layer() const {
+    return _layer;
+}
+
+FASTRUN uint8_t WindKernel::section() const {
+    return _section;
+}
+
+uint8_t WindKernel::sectionCount() const {
+    return _sectionCount;
+}
+
+const SectionPlan &WindKernel::plan(uint8_t index) const {
+    return _plans[index];
+}
+
+const WindPattern &WindKernel::pattern() const {
+    return _pattern;
+}
+
+uint32_t WindKernel::layerSteps(uint8_t index, uint32_t layer) const {
+    const SectionPlan &plan = _plans[index];
+    const int32_t shift = this->layerShift(plan, layer);
+    const int32_t travel = (plan.span - shift) - (plan.start + PADDING + shift);
+
+    // The carriage reverses one step past the bound
+    const uint32_t ccSteps = travel > 0 ? travel / DISTANCE_PER_STEP + 1 : 1;
+    return ccSteps * this->layerRatio(plan, layer);
+}
+
+// PRIVATE
+
+void WindKernel::planSection(uint32_t offset, uint32_t length, uint32_t turns, uint32_t diameter) {
+    if (_sectionCount >= MAX_SECTIONS) {
+        return;
+    }
+    SectionPlan &plan = this->_plans[_sectionCount];
+    plan.diameter = diameter;
+
+    // Calculate necessary values
+    const uint32_t CC_DISTANCE_PER_REVOLUTION = (plan.diameter * 100) / DISTANCE_PER_STEP;
+
+    this->_totalSteps += turns * SS_STEPS_PER_REVOLUTION;
+    plan.endStep = _totalSteps;
+    plan.start = (int32_t(offset) * 10 / DISTANCE_PER_STEP) * DISTANCE_PER_STEP;
+    plan.span = plan.start + int32_t(length) * 10 + PADDING;
+    plan.wireRatio = (CC_STEPS_PER_REVOLUTION * 1000) / CC_DISTANCE_PER_REVOLUTION;
+    plan.halfPitch = plan.wireRatio > 0 ? (SS_STEPS_PER_REVOLUTION * DISTANCE_PER_STEP) / (2 * plan.wireRatio) : 0;
+    this->_sectionCount++;
+}
+
+FASTRUN void WindKernel::loadSection(uint8_t index) {
+    this->_section = index;
+    this->_start = _plans[index].start;
+    this->_sectionEnd = _plans[index].endStep;
+    this->_traversing = true;
+}
+
+FASTRUN void WindKernel::nextSection() {
+    if (_section + 1 >= _sectionCount) {
+        return;
+    }
+    this->loadSection(_section + 1);
+    this->_layer = 0;
+    this->_subStepCount = 0;
+    this->loadLayer();
+}
+
+FASTRUN void WindKernel::stepEvent() {
+    if (_stepCount == _sectionEnd) {
+        this->nextSection();
+    }
+    this->updatePercent();
+}
+
+FASTRUN void WindKernel::updatePercent() {
+    if (_totalSteps == 0) {
+        this->_percent = 0;
+        this->_nextPercent = 0;
+    } else {
+        // 64 bit so long jobs do not overflow, only runs once per percent
+        this->_percent = ((uint64_t) _stepCount * 100) / _totalSteps;
+        // First step count of the next percent, 0 never matches once done
+        this->_nextPercent = _percent < 100 ? ((uint64_t) (_percent + 1) * _totalSteps + 99) / 100 : 0;
+    }
+    this->_nextEvent = (_nextPercent != 0 && _nextPercent < _sectionEnd) ? _nextPercent : _sectionEnd;
+}
+
+FASTRUN uint8_t WindKernel::traverse() {
+    uint8_t mask = STEP_CC;
+    const bool forward = _start > _position;
+    if (forward != _forward) {
+        this->_forward = forward;
+        this->_reversal = _position;
+        mask |= STEP_REVERSED;
+    }
+    this->_position += forward ? DISTANCE_PER_STEP : -DISTANCE_PER_STEP;
+    return mask;
+}
+
+FASTRUN uint8_t WindKernel::arrive() {
+    this->_traversing = false;
+    if (_forward) {
+        return 0;
+    }
+    this->_forward = true;
+    this->_reversal = _position;
+    return STEP_REVERSED;
+}
+
+FASTRUN void WindKernel::loadLayer() {
+    const SectionPlan &plan = _plans[_section];
+    this->_ratio = this->layerRatio(plan, _layer);
+
+    const int32_t shift = this->layerShift(plan, _layer);
+    this->_lowerBound = plan.start + PADDING + shift;
+    this->_upperBound = plan.span - shift;
+}
+
+FASTRUN uint32_t WindKernel::layerRatio(const SectionPlan &plan, uint32_t layer) const {
+    // A wider pitch moves the carriage more often, rounded to the nearest ratio
+    const uint32_t pitch = _pattern.pitch(layer);
+    const uint32_t ratio = (plan.wireRatio * 100 + pitch / 2) / pitch;
+    return ratio > 0 ? ratio : 1;
+}
+
+FASTRUN int32_t WindKernel::layerShift(const SectionPlan &plan, uint32_t layer) const {
+    return _pattern.shifted(layer) ? plan.halfPitch : 0;
+}
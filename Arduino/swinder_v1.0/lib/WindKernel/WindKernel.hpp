@@ -0,0 +1,352 @@
+#ifndef WIND_KERNEL_HPP
+#define WIND_KERNEL_HPP
+
+#include <Arduino.h>
+#include <Solenoid.hpp>
+#include <WindPattern.hpp>
+#include <Sections.hpp>
+#include <Machine.hpp>
+
+// Step mask bits, same values as TRACE_SS and TRACE_CC
+#define STEP_SS 0x01
+#define STEP_CC 0x02
+// Set with the step mask when the carriage changed direction before this step
+#define STEP_REVERSED 0x04
+
+// Carriage and pitch of one section, positions relative to the offset
+struct SectionPlan {
+    uint32_t endStep; // SS steps of the job once the section is done
+    int32_t start; // Position the section starts winding from
+    int32_t span; // Upper bound of an unshifted layer
+    uint32_t wireRatio; // SS steps per CC step at the wire pitch
+    int32_t halfPitch; // Carriage travel of half a turn at the wire pitch
+    uint32_t diameter; // Wire diameter, 0.001mm
+};
+
+/**
+ * The hardware independent part of the winding loop.
+ * Decides which motors step and when the carriage reverses, the caller does the I/O.
+ * Every carriage pass is a layer, its pitch and bounds come from the winding pattern.
+ * Between sections the carriage moves on to the next one alone, with CC steps and no SS step.
+ */
+class WindKernel {
+public:
+    /**
+     * @brief Create a new instance of the winding kernel.
+     */
+    WindKernel();
+
+    /**
+     * @brief Plans a helical job from the start, with the default wire table
+     *
+     * @param solenoid solenoid to wind
+     */
+    void begin(Solenoid &solenoid);
+
+    /**
+     * @brief Plans a job from the start
+     *
+     * @param solenoid solenoid to wind
+     * @param pattern layer pattern, copied
+     * @param wires wire table giving the diameter the pitch is set from
+     */
+    void begin(Solenoid &solenoid, const WindPattern &pattern, const WireTable &wires);
+
+    /**
+     * @brief Plans a multi-section job from the start
+     *
+     * @param sections sections to wind, at least one
+     * @param pattern layer pattern of every section, copied
+     * @param wires wire table giving the diameter the pitch of each section is set from
+     */
+    void begin(const Sections &sections, const WindPattern &pattern, const WireTable &wires);
+
+    /**
+     * @brief Continues a job from saved progress, call after begin()
+     *
+     * @param stepCount completed SS steps
+     * @param subStepCount SS steps since the last CC step
+     * @param position carriage position relative to the offset
+     * @param forward carriage direction
+     * @param layer layer being wound in the section stepCount falls in
+     */
+    void restore(uint32_t stepCount, uint32_t subStepCount, int32_t position, bool forward, uint32_t layer);
+
+    /**
+     * @brief Checks if all SS steps are done
+     *
+     * @returns true when the job is complete
+     */
+    inline bool done() const {
+        return _stepCount >= _totalSteps;
+    }
+
+    /**
+     * @brief Advances the job by one SS step, or one CC step between sections
+     *
+     * @returns STEP_SS, with STEP_CC if the carriage steps too and STEP_REVERSED
+     * if the carriage direction pin has to change before stepping. Only STEP_CC
+     * and STEP_REVERSED while the carriage moves to the next section
+     */
+    inline uint8_t next() {
+        uint8_t mask = STEP_SS;
+
+        // Carriage moves to the start of the section before winding it
+        if (_traversing) {
+            if (_position != _start) {
+                return this->traverse();
+            }
+            mask |= this->arrive();
+        }
+
+        // Reverse carriage, the next pass is the next layer
+        if (_forward && _position > _upperBound) {
+            this->_forward = false;
+            this->_reversal = _position;
+            this->_layer++;
+            this->loadLayer();
+            mask |= STEP_REVERSED;
+        } else if (!_forward && _position < _lowerBound) {
+            this->_forward = true;
+            this->_reversal = _position;
+            this->_layer++;
+            this->loadLayer();
+            mask |= STEP_REVERSED;
+        }
+
+        // Carriage steps every _ratio SS steps, a layer with a finer pitch may start past it
+        if (_subStepCount >= _ratio) {
+            mask |= STEP_CC;
+            this->_position += (_forward ? DISTANCE_PER_STEP : -DISTANCE_PER_STEP);
+            this->_subStepCount = 0;
+        }
+
+        this->_subStepCount++;
+        this->_stepCount++;
+        // One compare per step, section ends and progress are counted down to
+        if (_stepCount == _nextEvent) {
+            this->stepEvent();
+        }
+        return mask;
+    }
+
+    /**
+     * @brief Getter for job completion
+     *
+     * @returns percent of SS steps done
+     */
+    inline uint8_t percentComplete() const {
+        return _percent;
+    }
+
+    /**
+     * @brief Getter for completed SS steps
+     *
+     * @returns SS steps done
+     */
+    uint32_t stepCount() const;
+
+    /**
+     * @brief Getter for SS steps since the last CC step
+     *
+     * @returns sub step count
+     */
+    uint32_t subStepCount() const;
+
+    /**
+     * @brief Getter for SS steps of the whole job
+     *
+     * @returns total SS steps
+     */
+    uint32_t totalSteps() const;
+
+    /**
+     * @brief Getter for the carriage position
+     *
+     * @returns position relative to the offset, 0.001cm
+     */
+    int32_t position() const;
+
+    /**
+     * @brief Getter for the carriage direction
+     *
+     * @returns true if moving forward
+     */
+    bool forward() const;
+
+    /**
+     * @brief Getter for the position of the last reversal
+     *
+     * @returns position the carriage reversed at, 0.001cm
+     */
+    int32_t lastReversal() const;
+
+    /**
+     * @brief Getter for the layer bound ahead of the carriage
+     *
+     * @returns position the carriage reverses one step past, 0.001cm
+     */
+    int32_t bound() const;
+
+    /**
+     * @brief Getter for the far end of the winding area
+     *
+     * The plan mirrored about the middle of the winding area has position p at
+     * mirrorEnd() - p, so a mirrored job starts at the far end and winds back.
+     *
+     * @returns lowest plus highest layer bound of the plan, 0.001cm
+     */
+    int32_t mirrorEnd() const;
+
+    /**
+     * @brief Getter for the SS to CC step ratio of the current layer
+     *
+     * @returns SS steps per CC step
+     */
+    uint32_t ratio() const;
+
+    /**
+     * @brief Getter for the layer being wound
+     *
+     * @returns layer index in the section, 0 on the mandrel
+     */
+    uint32_t layer() const;
+
+    /**
+     * @brief Getter for the section being wound
+     *
+     * @returns section index, 0 for a single solenoid job
+     */
+    uint8_t section() const;
+
+    /**
+     * @brief Getter for the number of planned sections
+     *
+     * @returns sections in the job, 1 for a single solenoid job
+     */
+    uint8_t sectionCount() const;
+
+    /**
+     * @brief Getter for the plan of a section
+     *
+     * @param index section index, below sectionCount()
+     * @returns section plan
+     */
+    const SectionPlan &plan(uint8_t index) const;
+
+    /**
+     * @brief Getter for the layer pattern of the job
+     *
+     * @returns pattern
+     */
+    const WindPattern &pattern() const;
+
+    /**
+     * @brief SS steps of a full layer, one carriage pass between its bounds
+     *
+     * @param index section index, below sectionCount()
+     * @param layer layer index in the section
+     * @returns SS steps of the layer, at least 1
+     */
+    uint32_t layerSteps(uint8_t index, uint32_t layer) const;
+
+private:
+    /**
+     * @brief Adds a section to the plan
+     *
+     * @param offset start of the section, 0.01cm from the start of the winding area
+     * @param length length of the section, 0.01cm
+     * @param turns turns of the section
+     * @param diameter overall wire diameter of the section, 0.001mm
+     */
+    void planSection(uint32_t offset, uint32_t length, uint32_t turns, uint32_t diameter);
+
+    /**
+     * @brief Makes a section current, the carriage moves to its start first
+     *
+     * @param index section index
+     */
+    void loadSection(uint8_t index);
+
+    /**
+     * @brief Moves on to the next section once the current one is wound
+     */
+    void nextSection();
+
+    /**
+     * @brief Handles the step count reaching the end of a section or the next percent
+     */
+    void stepEvent();
+
+    /**
+     * @brief Sets the percent done from the step count and the step counts it next changes at
+     */
+    void updatePercent();
+
+    /**
+     * @brief One CC step towards the start of the section
+     *
+     * @returns step mask
+     */
+    uint8_t traverse();
+
+    /**
+     * @brief Ends the move to the section, winding always starts forward
+     *
+     * @returns STEP_REVERSED if the carriage arrived moving backward
+     */
+    uint8_t arrive();
+
+    /**
+     * @brief Sets the ratio and bounds of the current layer from the pattern
+     */
+    void loadLayer();
+
+    /**
+     * @brief SS to CC step ratio of a layer
+     *
+     * @param plan section the layer is in
+     * @param layer layer index in the section
+     * @returns SS steps per CC step, at least 1
+     */
+    uint32_t layerRatio(const SectionPlan &plan, uint32_t layer) const;
+
+    /**
+     * @brief Distance a layer starts and ends in from the section bounds
+     *
+     * @param plan section the layer is in
+     * @param layer layer index in the section
+     * @returns shift, 0.001cm
+     */
+    int32_t layerShift(const SectionPlan &plan, uint32_t layer) const;
+
+    WindPattern _pattern;
+    SectionPlan _plans[MAX_SECTIONS];
+    uint8_t _sectionCount = 0;
+    uint32_t _totalSteps = 0;
+
+    // Current section
+    uint8_t _section = 0;
+    bool _traversing = false;
+    int32_t _start = 0;
+    uint32_t _sectionEnd = 0;
+
+    // Current layer
+    uint32_t _layer = 0;
+    uint32_t _ratio = 0;
+    int32_t _lowerBound = 0;
+    int32_t _upperBound = 0;
+
+    // Progress, _nextEvent is the nearer of _sectionEnd and _nextPercent
+    uint8_t _percent = 0;
+    uint32_t _nextPercent = 0;
+    uint32_t _nextEvent = 0;
+
+    uint32_t _stepCount = 0;
+    uint32_t _subStepCount = 0;
+    int32_t _position = 0;
+    bool _forward = true;
+    int32_t _reversal = 0;
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "WindPattern.hpp"
+#include <strings.h>
+
+WindPattern::WindPattern() {}
+
+// PUBLIC
+
+PatternType WindPattern::getType() const {
+    return _type;
+}
+
+bool WindPattern::setType(PatternType type) {
+    if (type > MAX_PATTERN) {
+        return false;
+    }
+    this->_type = type;
+    return true;
+}
+
+bool WindPattern::setPitches(const uint8_t *pitches, uint8_t count) {
+    if (count == 0 || count > PATTERN_TABLE_SIZE) {
+        return false;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (pitches[i] < MIN_PITCH || pitches[i] > MAX_PITCH) {
+            return false;
+        }
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        this->_pitches[i] = pitches[i];
+    }
+    this->_pitchCount = count;
+    return true;
+}
+
+const uint8_t *WindPattern::pitches() const {
+    return _pitches;
+}
+
+uint8_t WindPattern::pitchCount() const {
+    return _pitchCount;
+}
+
+uint8_t WindPattern::pitch(uint32_t layer) const {
+    switch (_type) {
+        case PatternType::PATTERN_PROGRESSIVE: {
+            uint32_t pitch = 100 + layer * PROGRESSIVE_STEP;
+            return pitch < PROGRESSIVE_MAX ? pitch : PROGRESSIVE_MAX;
+        }
+        case PatternType::PATTERN_CUSTOM:
+            return _pitches[layer < _pitchCount ? layer : _pitchCount - 1];
+        default:
+            return 100;
+    }
+}
+
+bool WindPattern::shifted(uint32_t layer) const {
+    return _type == PatternType::PATTERN_ORTHOCYCLIC && (layer & 1);
+}
+
+uint32_t WindPattern::layerTurns(uint32_t layer, uint32_t turnsPerPass) const {
+    uint32_t turns = (turnsPerPass * 100) / this->pitch(layer);
+    // A shifted layer loses half a pitch at each end
+    if (this->shifted(layer) && turns > 0) {
+        turns--;
+    }
+    return turns;
+}
+
+uint32_t WindPattern::layerHeight(uint32_t layer, uint32_t diameter) const {
+    // Only a layer at the full wire pitch sits in the grooves of the one below
+    if (_type == PatternType::PATTERN_ORTHOCYCLIC && layer > 0) {
+        return (diameter * ORTHOCYCLIC_HEIGHT) / 1000;
+    }
+    return diameter;
+}
+
+String WindPattern::typeString() const {
+    return typeString(_type);
+}
+
+String WindPattern::typeString(PatternType type) {
+    switch (type) {
+        case PatternType::PATTERN_HELICAL: return "Helical";
+        case PatternType::PATTERN_ORTHOCYCLIC: return "Orthocyclic";
+        case PatternType::PATTERN_PROGRESSIVE: return "Progressive";
+        case PatternType::PATTERN_CUSTOM: return "Custom";
+        default: return "Error";
+    }
+}
+
+bool WindPattern::find(const char *text, PatternType &type) {
+    for (uint8_t i = 0; i <= MAX_PATTERN; i++) {
+        if (strcasecmp(typeString(static_cast<PatternType>(i)).c_str(), text) == 0) {
+            type = static_cast<PatternType>(i);
+            return true;
+        }
+    }
+    return false;
+}
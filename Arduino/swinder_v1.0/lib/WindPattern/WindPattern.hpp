@@ -0,0 +1,134 @@
+#ifndef WIND_PATTERN_HPP
+#define WIND_PATTERN_HPP
+
+#include <Arduino.h>
+
+#define MAX_PATTERN 3 // Number of pattern types - 1
+#define PATTERN_TABLE_SIZE 8 // Layers in a custom pitch table, the last entry holds for deeper layers
+#define MIN_PITCH 50 // Percent of the wire pitch
+#define MAX_PITCH 250
+#define PROGRESSIVE_STEP 5 // Percent wider per layer
+#define PROGRESSIVE_MAX 150
+#define ORTHOCYCLIC_HEIGHT 866 // Height of a nested layer over the wire diameter, 0.001 precision; sqrt(3)/2
+
+enum PatternType {
+    PATTERN_HELICAL = 0, // Every layer at the wire pitch, straight on top of the last
+    PATTERN_ORTHOCYCLIC = 1, // Odd layers shifted half a pitch into the grooves of the layer below
+    PATTERN_PROGRESSIVE = 2, // Pitch widens with every layer
+    PATTERN_CUSTOM = 3, // Pitch per layer from a table
+};
+
+/**
+ * Carriage pitch and travel of every layer of a winding.
+ * Pitches are percent of the wire pitch the kernel derives from the wire diameter.
+ */
+class WindPattern {
+public:
+    /**
+     * @brief Create a new instance of the winding pattern, helical with a flat table.
+     */
+    WindPattern();
+
+    /**
+     * @brief Getter for the pattern type
+     *
+     * @returns pattern type
+     */
+    PatternType getType() const;
+
+    /**
+     * @brief Setter for the pattern type
+     *
+     * @param type pattern type
+     * @returns false if the type is out of range
+     */
+    bool setType(PatternType type);
+
+    /**
+     * @brief Setter for the custom pitch table
+     *
+     * @param pitches pitch of each layer from the first, percent of the wire pitch
+     * @param count number of layers in the table, 1 to PATTERN_TABLE_SIZE
+     * @returns false if the count or a pitch is out of range, the table is kept then
+     */
+    bool setPitches(const uint8_t *pitches, uint8_t count);
+
+    /**
+     * @brief Getter for the custom pitch table
+     *
+     * @returns pitches, pitchCount() entries
+     */
+    const uint8_t *pitches() const;
+
+    /**
+     * @brief Getter for the custom pitch table size
+     *
+     * @returns number of layers in the table
+     */
+    uint8_t pitchCount() const;
+
+    /**
+     * @brief Pitch of a layer
+     *
+     * @param layer layer index, 0 on the mandrel
+     * @returns percent of the wire pitch
+     */
+    uint8_t pitch(uint32_t layer) const;
+
+    /**
+     * @brief Checks if a layer starts and ends half a pitch in from the bounds
+     *
+     * @param layer layer index, 0 on the mandrel
+     * @returns true if the layer is shifted
+     */
+    bool shifted(uint32_t layer) const;
+
+    /**
+     * @brief Turns that fit in a layer
+     *
+     * @param layer layer index, 0 on the mandrel
+     * @param turnsPerPass turns of a helical layer, see Solenoid::turnsPerPass()
+     * @returns turns in the layer
+     */
+    uint32_t layerTurns(uint32_t layer, uint32_t turnsPerPass) const;
+
+    /**
+     * @brief Radial build of a layer
+     *
+     * @param layer layer index, 0 on the mandrel
+     * @param diameter overall wire diameter with 0.001mm precision, see WireTable::diameter()
+     * @returns layer height with 0.001mm precision
+     */
+    uint32_t layerHeight(uint32_t layer, uint32_t diameter) const;
+
+    /**
+     * @brief Provides a string format for the pattern type
+     *
+     * @returns String representation of the type
+     */
+    String typeString() const;
+
+    /**
+     * @brief Provides a string format for any pattern type
+     *
+     * @param type type to format
+     * @returns String representation of the type
+     */
+    static String typeString(PatternType type);
+
+    /**
+     * @brief Looks a pattern type up by its name, ignoring case
+     *
+     * @param text name such as "helical"
+     * @param type set to the type if found
+     * @returns false if no type has the name
+     */
+    static bool find(const char *text, PatternType &type);
+
+private:
+    PatternType _type = PatternType::PATTERN_HELICAL;
+    uint8_t _pitches[PATTERN_TABLE_SIZE] = {100};
+    uint8_t _pitchCount = 1;
+};
+
+#endif
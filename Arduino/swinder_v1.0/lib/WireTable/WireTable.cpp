@@ -0,0 +1,147 @@
+#include "WireTable.hpp"
+#include <EEPROM.h>
+#include <strings.h>
+
+// One wire, diameters 0.001mm. Overall diameters are the largest the grade allows
+struct WireSpec {
+    char name[8];
+    uint16_t copper;
+    uint16_t grade1;
+    uint16_t grade2;
+};
+
+// Indexed by WireGauge, kept in flash
+static const WireSpec WIRES[WIRE_COUNT] PROGMEM = {
+    {"AWG18", 1020, 1068, 1092},
+    {"AWG19", 910, 953, 975},
+    {"AWG20", 810, 851, 871},
+    {"AWG21", 720, 759, 777},
+    {"AWG22", 643, 678, 696},
+    {"AWG23", 574, 605, 622},
+    {"AWG24", 511, 541, 556},
+    {"AWG25", 450, 483, 498},
+    {"AWG26", 404, 432, 445},
+    {"AWG27", 361, 386, 399},
+    {"AWG28", 320, 345, 356},
+    {"AWG29", 290, 308, 319},
+    {"AWG30", 254, 276, 287},
+    {"AWG31", 227, 246, 256},
+    {"AWG32", 202, 220, 229},
+    {"AWG33", 180, 196, 206},
+    {"AWG34", 160, 175, 183},
+    {"AWG35", 143, 157, 165},
+    {"AWG36", 127, 140, 147},
+    {"AWG37", 113, 125, 132},
+    {"AWG38", 101, 112, 119},
+    {"AWG39", 90, 99, 106},
+    {"AWG40", 80, 89, 94},
+    {"0.10mm", 100, 117, 125},
+    {"0.12mm", 120, 139, 147},
+    {"0.15mm", 150, 171, 181},
+    {"0.18mm", 180, 203, 214},
+    {"0.20mm", 200, 226, 239},
+    {"0.25mm", 250, 281, 297},
+    {"0.30mm", 300, 334, 351},
+    {"0.35mm", 350, 387, 408},
+    {"0.40mm", 400, 439, 462},
+    {"0.45mm", 450, 491, 516},
+    {"0.50mm", 500, 544, 569},
+    {"0.56mm", 560, 606, 632},
+    {"0.60mm", 600, 647, 674},
+    {"0.63mm", 630, 679, 706},
+    {"0.71mm", 710, 762, 790},
+    {"0.75mm", 750, 805, 832},
+    {"0.80mm", 800, 855, 885},
+    {"0.90mm", 900, 959, 990},
+    {"1.00mm", 1000, 1062, 1093},
+};
+
+WireTable::WireTable() {
+    this->_stored.magic = WIRE_TABLE_MAGIC;
+    this->_stored.grade = WireGrade::GRADE_2;
+    for (uint8_t i = 0; i < WIRE_COUNT; i++) {
+        this->_stored.measured[i] = 0;
+    }
+}
+
+// PUBLIC
+
+void WireTable::begin() {
+    Stored stored;
+    EEPROM.get(WIRE_TABLE_EEPROM_ADDR, stored);
+    // Erased flash, or a table from before this layout
+    if (stored.magic != WIRE_TABLE_MAGIC || (stored.grade != WireGrade::GRADE_1 && stored.grade != WireGrade::GRADE_2)) {
+        return;
+    }
+    for (uint8_t i = 0; i < WIRE_COUNT; i++) {
+        if (stored.measured[i] != 0 && (stored.measured[i] < MIN_MEASURED_DIAMETER || stored.measured[i] > MAX_MEASURED_DIAMETER)) {
+            return;
+        }
+    }
+    this->_stored = stored;
+}
+
+WireGrade WireTable::getGrade() const {
+    return static_cast<WireGrade>(_stored.grade);
+}
+
+bool WireTable::setGrade(WireGrade grade) {
+    if (grade != WireGrade::GRADE_1 && grade != WireGrade::GRADE_2) {
+        return false;
+    }
+    this->_stored.grade = grade;
+    this->save();
+    return true;
+}
+
+uint32_t WireTable::measured(WireGauge gauge) const {
+    return _stored.measured[gauge];
+}
+
+bool WireTable::setMeasured(WireGauge gauge, uint32_t diameter) {
+    if (gauge > MAX_GAUGE || (diameter != 0 && (diameter < MIN_MEASURED_DIAMETER || diameter > MAX_MEASURED_DIAMETER))) {
+        return false;
+    }
+    this->_stored.measured[gauge] = diameter;
+    this->save();
+    return true;
+}
+
+uint32_t WireTable::copperDiameter(WireGauge gauge) {
+    return WIRES[gauge].copper;
+}
+
+uint32_t WireTable::gradeDiameter(WireGauge gauge, WireGrade grade) {
+    return grade == WireGrade::GRADE_1 ? WIRES[gauge].grade1 : WIRES[gauge].grade2;
+}
+
+String WireTable::name(WireGauge gauge) {
+    if (gauge > MAX_GAUGE) {
+        return "Error";
+    }
+    return WIRES[gauge].name;
+}
+
+bool WireTable::find(const char *text, WireGauge &gauge) {
+    for (uint8_t i = 0; i <= MAX_GAUGE; i++) {
+        if (strcasecmp(WIRES[i].name, text) == 0) {
+            gauge = static_cast<WireGauge>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+String WireTable::gradeString(WireGrade grade) {
+    switch (grade) {
+        case WireGrade::GRADE_1: return "Grade 1";
+        case WireGrade::GRADE_2: return "Grade 2";
+        default: return "Error";
+    }
+}
+
+// PRIVATE
+
+void WireTable::save() {
+    EEPROM.put(WIRE_TABLE_EEPROM_ADDR, this->_stored);
+}
@@ -0,0 +1,179 @@
+#ifndef WIRE_TABLE_HPP
+#define WIRE_TABLE_HPP
+
+#include <Arduino.h>
+
+#define WIRE_COUNT 42 // Entries in the wire table
+#define MAX_GAUGE 41 // WIRE_COUNT - 1
+#define WIRE_TABLE_EEPROM_ADDR 2112 // After the checkpoint sections
+#define WIRE_TABLE_MAGIC 0x5754 // "WT"
+#define MIN_MEASURED_DIAMETER 50 // 0.05mm
+#define MAX_MEASURED_DIAMETER 1200 // 1.2mm
+
+enum WireGauge { // Table index, diameters are in WireTable.cpp
+    AWG18 = 0,
+    AWG19 = 1,
+    AWG20 = 2,
+    AWG21 = 3,
+    AWG22 = 4,
+    AWG23 = 5,
+    AWG24 = 6,
+    AWG25 = 7,
+    AWG26 = 8,
+    AWG27 = 9,
+    AWG28 = 10,
+    AWG29 = 11,
+    AWG30 = 12,
+    AWG31 = 13,
+    AWG32 = 14,
+    AWG33 = 15,
+    AWG34 = 16,
+    AWG35 = 17,
+    AWG36 = 18,
+    AWG37 = 19,
+    AWG38 = 20,
+    AWG39 = 21,
+    AWG40 = 22,
+    MM010 = 23, // 0.10mm
+    MM012 = 24,
+    MM015 = 25,
+    MM018 = 26,
+    MM020 = 27,
+    MM025 = 28,
+    MM030 = 29,
+    MM035 = 30,
+    MM040 = 31,
+    MM045 = 32,
+    MM050 = 33,
+    MM056 = 34,
+    MM060 = 35,
+    MM063 = 36,
+    MM071 = 37,
+    MM075 = 38,
+    MM080 = 39,
+    MM090 = 40,
+    MM100 = 41, // 1.00mm
+};
+
+enum WireGrade {
+    GRADE_1 = 1, // Single build enamel
+    GRADE_2 = 2, // Heavy build enamel, the usual magnet wire stock
+};
+
+/**
+ * Copper and overall diameters of every wire the machine winds, AWG and IEC 60317 metric.
+ * The overall diameter of the loaded enamel grade sets the pitch and layer height,
+ * a diameter measured on the spool replaces it. Diameters are 0.001mm.
+ */
+class WireTable {
+public:
+    /**
+     * @brief Create a new instance of the wire table, grade 2 with nothing measured.
+     */
+    WireTable();
+
+    /**
+     * @brief Loads the grade and measured diameters from EEPROM, keeps the defaults if none were saved
+     */
+    void begin();
+
+    /**
+     * @brief Getter for the enamel grade of the loaded wire
+     *
+     * @returns grade
+     */
+    WireGrade getGrade() const;
+
+    /**
+     * @brief Setter for the enamel grade of the loaded wire, saved to EEPROM
+     *
+     * @param grade grade
+     * @returns false if the grade is not in the table
+     */
+    bool setGrade(WireGrade grade);
+
+    /**
+     * @brief Overall diameter a wire is wound at, constant time
+     *
+     * @param gauge wire
+     * @returns measured diameter if there is one, else the diameter of the grade
+     */
+    inline uint32_t diameter(WireGauge gauge) const {
+        return _stored.measured[gauge] != 0 ? _stored.measured[gauge] : gradeDiameter(gauge, static_cast<WireGrade>(_stored.grade));
+    }
+
+    /**
+     * @brief Getter for the measured diameter of a wire
+     *
+     * @param gauge wire
+     * @returns measured diameter, 0 if none
+     */
+    uint32_t measured(WireGauge gauge) const;
+
+    /**
+     * @brief Setter for the measured diameter of a wire, saved to EEPROM
+     *
+     * @param gauge wire
+     * @param diameter overall diameter over the enamel, 0 to use the grade again
+     * @returns false if the diameter is out of range
+     */
+    bool setMeasured(WireGauge gauge, uint32_t diameter);
+
+    /**
+     * @brief Nominal copper diameter of a wire
+     *
+     * @param gauge wire
+     * @returns copper diameter
+     */
+    static uint32_t copperDiameter(WireGauge gauge);
+
+    /**
+     * @brief Largest overall diameter of a wire with an enamel grade
+     *
+     * @param gauge wire
+     * @param grade enamel grade
+     * @returns overall diameter
+     */
+    static uint32_t gradeDiameter(WireGauge gauge, WireGrade grade);
+
+    /**
+     * @brief Provides a string format for a wire
+     *
+     * @param gauge wire
+     * @returns name such as "AWG24" or "0.50mm"
+     */
+    static String name(WireGauge gauge);
+
+    /**
+     * @brief Looks a wire up by its name, ignoring case
+     *
+     * @param text name such as "awg24" or "0.50mm"
+     * @param gauge set to the wire if found
+     * @returns false if no wire has the name
+     */
+    static bool find(const char *text, WireGauge &gauge);
+
+    /**
+     * @brief Provides a string format for an enamel grade
+     *
+     * @param grade grade
+     * @returns String representation of the grade
+     */
+    static String gradeString(WireGrade grade);
+
+private:
+    /**
+     * @brief Writes the grade and measured diameters to EEPROM
+     */
+    void save();
+
+    struct Stored {
+        uint16_t magic;
+        uint8_t grade;
+        uint16_t measured[WIRE_COUNT];
+    };
+
+    Stored _stored;
+};
+
+#endif
@@ -0,0 +1,196 @@
+"""
+Teensy 4.1 memory report
+Prints the size of every memory region of the firmware and checks that the step path
+is in ITCM and the large buffers are in DMAMEM. A symbol found elsewhere fails the
+build, so a placement regression shows up before it costs step timing jitter.
+
+Runs after every teensy41 build as a PlatformIO extra script, or by hand:
+  python memory_report.py <firmware.elf> [--nm <path>] [--size <path>]
+
+Code without FASTRUN or FLASHMEM is copied to ITCM by the Teensy core, ITCM is taken
+from the same 512KB as DTCM in 32KB banks. Everything FASTRUN here is therefore also
+a claim on DTCM, which holds the globals and the stack.
+"""
+import subprocess
+import sys
+
+KB = 1024
+FLEXRAM_SIZE = 512 * KB  # ITCM and DTCM share it
+FLEXRAM_BANK = 32 * KB
+
+# Name, start, end, by address
+REGIONS = [
+    ("ITCM", 0x00000000, 0x00080000),
+    ("DTCM", 0x20000000, 0x20080000),
+    ("DMAMEM", 0x20200000, 0x20280000),
+    ("FLASH", 0x60000000, 0x60800000),
+    ("EXTMEM", 0x70000000, 0x71000000),
+]
+
+# Symbols that must stay in a region, matched on the demangled name without arguments
+PLACEMENT = [
+    # GPIO step loop
+    ("windGpio", "ITCM"),
+    ("countSteps", "ITCM"),
+    ("stepSS", "ITCM"),
+    ("stepCC", "ITCM"),
+    ("stepBoth", "ITCM"),
+    ("stepIdle", "ITCM"),
+    # DMA step loop, planner consumer
+    ("windDma", "ITCM"),
+    ("DmaStepper::fill", "ITCM"),
+    ("DmaStepper::fillHalf", "ITCM"),
+    ("DmaStepper::record", "ITCM"),
+    ("DmaStepper::isr", "ITCM"),
+    ("DmaStepper::takePlayedSteps", "ITCM"),
+    # Kernel events
+    ("WindKernel::stepEvent", "ITCM"),
+    ("WindKernel::updatePercent", "ITCM"),
+    ("WindKernel::traverse", "ITCM"),
+    ("WindKernel::arrive", "ITCM"),
+    ("WindKernel::loadLayer", "ITCM"),
+    ("WindKernel::nextSection", "ITCM"),
+    ("SpeedProfile::next", "ITCM"),
+    ("SpeedProfile::loadLayer", "ITCM"),
+    # Fault handling
+    ("faultStop", "ITCM"),
+    ("FaultMonitor::ssIsr", "ITCM"),
+    ("FaultMonitor::ccIsr", "ITCM"),
+    # Trace recording
+    ("StepTrace::rotate", "ITCM"),
+    ("StepTrace::service", "ITCM"),
+    ("StepTrace::direction", "ITCM"),
+    # Deadlines and watchdog
+    ("DeadlineMonitor::overrun", "ITCM"),
+    ("Watchdog::isr", "ITCM"),
+    ("watchdogWarning", "ITCM"),
+    # Buffers
+    ("StepTrace::_blocks", "DMAMEM"),
+    ("ssWave", "DMAMEM"),
+    ("ccWave", "DMAMEM"),
+]
+
+HOT_COUNT = 10  # Largest ITCM and DTCM symbols listed
+
+
+def region(address):
+    for name, start, end in REGIONS:
+        if start <= address < end:
+            return name
+    return None
+
+
+def symbols(elf, nm):
+    """Defined symbols with a size as (name, address, size, region)"""
+    output = subprocess.run([nm, "--print-size", "--demangle", "--defined-only", elf],
+                            check=True, capture_output=True, text=True).stdout
+    result = []
+    for line in output.splitlines():
+        fields = line.split(None, 3)
+        if len(fields) != 4:
+            continue
+        address, size, kind, name = fields
+        # Absolute symbols are linker constants, not placed anywhere
+        if len(kind) != 1 or kind in "aA":
+            continue
+        address = int(address, 16)
+        result.append((name, address, int(size, 16), region(address)))
+    return result
+
+
+def sections(elf, size):
+    """Allocated sections as (name, address, size, region)"""
+    output = subprocess.run([size, "-A", elf], check=True, capture_output=True, text=True).stdout
+    result = []
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) != 3 or not fields[1].isdigit() or not fields[2].isdigit():
+            continue
+        name, length, address = fields[0], int(fields[1]), int(fields[2])
+        # Debug and note sections are not loaded, they all sit at address 0 in the ITCM range
+        if address == 0 and not name.startswith(".text"):
+            continue
+        if length > 0 and region(address) is not None:
+            result.append((name, address, length, region(address)))
+    return result
+
+
+def report(elf, nm, size):
+    """Prints the report, returns False if a symbol is out of place"""
+    found = sections(elf, size)
+    used = {}
+    print("Memory report for %s" % elf)
+    print("%-16s %-8s %10s" % ("section", "region", "bytes"))
+    for name, _, length, where in found:
+        print("%-16s %-8s %10d" % (name, where, length))
+        used[where] = used.get(where, 0) + length
+
+    itcm = used.get("ITCM", 0)
+    banks = (itcm + FLEXRAM_BANK - 1) // FLEXRAM_BANK
+    dtcm_size = FLEXRAM_SIZE - banks * FLEXRAM_BANK
+    dtcm = used.get("DTCM", 0)
+    print()
+    print("ITCM   %7d bytes in %d banks of 32KB, %d bytes of the last bank free" %
+          (itcm, banks, banks * FLEXRAM_BANK - itcm))
+    print("DTCM   %7d of %d bytes, %d left for the stack" % (dtcm, dtcm_size, dtcm_size - dtcm))
+    print("DMAMEM %7d of %d bytes" % (used.get("DMAMEM", 0), 512 * KB))
+    print("FLASH  %7d bytes, FLASHMEM code and the load image of ITCM and DTCM" % used.get("FLASH", 0))
+
+    table = symbols(elf, nm)
+    for where in ("ITCM", "DTCM"):
+        largest = sorted((s for s in table if s[3] == where), key=lambda s: -s[2])[:HOT_COUNT]
+        print()
+        print("Largest in %s" % where)
+        for name, address, length, _ in largest:
+            print("  %08x %7d %s" % (address, length, name))
+
+    ok = True
+    print()
+    print("Placement")
+    for wanted, where in PLACEMENT:
+        matches = [s for s in table if s[0].split("(")[0] == wanted]
+        if not matches:
+            # Inlined everywhere or not built into this configuration
+            print("  %-28s %-8s inlined or absent" % (wanted, where))
+            continue
+        for name, address, _, actual in matches:
+            good = actual == where
+            ok = ok and good
+            print("  %-28s %-8s %08x %s" % (wanted, actual, address, "ok" if good else "WRONG, wants " + where))
+    if not ok:
+        print("Step path placement regressed, see FASTRUN and DMAMEM in the sources")
+    return ok
+
+
+def main(argv):
+    nm = "arm-none-eabi-nm"
+    size = "arm-none-eabi-size"
+    elf = None
+    args = iter(argv[1:])
+    for arg in args:
+        if arg == "--nm":
+            nm = next(args, nm)
+        elif arg == "--size":
+            size = next(args, size)
+        elif elf is None:
+            elf = arg
+        else:
+            elf = None
+            break
+    if elf is None:
+        print("Usage: %s <firmware.elf> [--nm <path>] [--size <path>]" % argv[0], file=sys.stderr)
+        return 1
+    return 0 if report(elf, nm, size) else 2
+
+
+try:
+    Import("env")  # noqa: F821, defined when PlatformIO runs this as an extra script
+except NameError:
+    if __name__ == "__main__":
+        sys.exit(main(sys.argv))
+else:
+    def after_build(source, target, env):
+        tools = env.subst("$CC")
+        return 0 if report(str(target[0]), tools.replace("gcc", "nm"), tools.replace("gcc", "size")) else 1
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", after_build)  # noqa: F821
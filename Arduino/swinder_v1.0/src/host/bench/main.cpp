@@ -0,0 +1,183 @@
+/*
+Host microbenchmarks
+Reports ns/op and heap allocations/op for the Solenoid math, value formatting and
+the per-step winding logic with pin I/O stubbed by the host core.
+
+Usage: bench [iterations]
+Numbers are for the host CPU. Allocations are operator new calls plus the heap use of
+String, which the host core counts the way the Teensy String allocates. Use the `bench`
+console command for on-target step rates.
+*/
+#include <Arduino.h>
+#include <Solenoid.hpp>
+#include <Format.hpp>
+#include <Machine.hpp>
+#include <WindKernel.hpp>
+#include <StepTrace.hpp>
+#include <chrono>
+#include <new>
+
+#define BENCH_ITERATIONS 2000000
+
+// Same pins as main.cpp, only used to exercise the stubbed pin I/O
+#define SS_STEP_PIN 36
+#define CC_STEP_PIN 39
+#define CC_DIR_PIN 38
+#define RE_BUTTON_PIN 21
+
+// Allocation counting
+static uint64_t allocations = 0;
+
+void *operator new(size_t size) {
+    allocations++;
+    void *p = malloc(size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+    free(p);
+}
+
+// Keeps a value alive so the measured work is not optimized away
+template <class T>
+inline void keep(T const &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <class F>
+void bench(const char *name, uint64_t iterations, F body) {
+    // Warm up caches and branch predictors
+    for (uint64_t i = 0; i < iterations / 10; i++) {
+        body(i);
+    }
+
+    allocations = 0;
+    const uint64_t strings = HostArduino::stringAllocations();
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; i++) {
+        body(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    const uint64_t allocs = allocations + HostArduino::stringAllocations() - strings;
+    printf("%-32s %12llu %10.2f %10.3f\n", name, (unsigned long long) iterations,
+        ns / iterations, (double) allocs / iterations);
+}
+
+/**
+ * Sink that discards blocks, so trace cost is only the encoding
+ */
+class NullTraceSink : public TraceSink {
+public:
+    bool open() override { return true; }
+    bool ready() override { return true; }
+    bool write(const uint8_t *block) override { keep(block[0]); return true; }
+    void close() override {}
+};
+
+int main(int argc, char **argv) {
+    uint64_t iterations = argc > 1 ? strtoull(argv[1], nullptr, 10) : BENCH_ITERATIONS;
+
+    printf("%-32s %12s %10s %10s\n", "benchmark", "iterations", "ns/op", "allocs/op");
+
+    Solenoid solenoid;
+    solenoid.begin(Preset::A);
+    WireTable wires;
+
+    bench("Solenoid::getTurns", iterations, [&](uint64_t i) {
+        solenoid.setInductance(4000 + (i & 1023));
+        keep(solenoid.getTurns());
+    });
+
+    bench("Solenoid::turnsPerPass", iterations, [&](uint64_t i) {
+        solenoid.setLength(100 + (i & 1023));
+        keep(solenoid.turnsPerPass(wires));
+    });
+
+    bench("WireTable::diameter", iterations, [&](uint64_t i) {
+        keep(wires.diameter(static_cast<WireGauge>(i % WIRE_COUNT)));
+    });
+
+    bench("formatVal length", iterations, [&](uint64_t i) {
+        String value = formatVal(i % MAX_LENGTH, MAX_LENGTH);
+        keep(value.length());
+    });
+
+    bench("formatVal inductance", iterations, [&](uint64_t i) {
+        String value = formatVal(i % MAX_INDUCTANCE, MAX_INDUCTANCE);
+        keep(value.length());
+    });
+
+    solenoid.begin(Preset::A);
+    WindKernel kernel;
+    kernel.begin(solenoid);
+
+    bench("WindKernel::next", iterations, [&](uint64_t i) {
+        if (kernel.done()) {
+            kernel.restore(0, 0, 0, true, 0);
+        }
+        keep(kernel.next());
+    });
+
+    // spin() loop body with pins going to the host core and the trace encoding into a null sink
+    NullTraceSink sink;
+    StepTrace trace;
+    trace.begin(sink);
+    trace.start(micros());
+    kernel.begin(solenoid);
+    uint8_t oldPercentComplete = 0;
+    volatile uint8_t faultLatch = 0;
+    HostArduino::setPin(RE_BUTTON_PIN, HIGH); // Released
+
+    bench("spin step (stubbed I/O, traced)", iterations, [&](uint64_t i) {
+        if (kernel.done()) {
+            kernel.restore(0, 0, 0, true, 0);
+        }
+        if (faultLatch != 0 || digitalRead(RE_BUTTON_PIN) == LOW) {
+            return;
+        }
+
+        uint8_t mask = kernel.next();
+        if (mask & STEP_REVERSED) {
+            digitalWrite(CC_DIR_PIN, kernel.forward());
+            trace.direction(kernel.forward(), kernel.lastReversal(), micros());
+        }
+        trace.step(mask & (STEP_SS | STEP_CC), micros());
+        if (mask & STEP_CC) {
+            digitalWrite(CC_STEP_PIN, HIGH);
+        }
+        digitalWrite(SS_STEP_PIN, HIGH);
+        digitalWrite(CC_STEP_PIN, LOW);
+        digitalWrite(SS_STEP_PIN, LOW);
+        trace.service();
+
+        uint8_t newPercentComplete = kernel.percentComplete();
+        if (newPercentComplete != oldPercentComplete) {
+            oldPercentComplete = newPercentComplete;
+        }
+        keep(oldPercentComplete);
+    });
+    trace.stop();
+
+    return 0;
+}
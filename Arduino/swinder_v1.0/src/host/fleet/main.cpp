@@ -0,0 +1,531 @@
+/*
+Fleet controller
+Spreads a queue of coil jobs over several machines through their serial consoles and
+collects progress and completion stats. Machines are USB serial ports, or simulated
+devices running the firmware on the host core, for development and load tests.
+
+Usage: fleet --jobs <file> [--port <device>]... [--sim <count>] [--speed <factor>] [--verbose]
+  --jobs <file>      job queue, one job per line: <length cm> <radius cm> <inductance mH> <gauge> [count]
+  --port <device>    a machine on a serial port, e.g. /dev/ttyACM0, repeat for more
+  --sim <count>      add simulated machines
+  --speed <factor>   simulated time per wall time, default 1
+  --verbose          show every line the machines send
+
+The controller only uses the console: `section clear`, `set` and `start` to begin a job
+and `status` to follow it. Every job is a single solenoid wound helically, whatever
+sections or pattern the machine was left with. Faults are left to the operator at the machine, a job aborted there goes back
+on the queue. A machine that powers on with an unfinished job is told to `resume` it
+before it takes new work, that job is job 0 and is not requeued if aborted. It exits once
+the queue is empty and every machine is idle.
+*/
+#include <Arduino.h>
+#include <Solenoid.hpp>
+#include <WireTable.hpp>
+#include <Format.hpp>
+#include <HostMachine.hpp>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+#define STATUS_INTERVAL 1000 // ms between status requests to a machine
+#define REPORT_INTERVAL 10000 // ms between progress lines
+#define SIM_CARRIAGE 1000 // 0.001cm from the start switch at power on
+#define SIM_SERVICE_INTERVAL 2000 // us of simulated time between serial and clock checks
+
+// Firmware entry points, for the simulated machines
+void setup();
+void loop();
+
+struct CoilJob {
+    uint32_t id;
+    uint32_t length; // 0.01cm
+    uint32_t radius; // 0.01cm
+    uint32_t inductance; // 0.01mH
+    WireGauge gauge;
+};
+
+struct Machine {
+    std::string name;
+    int fd;
+    pid_t pid; // Simulated machine process, 0 for a serial port
+    std::string input; // Partial line
+    bool statusPending; // One status request in flight at a time
+    uint64_t lastStatus; // ms
+
+    // Last status
+    std::string state;
+    uint32_t percent;
+    uint32_t logJobs; // From the machine's own job log
+    uint32_t logCompleted;
+
+    // Current job
+    bool busy;
+    CoilJob job;
+    bool started; // Machine accepted the start, later status lines are about this job
+    bool faulted;
+    uint64_t jobStart; // ms
+
+    // Stats
+    uint32_t completed;
+    uint32_t faults;
+    uint64_t busyTime; // ms
+};
+
+// Wall clock
+uint64_t wallMillis() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+// SIMULATED MACHINE
+
+namespace {
+
+int deviceFd = -1;
+double deviceSpeed = 1;
+uint64_t deviceEpoch = 0; // us, wall time at power on
+uint64_t deviceServiced = 0; // us of simulated time
+
+uint64_t wallMicros() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+// Keeps the simulated clock at speed times the wall clock and moves serial input to the firmware
+void serveDevice(uint64_t now) {
+    if (now - deviceServiced < SIM_SERVICE_INTERVAL) {
+        return;
+    }
+    deviceServiced = now;
+
+    uint64_t target = deviceEpoch + (uint64_t) (now / deviceSpeed);
+    uint64_t wall = wallMicros();
+    if (target > wall) {
+        usleep(target - wall);
+    }
+
+    char buffer[256];
+    ssize_t length = read(deviceFd, buffer, sizeof(buffer));
+    if (length == 0) {
+        // Controller went away
+        _exit(0);
+    }
+    if (length > 0) {
+        Serial.feed(String(std::string(buffer, length)));
+    }
+}
+
+}
+
+// Runs the firmware in this process with Serial on fd, never returns
+void runDevice(int fd, double speed) {
+    deviceFd = fd;
+    deviceSpeed = speed;
+    deviceEpoch = wallMicros();
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    dup2(fd, STDOUT_FILENO);
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+
+    HostMachine::begin(SIM_CARRIAGE, nullptr);
+    HostArduino::onAdvance(serveDevice);
+    setup();
+    while (true) {
+        loop();
+    }
+}
+
+// CONTROLLER
+
+bool addSimulated(std::vector<Machine> &machines, double speed) {
+    int pair[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+        perror("socketpair");
+        return false;
+    }
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return false;
+    }
+    if (pid == 0) {
+        // Only the controller may hold the other machines' sockets, or they never see it go away
+        for (const Machine &machine : machines) {
+            close(machine.fd);
+        }
+        close(pair[0]);
+        runDevice(pair[1], speed);
+    }
+    close(pair[1]);
+    fcntl(pair[0], F_SETFL, O_NONBLOCK);
+
+    Machine machine = Machine();
+    machine.name = "sim" + std::to_string(machines.size());
+    machine.fd = pair[0];
+    machine.pid = pid;
+    machines.push_back(machine);
+    return true;
+}
+
+bool addPort(std::vector<Machine> &machines, const char *path) {
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        perror(path);
+        return false;
+    }
+    // Raw bytes, the Teensy USB serial ignores the baud rate
+    struct termios tty;
+    if (tcgetattr(fd, &tty) == 0) {
+        cfmakeraw(&tty);
+        cfsetspeed(&tty, B115200);
+        tcsetattr(fd, TCSANOW, &tty);
+    }
+
+    Machine machine = Machine();
+    machine.name = path;
+    machine.fd = fd;
+    machine.pid = 0;
+    machines.push_back(machine);
+    return true;
+}
+
+void send(Machine &machine, const std::string &line) {
+    std::string data = line + "\n";
+    size_t sent = 0;
+    while (sent < data.length()) {
+        ssize_t n = write(machine.fd, data.c_str() + sent, data.length() - sent);
+        if (n > 0) {
+            sent += n;
+        } else if (n < 0 && errno != EAGAIN && errno != EINTR) {
+            fprintf(stderr, "%s: write failed: %s\n", machine.name.c_str(), strerror(errno));
+            return;
+        } else {
+            usleep(1000);
+        }
+    }
+}
+
+// Values go through the same console parser the operator uses
+void startJob(Machine &machine, const CoilJob &job, uint64_t now) {
+    // Sections and the pattern stay set on the machine, from the operator or a discarded resume
+    send(machine, "section clear");
+    send(machine, "set pattern helical");
+    send(machine, "set length " + std::string(formatVal(job.length, MAX_LENGTH).c_str()));
+    send(machine, "set radius " + std::string(formatVal(job.radius, MAX_RADIUS).c_str()));
+    send(machine, "set inductance " + std::string(formatVal(job.inductance, MAX_INDUCTANCE).c_str()));
+    send(machine, "set gauge " + std::string(Solenoid::gaugeString(job.gauge).c_str()));
+    send(machine, "start");
+    machine.busy = true;
+    machine.job = job;
+    machine.started = false;
+    machine.faulted = false;
+    machine.jobStart = now;
+}
+
+// Continues the job a machine was left with at power on, it is not one from the queue
+void resumeJob(Machine &machine, uint64_t now) {
+    send(machine, "resume");
+    machine.busy = true;
+    machine.job = CoilJob{0, 0, 0, 0, WireGauge::AWG18};
+    machine.started = false;
+    machine.faulted = false;
+    machine.jobStart = now;
+}
+
+bool idleState(const std::string &state) {
+    return state == "preset" || state == "edit" || state == "confirm" || state == "done";
+}
+
+// Reads "state=spin percent=37 turns=1665/4502 jobs=12 completed=11"
+bool parseStatus(const std::string &line, Machine &machine) {
+    char state[16];
+    unsigned percent = 0;
+    unsigned turns = 0;
+    unsigned target = 0;
+    unsigned jobs = 0;
+    unsigned completed = 0;
+    if (sscanf(line.c_str(), "state=%15s percent=%u turns=%u/%u jobs=%u completed=%u",
+            state, &percent, &turns, &target, &jobs, &completed) != 6) {
+        return false;
+    }
+    machine.state = state;
+    machine.percent = percent;
+    machine.logJobs = jobs;
+    machine.logCompleted = completed;
+    return true;
+}
+
+void handleStatus(Machine &machine, std::deque<CoilJob> &queue, uint64_t now) {
+    if (machine.busy && machine.started) {
+        if (machine.state == "spin") {
+            machine.faulted = false;
+        } else if (machine.state == "fault" && !machine.faulted) {
+            machine.faulted = true;
+            machine.faults++;
+            fprintf(stderr, "%s: FAULT on job %u at %u%%, waiting for the operator\n", machine.name.c_str(), machine.job.id, machine.percent);
+        } else if (machine.state == "done") {
+            machine.busy = false;
+            machine.completed++;
+            machine.busyTime += now - machine.jobStart;
+            printf("%s: job %u done in %.1fs\n", machine.name.c_str(), machine.job.id, (now - machine.jobStart) / 1000.0);
+        } else if (idleState(machine.state)) {
+            // Aborted at the machine
+            machine.busy = false;
+            machine.busyTime += now - machine.jobStart;
+            if (machine.job.id == 0) {
+                fprintf(stderr, "%s: unfinished job aborted\n", machine.name.c_str());
+            } else {
+                queue.push_front(machine.job);
+                fprintf(stderr, "%s: job %u aborted, requeued\n", machine.name.c_str(), machine.job.id);
+            }
+        }
+    }
+
+    if (!machine.busy && machine.state == "resume") {
+        printf("%s: resuming its unfinished job\n", machine.name.c_str());
+        resumeJob(machine, now);
+        return;
+    }
+
+    if (!machine.busy && idleState(machine.state) && !queue.empty()) {
+        CoilJob job = queue.front();
+        queue.pop_front();
+        printf("%s: starting job %u\n", machine.name.c_str(), job.id);
+        startJob(machine, job, now);
+    }
+}
+
+void readMachine(Machine &machine, std::deque<CoilJob> &queue, bool verbose, uint64_t now) {
+    char buffer[512];
+    ssize_t length;
+    while ((length = read(machine.fd, buffer, sizeof(buffer))) > 0) {
+        for (ssize_t i = 0; i < length; i++) {
+            char c = buffer[i];
+            if (c == '\r') {
+                continue;
+            }
+            if (c != '\n') {
+                machine.input += c;
+                continue;
+            }
+
+            if (verbose) {
+                printf("%s> %s\n", machine.name.c_str(), machine.input.c_str());
+            }
+            if (parseStatus(machine.input, machine)) {
+                machine.statusPending = false;
+                handleStatus(machine, queue, now);
+            } else if (machine.input.rfind("Started", 0) == 0 || machine.input.rfind("Resumed", 0) == 0) {
+                machine.started = true;
+            } else if (machine.busy && !machine.started && (machine.input.rfind("Invalid", 0) == 0 ||
+                    machine.input.rfind("No turns", 0) == 0 || machine.input.rfind("Job in progress", 0) == 0 ||
+                    machine.input.rfind("Nothing to resume", 0) == 0)) {
+                // Dropped, the same values would be refused again
+                machine.busy = false;
+                fprintf(stderr, "%s: job %u refused: %s\n", machine.name.c_str(), machine.job.id, machine.input.c_str());
+            }
+            machine.input.clear();
+        }
+    }
+}
+
+bool loadJobs(const char *path, std::deque<CoilJob> &queue) {
+    FILE *file = fopen(path, "r");
+    if (file == nullptr) {
+        perror(path);
+        return false;
+    }
+
+    char line[256];
+    uint32_t number = 0;
+    uint32_t id = 1;
+    Solenoid check = Solenoid();
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        number++;
+        char length[16], radius[16], inductance[16], gauge[16];
+        unsigned count = 1;
+        if (line[0] == '#' || sscanf(line, "%15s", length) != 1) {
+            continue;
+        }
+        int fields = sscanf(line, "%15s %15s %15s %15s %u", length, radius, inductance, gauge, &count);
+
+        CoilJob job = {0, 0, 0, 0, WireGauge::AWG24};
+        bool ok = fields >= 4 &&
+            parseVal(String(length), job.length) && check.setLength(job.length) == SolenoidError::NO_ERROR &&
+            parseVal(String(radius), job.radius) && check.setRadius(job.radius) == SolenoidError::NO_ERROR &&
+            parseVal(String(inductance), job.inductance) && check.setInductance(job.inductance) == SolenoidError::NO_ERROR;
+        if (!ok || !WireTable::find(gauge, job.gauge) || check.getTurns() == 0) {
+            fprintf(stderr, "%s:%u: bad job, expected <length cm> <radius cm> <inductance mH> <gauge> [count]\n", path, number);
+            fclose(file);
+            return false;
+        }
+        for (unsigned i = 0; i < count; i++) {
+            job.id = id++;
+            queue.push_back(job);
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+volatile sig_atomic_t interrupted = 0;
+
+void onInterrupt(int signal) {
+    interrupted = 1;
+}
+
+void report(const std::vector<Machine> &machines, const std::deque<CoilJob> &queue, uint64_t elapsed) {
+    uint32_t running = 0;
+    uint32_t completed = 0;
+    uint32_t faulted = 0;
+    for (const Machine &machine : machines) {
+        running += machine.busy ? 1 : 0;
+        completed += machine.completed;
+        faulted += machine.busy && machine.faulted ? 1 : 0;
+    }
+    printf("[%.0fs] queued %zu, running %u, faulted %u, completed %u\n",
+        elapsed / 1000.0, queue.size(), running, faulted, completed);
+}
+
+void summary(const std::vector<Machine> &machines, uint64_t elapsed, double speed) {
+    printf("\nmachine,completed,faults,utilization_pct,log_jobs,log_completed\n");
+    uint32_t completed = 0;
+    for (const Machine &machine : machines) {
+        completed += machine.completed;
+        printf("%s,%u,%u,%.1f,%u,%u\n",
+            machine.name.c_str(),
+            machine.completed,
+            machine.faults,
+            elapsed > 0 ? machine.busyTime * 100.0 / elapsed : 0,
+            machine.logJobs,
+            machine.logCompleted);
+    }
+    // Machine time is wall time for real ports, scaled for simulated ones
+    double hours = elapsed * speed / 3600000.0;
+    printf("\n%u coils in %.1f min of machine time, %.1f coils/h over %zu machines\n",
+        completed, elapsed * speed / 60000.0, hours > 0 ? completed / hours : 0, machines.size());
+}
+
+int usage(const char *name) {
+    fprintf(stderr, "Usage: %s --jobs <file> [--port <device>]... [--sim <count>] [--speed <factor>] [--verbose]\n", name);
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    const char *jobsPath = nullptr;
+    std::vector<const char *> ports;
+    uint32_t simulated = 0;
+    double speed = 1;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--verbose") == 0) {
+            verbose = true;
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobsPath = argv[++i];
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            ports.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "--sim") == 0 && i + 1 < argc) {
+            simulated = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            speed = atof(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (jobsPath == nullptr || (ports.empty() && simulated == 0) || speed <= 0) {
+        return usage(argv[0]);
+    }
+    if (!ports.empty() && simulated > 0 && speed != 1) {
+        fprintf(stderr, "--speed only works with simulated machines alone\n");
+        return 1;
+    }
+
+    std::deque<CoilJob> queue;
+    if (!loadJobs(jobsPath, queue)) {
+        return 1;
+    }
+
+    // Progress lines as they happen, also when logged to a file
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, onInterrupt);
+    std::vector<Machine> machines;
+    for (const char *port : ports) {
+        if (!addPort(machines, port)) {
+            return 1;
+        }
+    }
+    for (uint32_t i = 0; i < simulated; i++) {
+        if (!addSimulated(machines, speed)) {
+            return 1;
+        }
+    }
+    printf("%zu jobs on %zu machines\n", queue.size(), machines.size());
+
+    const uint64_t start = wallMillis();
+    uint64_t lastReport = start;
+    std::vector<struct pollfd> fds(machines.size());
+    while (!interrupted) {
+        uint64_t now = wallMillis();
+
+        // Done once nothing is queued or running and every machine answered at least once
+        bool finished = queue.empty();
+        for (const Machine &machine : machines) {
+            finished = finished && !machine.busy && !machine.state.empty();
+        }
+        if (finished) {
+            break;
+        }
+
+        for (size_t i = 0; i < machines.size(); i++) {
+            Machine &machine = machines[i];
+            if (!machine.statusPending && now - machine.lastStatus >= STATUS_INTERVAL) {
+                send(machine, "status");
+                machine.statusPending = true;
+                machine.lastStatus = now;
+            }
+            fds[i].fd = machine.fd;
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+        }
+
+        poll(fds.data(), fds.size(), 50);
+        now = wallMillis();
+        for (size_t i = 0; i < machines.size(); i++) {
+            if (fds[i].revents & (POLLIN | POLLHUP)) {
+                readMachine(machines[i], queue, verbose, now);
+            }
+        }
+
+        if (now - lastReport >= REPORT_INTERVAL) {
+            report(machines, queue, now - start);
+            lastReport = now;
+        }
+    }
+
+    summary(machines, wallMillis() - start, speed);
+
+    // Simulated machines exit when their socket closes
+    for (Machine &machine : machines) {
+        close(machine.fd);
+        if (machine.pid > 0) {
+            waitpid(machine.pid, nullptr, 0);
+        }
+    }
+    return interrupted ? 1 : 0;
+}
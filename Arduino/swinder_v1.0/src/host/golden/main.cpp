@@ -0,0 +1,558 @@
+/*
+Golden step trace harness
+Runs the real firmware (src/main.cpp) on the host core, operates it through scripted
+encoder, button and serial input, and records every STEP and carriage DIR edge with the
+simulated time as a step trace. Each trace is compared to golden/<job>.bin.
+
+Usage: golden [--update] [--job <name>] [--dir <path>] [--tolerance <percent>] [--motors <file|default>] [--verbose]
+  --update       record the goldens again instead of comparing
+  --job <name>   run one job only
+  --dir <path>   golden trace directory, default golden
+  --tolerance    allowed change of the job time and the peak step rates, default 1
+  --motors       drive stepper models with the firmware's steps, a missed step fails the job,
+                 parameters from a file as for ramp or the built-in ones
+  --verbose      show the firmware serial output
+
+Turn counts, the step sequence, reversal points and the final carriage position must
+match exactly. A failed run keeps its trace as <job>.run.bin for trace2csv.
+*/
+#include <Arduino.h>
+#include <Machine.hpp>
+#include <HostMachine.hpp>
+#include <StepperModel.hpp>
+#include <StepTrace.hpp>
+#include <FileTraceSink.hpp>
+#include <LiquidCrystal_I2C.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define CARRIAGE_START 1000 // 0.001cm from the start limit switch at power on
+#define ACTION_GAP 300000 // us between scripted inputs, longer than the button lockouts
+#define PRESS_TIME 100000 // us the button is held
+#define JOB_TIMEOUT (4ULL * 3600 * 1000000) // us of simulated time
+
+// Firmware entry points
+void setup();
+void loop();
+extern LiquidCrystal_I2C lcd;
+
+enum ActionType {
+    ACTION_END = 0, // Job done, stop the firmware
+    ACTION_PRESS = 1,
+    ACTION_TURN = 2, // Encoder detents, negative turns back
+    ACTION_FEED = 3, // Serial input
+    ACTION_WAIT = 4, // Until the text is on the display
+};
+
+struct Action {
+    ActionType type;
+    int32_t detents;
+    const char *text;
+};
+
+struct GoldenJob {
+    const char *name;
+    const Action *actions;
+};
+
+// Jobs, each starts from power on
+const Action presetD[] = {
+    {ActionType::ACTION_WAIT, 0, "Presets:"},
+    {ActionType::ACTION_TURN, 3, nullptr},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_TURN, 5, nullptr}, // Confirm field
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Begin Process?"},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Completed!"},
+    {ActionType::ACTION_END, 0, nullptr},
+};
+
+// Few turns per pass, so most of the job is reversals
+const Action thickWire[] = {
+    {ActionType::ACTION_WAIT, 0, "Presets:"},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Length (cm)"},
+    {ActionType::ACTION_FEED, 0, "set length 0.50\nset radius 0.50\nset inductance 0.10\nset gauge AWG18\n"},
+    {ActionType::ACTION_TURN, 5, nullptr},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Begin Process?"},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Completed!"},
+    {ActionType::ACTION_END, 0, nullptr},
+};
+
+// Pause halfway and resume
+const Action pauseResume[] = {
+    {ActionType::ACTION_WAIT, 0, "Presets:"},
+    {ActionType::ACTION_TURN, 3, nullptr},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_TURN, 5, nullptr},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Begin Process?"},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "50%"},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Paused"},
+    {ActionType::ACTION_PRESS, 0, nullptr}, // Resume
+    {ActionType::ACTION_WAIT, 0, "Completed!"},
+    {ActionType::ACTION_END, 0, nullptr},
+};
+
+// Thick wire again with the odd layers nested half a pitch in
+const Action orthocyclic[] = {
+    {ActionType::ACTION_WAIT, 0, "Presets:"},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Length (cm)"},
+    {ActionType::ACTION_FEED, 0, "set length 0.50\nset radius 0.50\nset inductance 0.10\nset gauge AWG18\nset pattern orthocyclic\n"},
+    {ActionType::ACTION_TURN, 5, nullptr},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Begin Process?"},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Completed!"},
+    {ActionType::ACTION_END, 0, nullptr},
+};
+
+// Three coils on one mandrel, the carriage moves between them without homing
+const Action multiSection[] = {
+    {ActionType::ACTION_WAIT, 0, "Presets:"},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Length (cm)"},
+    {ActionType::ACTION_FEED, 0, "section add 0.00 0.50 20 AWG18\nsection add 1.00 0.50 15 AWG24\nsection add 1.80 0.20 10 AWG18\n"},
+    {ActionType::ACTION_TURN, 5, nullptr},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Begin Process?"},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Completed!"},
+    {ActionType::ACTION_END, 0, nullptr},
+};
+
+// Thick wire twice, the second coil starts from where the first left the carriage
+const Action backToBack[] = {
+    {ActionType::ACTION_WAIT, 0, "Presets:"},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Length (cm)"},
+    {ActionType::ACTION_FEED, 0, "set length 0.50\nset radius 0.50\nset inductance 0.10\nset gauge AWG18\n"},
+    {ActionType::ACTION_TURN, 5, nullptr},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Begin Process?"},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Completed!"},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Length (cm)"},
+    {ActionType::ACTION_TURN, 5, nullptr},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Begin Process?"},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Completed!"},
+    {ActionType::ACTION_END, 0, nullptr},
+};
+
+// Preset D with the SS rate scheduled, faster mid-pass and slow at the reversals
+const Action speedProfile[] = {
+    {ActionType::ACTION_WAIT, 0, "Presets:"},
+    {ActionType::ACTION_FEED, 0, "speed on\n"},
+    {ActionType::ACTION_TURN, 3, nullptr},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_TURN, 5, nullptr},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Begin Process?"},
+    {ActionType::ACTION_PRESS, 0, nullptr},
+    {ActionType::ACTION_WAIT, 0, "Completed!"},
+    {ActionType::ACTION_END, 0, nullptr},
+};
+
+const GoldenJob JOBS[] = {
+    {"preset_d", presetD},
+    {"thick_wire", thickWire},
+    {"pause_resume", pauseResume},
+    {"orthocyclic", orthocyclic},
+    {"multi_section", multiSection},
+    {"back_to_back", backToBack},
+    {"speed_profile", speedProfile},
+};
+#define JOB_COUNT (sizeof(JOBS) / sizeof(JOBS[0]))
+
+// Thrown from the clock hook to leave the firmware loop
+struct ScriptStop {
+    bool timedOut;
+};
+
+struct Options {
+    bool update;
+    const char *job;
+    std::string dir;
+    double tolerance; // percent
+    const char *motors; // parameter file, "default" or nullptr for no models
+    bool verbose;
+};
+
+// Simulation state of the running job
+const Action *script = nullptr;
+uint64_t nextAction = 0; // us
+uint64_t releaseAt = 0; // us, 0 when the button is up
+StepTrace trace = StepTrace();
+StepperModel ssModel = StepperModel();
+StepperModel ccModel = StepperModel();
+uint8_t pendingSteps = 0;
+uint32_t pendingTime = 0;
+
+// Drives the inputs, one action per ACTION_GAP
+void runScript(uint64_t now) {
+    if (releaseAt != 0 && now >= releaseAt) {
+        HostArduino::setPin(RE_BUTTON_PIN, HIGH);
+        releaseAt = 0;
+    }
+    if (now >= JOB_TIMEOUT) {
+        throw ScriptStop{true};
+    }
+    if (now < nextAction) {
+        return;
+    }
+
+    const Action &action = *script;
+    switch (action.type) {
+        case ActionType::ACTION_END:
+            throw ScriptStop{false};
+        case ActionType::ACTION_PRESS:
+            HostArduino::setPin(RE_BUTTON_PIN, LOW);
+            releaseAt = now + PRESS_TIME;
+            break;
+        case ActionType::ACTION_TURN:
+            HostMachine::turn(action.detents);
+            break;
+        case ActionType::ACTION_FEED:
+            Serial.feed(action.text);
+            break;
+        case ActionType::ACTION_WAIT:
+            if (strstr(lcd.row(0).c_str(), action.text) == nullptr && strstr(lcd.row(1).c_str(), action.text) == nullptr) {
+                return;
+            }
+            break;
+    }
+    script++;
+    nextAction = now + ACTION_GAP;
+}
+
+void flushSteps() {
+    if (pendingSteps != 0) {
+        trace.step(pendingSteps, pendingTime);
+        trace.service();
+        pendingSteps = 0;
+    }
+}
+
+// Records STEP rising edges and carriage DIR changes
+void recordEdge(uint8_t pin, uint8_t value, uint64_t time) {
+    if (pin == CC_DIR_PIN) {
+        flushSteps();
+        trace.direction(value == CC_DIR_SET, HostMachine::carriage(), time);
+        trace.service();
+        return;
+    }
+    if ((pin != SS_STEP_PIN && pin != CC_STEP_PIN) || value != HIGH) {
+        return;
+    }
+
+    // Both STEP pins rising at the same time is one event
+    uint8_t motor = pin == SS_STEP_PIN ? TRACE_SS : TRACE_CC;
+    if (pendingSteps != 0 && pendingTime != (uint32_t) time) {
+        flushSteps();
+    }
+    pendingSteps |= motor;
+    pendingTime = time;
+}
+
+// Runs the firmware through a job script, returns false on a timeout
+bool record(const GoldenJob &job, const char *path, bool motors) {
+    FileTraceSink sink = FileTraceSink(path);
+    trace.begin(sink);
+    if (!trace.start(0)) {
+        fprintf(stderr, "%s: cannot write %s\n", job.name, path);
+        return false;
+    }
+    HostMachine::begin(CARRIAGE_START, recordEdge);
+    if (motors) {
+        HostMachine::attachMotors(&ssModel, &ccModel);
+    }
+    trace.mark(TraceMark::MARK_JOB_START, 0);
+    trace.direction(digitalRead(CC_DIR_PIN) == CC_DIR_SET, HostMachine::carriage(), 0);
+
+    script = job.actions;
+    HostArduino::onAdvance(runScript);
+    bool timedOut = false;
+    try {
+        setup();
+        while (true) {
+            loop();
+        }
+    } catch (const ScriptStop &stop) {
+        timedOut = stop.timedOut;
+    }
+    HostArduino::onWrite(nullptr);
+    HostArduino::onAdvance(nullptr);
+
+    flushSteps();
+    trace.mark(TraceMark::MARK_JOB_END, HostArduino::now());
+    trace.stop();
+    ssModel.update(HostArduino::now());
+    ccModel.update(HostArduino::now());
+    if (timedOut) {
+        fprintf(stderr, "%s: timed out waiting for \"%s\"\n", job.name, script->text != nullptr ? script->text : "");
+    }
+    return !timedOut;
+}
+
+// What a trace says about the coil
+struct Summary {
+    uint32_t ssSteps;
+    uint32_t ccSteps;
+    int32_t finalPosition; // 0.001cm from the start switch
+    std::vector<int32_t> reversals; // positions of the direction changes
+    uint64_t duration; // us
+    uint64_t minSsInterval; // us
+    uint64_t minCcInterval;
+};
+
+bool load(const char *path, std::vector<TraceEvent> &events) {
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    StepTraceReader reader = StepTraceReader();
+    uint8_t block[TRACE_BLOCK_SIZE];
+    TraceEvent event;
+    events.clear();
+    while (fread(block, 1, TRACE_BLOCK_SIZE, file) == TRACE_BLOCK_SIZE) {
+        if (!reader.load(block)) {
+            continue;
+        }
+        while (reader.next(event)) {
+            events.push_back(event);
+        }
+    }
+    fclose(file);
+    return reader.dropped() == 0 && reader.missingBlocks() == 0;
+}
+
+Summary summarize(const std::vector<TraceEvent> &events) {
+    Summary summary = {0, 0, 0, {}, 0, UINT64_MAX, UINT64_MAX};
+    int32_t position = 0;
+    bool forward = true;
+    uint64_t lastSs = 0;
+    uint64_t lastCc = 0;
+    bool initial = true; // The first DIR event is the direction at power on
+    for (const TraceEvent &event : events) {
+        if (event.type == TraceEventType::TRACE_DIR) {
+            if (!initial) {
+                summary.reversals.push_back(event.value);
+            }
+            initial = false;
+            position = event.value;
+            forward = event.flags & 1;
+        } else if (event.type == TraceEventType::TRACE_STEP) {
+            if (event.flags & TRACE_SS) {
+                if (summary.ssSteps > 0 && event.time - lastSs < summary.minSsInterval) {
+                    summary.minSsInterval = event.time - lastSs;
+                }
+                summary.ssSteps++;
+                lastSs = event.time;
+            }
+            if (event.flags & TRACE_CC) {
+                if (summary.ccSteps > 0 && event.time - lastCc < summary.minCcInterval) {
+                    summary.minCcInterval = event.time - lastCc;
+                }
+                summary.ccSteps++;
+                lastCc = event.time;
+                position += forward ? DISTANCE_PER_STEP : -DISTANCE_PER_STEP;
+            }
+        }
+        summary.duration = event.time;
+    }
+    summary.finalPosition = position;
+    return summary;
+}
+
+bool withinTolerance(const char *job, const char *what, double expected, double actual, double tolerance) {
+    if (expected == actual || fabs(actual - expected) <= fabs(expected) * tolerance / 100) {
+        return true;
+    }
+    fprintf(stderr, "%s: %s %.0f, golden %.0f (%+.2f%%)\n", job, what, actual, expected, (actual - expected) * 100 / expected);
+    return false;
+}
+
+// Geometry has to match exactly, timing within the tolerance
+bool compare(const char *job, const std::vector<TraceEvent> &golden, const std::vector<TraceEvent> &run, double tolerance) {
+    Summary expected = summarize(golden);
+    Summary actual = summarize(run);
+    bool ok = true;
+
+    if (actual.ssSteps != expected.ssSteps) {
+        fprintf(stderr, "%s: %.2f turns, golden %.2f\n", job,
+            (double) actual.ssSteps / SS_STEPS_PER_REVOLUTION, (double) expected.ssSteps / SS_STEPS_PER_REVOLUTION);
+        ok = false;
+    }
+    if (actual.ccSteps != expected.ccSteps) {
+        fprintf(stderr, "%s: %u carriage steps, golden %u\n", job, actual.ccSteps, expected.ccSteps);
+        ok = false;
+    }
+    if (actual.finalPosition != expected.finalPosition) {
+        fprintf(stderr, "%s: carriage ends at %.3fcm, golden %.3fcm\n", job, actual.finalPosition / 1000.0, expected.finalPosition / 1000.0);
+        ok = false;
+    }
+    if (actual.reversals != expected.reversals) {
+        size_t i = 0;
+        while (i < actual.reversals.size() && i < expected.reversals.size() && actual.reversals[i] == expected.reversals[i]) {
+            i++;
+        }
+        fprintf(stderr, "%s: %zu reversals, golden %zu, first difference at reversal %zu\n", job,
+            actual.reversals.size(), expected.reversals.size(), i + 1);
+        ok = false;
+    }
+
+    // Step order: which motors step, in which direction, SS step by SS step
+    size_t count = golden.size() < run.size() ? golden.size() : run.size();
+    uint32_t ssSteps = 0;
+    for (size_t i = 0; i < count; i++) {
+        const TraceEvent &a = golden[i];
+        const TraceEvent &b = run[i];
+        if (a.type != b.type || a.flags != b.flags || a.value != b.value) {
+            fprintf(stderr, "%s: step sequence differs at event %zu (SS step %u, %.3fs)\n", job, i, ssSteps, b.time * 1e-6);
+            ok = false;
+            break;
+        }
+        if (a.type == TraceEventType::TRACE_STEP && (a.flags & TRACE_SS)) {
+            ssSteps++;
+        }
+    }
+
+    ok = withinTolerance(job, "job time us", expected.duration, actual.duration, tolerance) && ok;
+    ok = withinTolerance(job, "shortest SS step interval us", expected.minSsInterval, actual.minSsInterval, tolerance) && ok;
+    ok = withinTolerance(job, "shortest CC step interval us", expected.minCcInterval, actual.minCcInterval, tolerance) && ok;
+    return ok;
+}
+
+// Prints how close a motor came to slipping, returns false if it missed steps
+bool reportMotor(const char *job, const char *name, const StepperModel &model) {
+    fprintf(stderr, "%s: %s peak load angle %.1f deg at %.3fs", job, name, model.peakLoadAngle(), model.peakTime() * 1e-6);
+    if (model.missedSteps() == 0) {
+        fprintf(stderr, ", no missed steps\n");
+        return true;
+    }
+    fprintf(stderr, ", %llu missed steps from %.3fs\n", (unsigned long long) model.missedSteps(), model.firstMiss() * 1e-6);
+    return false;
+}
+
+// Runs in a fresh process, the firmware globals cannot be reset
+int runJob(const GoldenJob &job, const Options &options) {
+    if (!options.verbose) {
+        freopen("/dev/null", "w", stdout);
+    }
+
+    bool motors = options.motors != nullptr;
+    if (motors) {
+        MotorParams ss = StepperModel::spindle();
+        MotorParams cc = StepperModel::carriage();
+        if (strcmp(options.motors, "default") != 0 && !StepperModel::load(options.motors, ss, cc)) {
+            return 1;
+        }
+        ssModel.begin(ss);
+        ccModel.begin(cc);
+    }
+
+    std::string golden = options.dir + "/" + job.name + ".bin";
+    std::string run = options.dir + "/" + job.name + ".run.bin";
+    if (!record(job, options.update ? golden.c_str() : run.c_str(), motors)) {
+        return 1;
+    }
+    if (motors) {
+        bool ssOk = reportMotor(job.name, "SS", ssModel);
+        bool ccOk = reportMotor(job.name, "CC", ccModel);
+        if (!ssOk || !ccOk) {
+            fprintf(stderr, "%s: FAIL, the machine would miss steps\n", job.name);
+            return 1;
+        }
+    }
+
+    if (options.update) {
+        std::vector<TraceEvent> events;
+        load(golden.c_str(), events);
+        Summary summary = summarize(events);
+        fprintf(stderr, "%s: recorded %.2f turns, %zu reversals, %.1fs\n", job.name,
+            (double) summary.ssSteps / SS_STEPS_PER_REVOLUTION, summary.reversals.size(), summary.duration * 1e-6);
+        return 0;
+    }
+
+    std::vector<TraceEvent> expected;
+    std::vector<TraceEvent> actual;
+    if (!load(golden.c_str(), expected)) {
+        fprintf(stderr, "%s: no usable golden trace %s, record it with --update\n", job.name, golden.c_str());
+        return 1;
+    }
+    load(run.c_str(), actual);
+    if (!compare(job.name, expected, actual, options.tolerance)) {
+        fprintf(stderr, "%s: FAIL, trace kept as %s\n", job.name, run.c_str());
+        return 1;
+    }
+    remove(run.c_str());
+    fprintf(stderr, "%s: ok\n", job.name);
+    return 0;
+}
+
+int usage(const char *name) {
+    fprintf(stderr, "Usage: %s [--update] [--job <name>] [--dir <path>] [--tolerance <percent>] [--motors <file|default>] [--verbose]\n", name);
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    Options options = {false, nullptr, "golden", 1.0, nullptr, false};
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--update") == 0) {
+            options.update = true;
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            options.verbose = true;
+        } else if (strcmp(argv[i], "--job") == 0 && i + 1 < argc) {
+            options.job = argv[++i];
+        } else if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc) {
+            options.dir = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            options.tolerance = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--motors") == 0 && i + 1 < argc) {
+            options.motors = argv[++i];
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    uint32_t ran = 0;
+    uint32_t failed = 0;
+    for (size_t i = 0; i < JOB_COUNT; i++) {
+        if (options.job != nullptr && strcmp(options.job, JOBS[i].name) != 0) {
+            continue;
+        }
+        fflush(stdout);
+        fflush(stderr);
+        pid_t pid = fork();
+        if (pid == 0) {
+            exit(runJob(JOBS[i], options));
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failed++;
+        }
+        ran++;
+    }
+
+    if (ran == 0) {
+        fprintf(stderr, "No job named %s\n", options.job);
+        return 1;
+    }
+    fprintf(stderr, "%u of %u jobs match\n", ran - failed, ran);
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,269 @@
+/*
+Coil design optimizer
+Searches mandrel radius, length and gauge for a target inductance with the same
+Solenoid math the firmware winds with, and ranks the designs by wind time, then wire use.
+Layers follow from the turns, Solenoid::turnsPerPass() and the layer pattern.
+Pitch and layer height use the overall diameter of the enamel grade, resistance the copper.
+
+Usage: optimize --inductance <mH> --radius <cm>[,<cm>...] [options]
+  --length <min>:<max>   length range in cm, default 0.50:20.00
+  --step <cm>            length step, default 0.05
+  --max-layers <n>       default 20
+  --max-resistance <ohm> no limit by default
+  --max-outer <cm>       largest outer radius of the winding, no limit by default
+  --pattern <name>       layer pattern, helical, orthocyclic or progressive, default helical
+  --grade <1|2>          enamel grade of the wire, default 2
+  --top <n>              designs listed, default 10
+  --preset <rank>        design printed as console commands, default 1
+  --threads <n>          default all cores
+
+The preset is printed as `set` console commands, paste it into the serial console.
+*/
+#include <Arduino.h>
+#include <Solenoid.hpp>
+#include <Format.hpp>
+#include <Machine.hpp>
+#include <WindKernel.hpp>
+#include <WindPattern.hpp>
+#include <WireTable.hpp>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#define COPPER_RESISTIVITY 1.72e-8 // ohm m at 20C
+#define MAX_RADII 16
+
+struct Limits {
+    uint32_t inductance; // 0.01mH
+    uint32_t radii[MAX_RADII]; // 0.01cm
+    uint8_t radiusCount;
+    uint32_t lengthMin; // 0.01cm
+    uint32_t lengthMax;
+    uint32_t lengthStep;
+    uint32_t maxLayers;
+    double maxResistance; // ohm, 0 for no limit
+    uint32_t maxOuter; // 0.01cm, 0 for no limit
+    WindPattern pattern;
+    WireTable wires;
+};
+
+struct Design {
+    uint32_t length; // 0.01cm
+    uint32_t radius; // 0.01cm
+    WireGauge gauge;
+    uint32_t turns;
+    uint32_t layers;
+    double outerRadius; // m
+    double wireLength; // m
+    double resistance; // ohm
+    double windTime; // s
+};
+
+// Evaluates one grid point, returns false if it breaks a limit
+bool evaluate(Solenoid &solenoid, const Limits &limits, uint32_t radius, uint32_t length, WireGauge gauge, Design &design) {
+    solenoid.setLength(length);
+    solenoid.setRadius(radius);
+    solenoid.setInductance(limits.inductance);
+    solenoid.setGauge(gauge);
+
+    uint32_t turns = solenoid.getTurns();
+    uint32_t perPass = solenoid.turnsPerPass(limits.wires);
+    if (turns == 0 || perPass == 0) {
+        return false;
+    }
+
+    // Each layer sits one layer height further out, the pattern sets turns and height per layer
+    const double diameter = limits.wires.diameter(gauge) * 1e-6;
+    const double copper = WireTable::copperDiameter(gauge) * 1e-6;
+    const double inner = radius * 1e-4;
+    double wire = 0;
+    double outer = inner;
+    uint32_t remaining = turns;
+    uint32_t layers = 0;
+    while (remaining > 0) {
+        uint32_t capacity = limits.pattern.layerTurns(layers, perPass);
+        if (capacity == 0 || layers >= limits.maxLayers) {
+            return false;
+        }
+        uint32_t layerTurns = remaining < capacity ? remaining : capacity;
+        double height = limits.pattern.layerHeight(layers, limits.wires.diameter(gauge)) * 1e-6;
+        wire += layerTurns * 2 * M_PI * (outer + height - diameter / 2);
+        outer += height;
+        remaining -= layerTurns;
+        layers++;
+    }
+    const double resistance = wire * COPPER_RESISTIVITY / (M_PI * copper * copper / 4);
+    if (limits.maxOuter > 0 && outer > limits.maxOuter * 1e-4) {
+        return false;
+    }
+    if (limits.maxResistance > 0 && resistance > limits.maxResistance) {
+        return false;
+    }
+
+    // Same step count as the firmware, at the fixed step rate
+    WindKernel kernel = WindKernel();
+    kernel.begin(solenoid, limits.pattern, limits.wires);
+
+    design.length = length;
+    design.radius = radius;
+    design.gauge = gauge;
+    design.turns = turns;
+    design.layers = layers;
+    design.outerRadius = outer;
+    design.wireLength = wire;
+    design.resistance = resistance;
+    design.windTime = kernel.totalSteps() * 2.0 * MOTOR_DELAY * 1e-6;
+    return true;
+}
+
+// Worker: every threads-th point of the radius x gauge x length grid
+void search(const Limits &limits, uint32_t first, uint32_t stride, std::vector<Design> &results) {
+    Solenoid solenoid = Solenoid();
+    const uint32_t lengths = (limits.lengthMax - limits.lengthMin) / limits.lengthStep + 1;
+    const uint32_t gauges = MAX_GAUGE + 1;
+    const uint32_t total = limits.radiusCount * gauges * lengths;
+
+    Design design;
+    for (uint32_t i = first; i < total; i += stride) {
+        uint32_t radius = limits.radii[i / (gauges * lengths)];
+        WireGauge gauge = static_cast<WireGauge>((i / lengths) % gauges);
+        uint32_t length = limits.lengthMin + (i % lengths) * limits.lengthStep;
+        if (evaluate(solenoid, limits, radius, length, gauge, design)) {
+            results.push_back(design);
+        }
+    }
+}
+
+bool parseArg(const char *text, uint32_t &value) {
+    return parseVal(String(text), value);
+}
+
+int usage(const char *name) {
+    fprintf(stderr, "Usage: %s --inductance <mH> --radius <cm>[,<cm>...] [--length <min>:<max>] [--step <cm>]\n", name);
+    fprintf(stderr, "       [--max-layers <n>] [--max-resistance <ohm>] [--max-outer <cm>] [--pattern <name>] [--grade <1|2>] [--top <n>] [--preset <rank>] [--threads <n>]\n");
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    Limits limits = {0, {0}, 0, 50, MAX_LENGTH, 5, 20, 0, 0, WindPattern(), WireTable()};
+    uint32_t top = 10;
+    uint32_t preset = 1;
+    uint32_t threads = std::thread::hardware_concurrency();
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char *key = argv[i];
+        const char *value = argv[i + 1];
+        bool ok = true;
+        if (strcmp(key, "--inductance") == 0) {
+            ok = parseArg(value, limits.inductance) && limits.inductance <= MAX_INDUCTANCE;
+        } else if (strcmp(key, "--radius") == 0) {
+            String list = String(value) + ",";
+            int start = 0;
+            int comma;
+            while ((comma = list.indexOf(',', start)) >= 0 && ok) {
+                ok = limits.radiusCount < MAX_RADII && parseArg(list.substring(start, comma).c_str(), limits.radii[limits.radiusCount]);
+                ok = ok && limits.radii[limits.radiusCount] > 0 && limits.radii[limits.radiusCount] <= MAX_RADIUS;
+                limits.radiusCount++;
+                start = comma + 1;
+            }
+        } else if (strcmp(key, "--length") == 0) {
+            String range = String(value);
+            int colon = range.indexOf(':');
+            ok = colon > 0 && parseArg(range.substring(0, colon).c_str(), limits.lengthMin) &&
+                parseArg(range.substring(colon + 1).c_str(), limits.lengthMax);
+        } else if (strcmp(key, "--step") == 0) {
+            ok = parseArg(value, limits.lengthStep) && limits.lengthStep > 0;
+        } else if (strcmp(key, "--max-layers") == 0) {
+            limits.maxLayers = atoi(value);
+        } else if (strcmp(key, "--max-resistance") == 0) {
+            limits.maxResistance = atof(value);
+        } else if (strcmp(key, "--max-outer") == 0) {
+            ok = parseArg(value, limits.maxOuter);
+        } else if (strcmp(key, "--pattern") == 0) {
+            PatternType type;
+            ok = WindPattern::find(value, type) && limits.pattern.setType(type);
+        } else if (strcmp(key, "--grade") == 0) {
+            ok = limits.wires.setGrade(static_cast<WireGrade>(atoi(value)));
+        } else if (strcmp(key, "--top") == 0) {
+            top = atoi(value);
+        } else if (strcmp(key, "--preset") == 0) {
+            preset = atoi(value);
+        } else if (strcmp(key, "--threads") == 0) {
+            threads = atoi(value);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            fprintf(stderr, "Bad argument: %s %s\n", key, value);
+            return usage(argv[0]);
+        }
+    }
+    if (limits.inductance == 0 || limits.radiusCount == 0) {
+        return usage(argv[0]);
+    }
+    if (limits.lengthMax > MAX_LENGTH) {
+        limits.lengthMax = MAX_LENGTH;
+    }
+    if (limits.lengthMin == 0 || limits.lengthMin > limits.lengthMax) {
+        fprintf(stderr, "Bad length range\n");
+        return 1;
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    // Evaluate the grid on all cores
+    std::vector<std::vector<Design>> partial(threads);
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threads; t++) {
+        workers.emplace_back(search, std::cref(limits), t, threads, std::ref(partial[t]));
+    }
+    std::vector<Design> designs;
+    for (uint32_t t = 0; t < threads; t++) {
+        workers[t].join();
+        designs.insert(designs.end(), partial[t].begin(), partial[t].end());
+    }
+
+    std::sort(designs.begin(), designs.end(), [](const Design &a, const Design &b) {
+        if (a.windTime != b.windTime) {
+            return a.windTime < b.windTime;
+        }
+        return a.wireLength < b.wireLength;
+    });
+
+    fprintf(stderr, "%zu designs meet the limits, %u threads\n", designs.size(), threads);
+    if (designs.empty()) {
+        return 2;
+    }
+
+    printf("rank,length_cm,radius_cm,gauge,turns,layers,outer_cm,wire_m,resistance_ohm,wind_s\n");
+    for (uint32_t i = 0; i < top && i < designs.size(); i++) {
+        const Design &d = designs[i];
+        printf("%u,%s,%s,%s,%u,%u,%.3f,%.2f,%.3f,%.0f\n",
+            i + 1,
+            formatVal(d.length, MAX_LENGTH).c_str(),
+            formatVal(d.radius, MAX_RADIUS).c_str(),
+            Solenoid::gaugeString(d.gauge).c_str(),
+            d.turns,
+            d.layers,
+            d.outerRadius * 100,
+            d.wireLength,
+            d.resistance,
+            d.windTime);
+    }
+
+    // Console commands for the chosen design
+    if (preset >= 1 && preset <= designs.size()) {
+        const Design &d = designs[preset - 1];
+        printf("\n# Preset for rank %u\n", preset);
+        printf("set length %s\n", formatVal(d.length, MAX_LENGTH).c_str());
+        printf("set radius %s\n", formatVal(d.radius, MAX_RADIUS).c_str());
+        printf("set inductance %s\n", formatVal(limits.inductance, MAX_INDUCTANCE).c_str());
+        printf("set gauge %s\n", Solenoid::gaugeString(d.gauge).c_str());
+    }
+    return 0;
+}
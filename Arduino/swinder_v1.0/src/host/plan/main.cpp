@@ -0,0 +1,361 @@
+/*
+Job planner
+Runs the firmware's WindKernel for a job at the firmware step timing and reports the
+total time, the time of every carriage pass (layer), the peak step rates, the
+reversals and the wire the job takes, without a machine attached.
+
+Usage: plan --preset <A-D> | --length <cm> --radius <cm> --inductance <mH> --gauge <name> | --section ... [options]
+  --section <offset cm>,<length cm>,<turns>,<gauge>
+                         one coil of a multi-section job, repeat in order along the mandrel
+  --pattern <name>       layer pattern, helical, orthocyclic, progressive or custom, default helical
+  --pitches <p>[,<p>...] custom pattern pitch per layer, percent of the wire pitch
+  --grade <1|2>          enamel grade of the wire, default 2
+  --step-delay <us>      half period of an SS step, default MOTOR_DELAY
+  --ss-start <steps/s>   largest SS speed change taken without a ramp, default 1000
+  --cc-start <steps/s>   largest CC speed change taken without a ramp, default 500
+  --ss-accel <steps/s2>  SS acceleration limit, default 2000
+  --cc-accel <steps/s2>  CC acceleration limit, default 4000
+  --profile              schedule the SS rate by layer radius and carriage position, as speed on
+  --layers               print the pass schedule as CSV
+
+The firmware steps at a fixed rate with no ramps, so every start, pause and carriage
+reversal is a step change in speed. With --profile the rate follows SpeedProfile, a pause
+can still stop the spindle at its peak rate. The plan is flagged unsafe, exit code 3, when a
+change is larger than the start limits, with the ramp the acceleration limit would need.
+*/
+#include <Arduino.h>
+#include <Solenoid.hpp>
+#include <Format.hpp>
+#include <Machine.hpp>
+#include <WindKernel.hpp>
+#include <WindPattern.hpp>
+#include <Sections.hpp>
+#include <JobEstimate.hpp>
+#include <SpeedProfile.hpp>
+#include <WireTable.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#define DEFAULT_SS_START 1000 // steps/s, pull-in rate of the spindle stepper with a light mandrel
+#define DEFAULT_CC_START 500
+#define DEFAULT_SS_ACCEL 2000 // steps/s2
+#define DEFAULT_CC_ACCEL 4000
+
+struct Kinematics {
+    uint32_t stepDelay; // us
+    uint32_t ssStart; // steps/s
+    uint32_t ccStart;
+    uint32_t ssAccel; // steps/s2
+    uint32_t ccAccel;
+    bool profile; // SS rate from SpeedProfile instead of the step delay
+};
+
+// One carriage pass between reversals
+struct Pass {
+    uint32_t ssSteps;
+    uint32_t ccSteps;
+    uint64_t start; // us
+    uint64_t time; // us
+    int32_t from; // 0.001cm
+    int32_t to;
+    uint64_t minSsInterval; // us
+};
+
+struct Plan {
+    std::vector<Pass> passes;
+    uint64_t time; // us
+    uint32_t ssSteps;
+    uint32_t ccSteps;
+    uint32_t reversals;
+    uint64_t minSsInterval; // us between SS steps
+    uint64_t minCcInterval; // us between CC steps
+    uint64_t minReversalInterval; // us between the last CC step of a pass and the first of the next
+    uint32_t wire; // mm, as estimated on the spin screen
+};
+
+// Steps the kernel through the whole job, one step every 2 step delays like stepSS(), stepBoth() and stepCC()
+// or every SS step at the rate of the speed profile
+void simulate(Solenoid &solenoid, const Sections &sections, const WindPattern &pattern, const WireTable &wires, const Kinematics &kinematics, Plan &plan) {
+    WindKernel kernel = WindKernel();
+    if (sections.count() > 0) {
+        kernel.begin(sections, pattern, wires);
+    } else {
+        kernel.begin(solenoid, pattern, wires);
+    }
+
+    JobEstimate estimate = JobEstimate();
+    estimate.begin(kernel, solenoid.getRadius(), 2 * kinematics.stepDelay);
+    plan.wire = estimate.wireTotal();
+    SpeedProfile profile = SpeedProfile();
+    profile.begin(kernel, solenoid.getRadius());
+
+    const uint64_t stepPeriod = 2 * (uint64_t) kinematics.stepDelay;
+    uint64_t now = 0;
+    uint64_t lastCc = 0;
+    bool ccStepped = false;
+    bool reversedSinceCc = false;
+    Pass pass = {0, 0, 0, 0, kernel.position(), kernel.position(), UINT64_MAX};
+
+    plan.passes.clear();
+    plan.ssSteps = 0;
+    plan.ccSteps = 0;
+    plan.reversals = 0;
+    plan.minSsInterval = UINT64_MAX;
+    plan.minCcInterval = UINT64_MAX;
+    plan.minReversalInterval = UINT64_MAX;
+
+    while (!kernel.done()) {
+        uint8_t mask = kernel.next();
+
+        if (mask & STEP_REVERSED) {
+            pass.time = now - pass.start;
+            pass.to = kernel.lastReversal();
+            plan.passes.push_back(pass);
+            pass = {0, 0, now, 0, kernel.lastReversal(), kernel.lastReversal(), UINT64_MAX};
+            plan.reversals++;
+            reversedSinceCc = true;
+        }
+
+        if (mask & STEP_CC) {
+            if (ccStepped) {
+                uint64_t interval = now - lastCc;
+                if (interval < plan.minCcInterval) {
+                    plan.minCcInterval = interval;
+                }
+                if (reversedSinceCc && interval < plan.minReversalInterval) {
+                    plan.minReversalInterval = interval;
+                }
+            }
+            lastCc = now;
+            ccStepped = true;
+            reversedSinceCc = false;
+            pass.ccSteps++;
+            plan.ccSteps++;
+        }
+
+        // The carriage moves alone between sections, at the step delay
+        uint64_t period = stepPeriod;
+        if (mask & STEP_SS) {
+            if (kinematics.profile) {
+                period = 2 * (uint64_t) profile.next(kernel);
+            }
+            pass.minSsInterval = period < pass.minSsInterval ? period : pass.minSsInterval;
+            pass.ssSteps++;
+            plan.ssSteps++;
+        }
+        now += period;
+    }
+
+    pass.time = now - pass.start;
+    pass.to = kernel.position();
+    plan.passes.push_back(pass);
+    plan.time = now;
+    for (const Pass &done : plan.passes) {
+        plan.minSsInterval = done.minSsInterval < plan.minSsInterval ? done.minSsInterval : plan.minSsInterval;
+    }
+}
+
+double rate(uint64_t interval) {
+    return interval > 0 && interval != UINT64_MAX ? 1e6 / interval : 0;
+}
+
+// Reports a step change in speed against the limits, returns false if it is too large
+bool checkChange(const char *what, double change, uint32_t start, uint32_t accel) {
+    bool safe = change <= start;
+    printf("%s: %.0f steps/s step change, limit %u steps/s: %s", what, change, start, safe ? "ok" : "TOO LARGE");
+    if (!safe && accel > 0) {
+        // Ramp from the start limit to the full change at the acceleration limit
+        double time = (change - start) / accel;
+        double steps = (change * change - (double) start * start) / (2.0 * accel);
+        printf(", needs a %.0f ms ramp over %.0f steps", time * 1000, steps);
+    }
+    printf("\n");
+    return safe;
+}
+
+bool parseSection(const char *text, Sections &sections) {
+    String fields[4];
+    String list = String(text) + ",";
+    uint8_t count = 0;
+    int start = 0;
+    int comma;
+    while ((comma = list.indexOf(',', start)) >= 0) {
+        if (count >= 4) {
+            return false;
+        }
+        fields[count++] = list.substring(start, comma);
+        start = comma + 1;
+    }
+
+    Section section = {0, 0, 0, 0};
+    WireGauge gauge;
+    if (count != 4 || !parseVal(fields[0], section.offset) || !parseVal(fields[1], section.length) ||
+            !WireTable::find(fields[3].c_str(), gauge)) {
+        return false;
+    }
+    section.turns = fields[2].toInt();
+    section.gauge = gauge;
+    return sections.add(section) == SolenoidError::NO_ERROR;
+}
+
+bool parsePitches(const char *text, WindPattern &pattern) {
+    uint8_t pitches[PATTERN_TABLE_SIZE];
+    uint8_t count = 0;
+    String list = String(text) + ",";
+    int start = 0;
+    int comma;
+    while ((comma = list.indexOf(',', start)) >= 0) {
+        if (count >= PATTERN_TABLE_SIZE) {
+            return false;
+        }
+        pitches[count++] = atoi(list.substring(start, comma).c_str());
+        start = comma + 1;
+    }
+    return pattern.setPitches(pitches, count);
+}
+
+int usage(const char *name) {
+    fprintf(stderr, "Usage: %s --preset <A-D> | --length <cm> --radius <cm> --inductance <mH> --gauge <name>\n", name);
+    fprintf(stderr, "       | --section <offset>,<length>,<turns>,<gauge> ...\n");
+    fprintf(stderr, "       [--pattern <name>] [--pitches <p>[,<p>...]] [--grade <1|2>]\n");
+    fprintf(stderr, "       [--step-delay <us>] [--ss-start <steps/s>] [--cc-start <steps/s>] [--ss-accel <steps/s2>]\n");
+    fprintf(stderr, "       [--cc-accel <steps/s2>] [--profile] [--layers]\n");
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    Kinematics kinematics = {MOTOR_DELAY, DEFAULT_SS_START, DEFAULT_CC_START, DEFAULT_SS_ACCEL, DEFAULT_CC_ACCEL, false};
+    Solenoid solenoid = Solenoid();
+    solenoid.begin(Preset::None);
+    WindPattern pattern = WindPattern();
+    WireTable wires = WireTable();
+    Sections sections = Sections();
+    bool layers = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char *key = argv[i];
+        if (strcmp(key, "--layers") == 0) {
+            layers = true;
+            continue;
+        }
+        if (strcmp(key, "--profile") == 0) {
+            kinematics.profile = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return usage(argv[0]);
+        }
+        const char *value = argv[++i];
+        uint32_t number = 0;
+        bool ok = true;
+        if (strcmp(key, "--preset") == 0) {
+            ok = strlen(value) == 1 && value[0] >= 'A' && value[0] <= 'D';
+            if (ok) {
+                solenoid.setPreset(static_cast<Preset>(Preset::A + (value[0] - 'A')));
+            }
+        } else if (strcmp(key, "--length") == 0) {
+            ok = parseVal(String(value), number) && solenoid.setLength(number) == SolenoidError::NO_ERROR;
+        } else if (strcmp(key, "--radius") == 0) {
+            ok = parseVal(String(value), number) && solenoid.setRadius(number) == SolenoidError::NO_ERROR;
+        } else if (strcmp(key, "--inductance") == 0) {
+            ok = parseVal(String(value), number) && solenoid.setInductance(number) == SolenoidError::NO_ERROR;
+        } else if (strcmp(key, "--gauge") == 0) {
+            WireGauge gauge;
+            ok = WireTable::find(value, gauge) && solenoid.setGauge(gauge) == SolenoidError::NO_ERROR;
+        } else if (strcmp(key, "--section") == 0) {
+            ok = parseSection(value, sections);
+        } else if (strcmp(key, "--pattern") == 0) {
+            PatternType type;
+            ok = WindPattern::find(value, type) && pattern.setType(type);
+        } else if (strcmp(key, "--pitches") == 0) {
+            ok = parsePitches(value, pattern);
+        } else if (strcmp(key, "--grade") == 0) {
+            ok = wires.setGrade(static_cast<WireGrade>(atoi(value)));
+        } else if (strcmp(key, "--step-delay") == 0) {
+            kinematics.stepDelay = atoi(value);
+            ok = kinematics.stepDelay >= DRIVER_MIN_PULSE;
+        } else if (strcmp(key, "--ss-start") == 0) {
+            kinematics.ssStart = atoi(value);
+        } else if (strcmp(key, "--cc-start") == 0) {
+            kinematics.ccStart = atoi(value);
+        } else if (strcmp(key, "--ss-accel") == 0) {
+            kinematics.ssAccel = atoi(value);
+        } else if (strcmp(key, "--cc-accel") == 0) {
+            kinematics.ccAccel = atoi(value);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            fprintf(stderr, "Bad argument: %s %s\n", key, value);
+            return usage(argv[0]);
+        }
+    }
+    if (sections.count() == 0 && (solenoid.getLength() == 0 || solenoid.getRadius() == 0 ||
+            solenoid.getInductance() == 0 || solenoid.getTurns() == 0)) {
+        return usage(argv[0]);
+    }
+
+    Plan plan;
+    auto start = std::chrono::steady_clock::now();
+    simulate(solenoid, sections, pattern, wires, kinematics, plan);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (sections.count() > 0) {
+        printf("Job: %u sections, %u turns, %s\n", sections.count(), sections.totalTurns(), pattern.typeString().c_str());
+        for (uint8_t i = 0; i < sections.count(); i++) {
+            const Section &section = sections.get(i);
+            printf("  %u: %scm to %scm, %u turns, %s\n", i + 1,
+                formatVal(section.offset, MAX_LENGTH).c_str(),
+                formatVal(section.offset + section.length, MAX_LENGTH).c_str(),
+                section.turns,
+                Solenoid::gaugeString(static_cast<WireGauge>(section.gauge)).c_str());
+        }
+    } else {
+        printf("Job: L = %scm, R = %scm, I = %smH, %s, %u turns, %s\n",
+            formatVal(solenoid.getLength(), MAX_LENGTH).c_str(),
+            formatVal(solenoid.getRadius(), MAX_RADIUS).c_str(),
+            formatVal(solenoid.getInductance(), MAX_INDUCTANCE).c_str(),
+            solenoid.gaugeString().c_str(),
+            solenoid.getTurns(),
+            pattern.typeString().c_str());
+    }
+    printf("Total time: %.1f s (%.1f min)\n", plan.time * 1e-6, plan.time * 1e-6 / 60);
+    printf("SS steps: %u, CC steps: %u, passes: %zu, reversals: %u\n",
+        plan.ssSteps, plan.ccSteps, plan.passes.size(), plan.reversals);
+    printf("Wire: %.1f m\n", plan.wire * 1e-3);
+
+    // The peaks are the shortest intervals, speeds are constant between step changes without the profile
+    const double ssRate = rate(plan.minSsInterval);
+    const double ccRate = rate(plan.minCcInterval);
+    printf("Peak SS rate: %.0f steps/s (%.2f rev/s)\n", ssRate, ssRate / SS_STEPS_PER_REVOLUTION);
+    printf("Peak CC rate: %.0f steps/s (%.3f cm/s)\n", ccRate, ccRate * DISTANCE_PER_STEP / 1000);
+
+    uint64_t longest = 0;
+    uint64_t shortest = UINT64_MAX;
+    for (const Pass &pass : plan.passes) {
+        longest = pass.time > longest ? pass.time : longest;
+        shortest = pass.time < shortest ? pass.time : shortest;
+    }
+    printf("Pass time: %.2f s to %.2f s\n", shortest * 1e-6, longest * 1e-6);
+
+    // Start, pause and stop are full speed changes, a reversal swings the carriage from +v to -v
+    bool safe = checkChange("SS start/stop", ssRate, kinematics.ssStart, kinematics.ssAccel);
+    safe = checkChange("CC start/stop", ccRate, kinematics.ccStart, kinematics.ccAccel) && safe;
+    if (plan.reversals > 0) {
+        safe = checkChange("CC reversal", 2 * rate(plan.minReversalInterval), kinematics.ccStart, kinematics.ccAccel) && safe;
+    }
+    fprintf(stderr, "Simulated in %.3f s, %.0fx real time\n", elapsed, elapsed > 0 ? plan.time * 1e-6 / elapsed : 0);
+
+    if (layers) {
+        printf("\npass,start_s,time_s,ss_steps,cc_steps,from_cm,to_cm,peak_ss_rate\n");
+        for (size_t i = 0; i < plan.passes.size(); i++) {
+            const Pass &pass = plan.passes[i];
+            printf("%zu,%.3f,%.3f,%u,%u,%.3f,%.3f,%.0f\n",
+                i + 1, pass.start * 1e-6, pass.time * 1e-6, pass.ssSteps, pass.ccSteps, pass.from / 1000.0, pass.to / 1000.0, rate(pass.minSsInterval));
+        }
+    }
+    return safe ? 0 : 3;
+}
@@ -0,0 +1,307 @@
+/*
+Stepper ramp tuner
+Plays a move through the host stepper model, the torque-speed curve, inertia and load of
+the spindle or carriage motor, and reports the missed steps and the peak load angle. With
+--sweep it searches the fastest safe rate for a range of accelerations, which gives the
+start and acceleration limits for plan and the shortest step delay the machine can take.
+
+Usage: ramp [options]
+  --motor <ss|cc>        motor to drive, default ss
+  --params <file>        motor parameter file over the built-in values, see motors.txt
+  --rate <steps/s>       cruise rate, default the firmware rate of MOTOR_DELAY
+  --accel <steps/s2>     ramp acceleration, 0 jumps to the rate as the firmware does, default 0
+  --steps <n>            steps at the cruise rate, ramps add to them, default one revolution
+  --reverse              return at once, a carriage reversal, default for cc
+  --margin <degrees>     load angle kept from the 180 degree slip point, electrical, default 45
+  --sweep                fastest safe rate for each acceleration instead of one move
+
+The load angle is how far the field leads the rotor right after a step, 90 degrees at
+rest in full steps. A move is safe when no step is missed and the load angle stays the
+margin short of 180, the margin covers what the model leaves out: resonance, supply sag,
+a heavier mandrel. An unsafe move exits with code 3.
+*/
+#include <Arduino.h>
+#include <Machine.hpp>
+#include <StepperModel.hpp>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define DEFAULT_MARGIN 45 // electrical degrees
+#define SLIP_ANGLE 180 // electrical degrees
+#define SETTLE_TIME 200000 // us the rotor runs on after the last step
+#define SWEEP_MIN_RATE 10 // steps/s
+#define SWEEP_MAX_RATE 20000
+#define SWEEP_GROWTH 1.15 // rate factor between tries before the first unsafe one
+#define SWEEP_RESOLUTION 0.01 // fraction of the rate
+
+// Accelerations tried by the sweep, steps/s2, 0 is no ramp
+const double SWEEP_ACCELS[] = {0, 500, 1000, 2000, 5000, 10000, 20000, 50000};
+#define SWEEP_ACCEL_COUNT (sizeof(SWEEP_ACCELS) / sizeof(SWEEP_ACCELS[0]))
+
+struct Move {
+    double rate; // steps/s
+    double accel; // steps/s2, 0 for none
+    uint32_t steps;
+    bool reverse;
+};
+
+struct Result {
+    uint64_t missed;
+    uint64_t firstMiss; // us
+    double peakLoadAngle; // electrical degrees
+    uint64_t peakTime; // us
+    uint64_t duration; // us to the last step, or to the stall
+};
+
+// Time of each step of a trapezoid from rest to rest, us
+void profile(const Move &move, std::vector<double> &times) {
+    times.clear();
+    if (move.accel <= 0) {
+        // Full rate from the first step, the firmware timing
+        for (uint32_t i = 1; i <= move.steps; i++) {
+            times.push_back(i * 1e6 / move.rate);
+        }
+        return;
+    }
+
+    // Ramps up and down around the steps at the rate
+    const uint32_t ramp = ceil(move.rate * move.rate / (2 * move.accel));
+    const uint32_t steps = move.steps + 2 * ramp;
+    const double rampTime = sqrt(2 * ramp / move.accel);
+    const double total = 2 * rampTime + move.steps / move.rate;
+    for (uint32_t i = 1; i <= steps; i++) {
+        double t;
+        if (i <= ramp) {
+            t = sqrt(2 * i / move.accel);
+        } else if (i <= steps - ramp) {
+            t = rampTime + (i - ramp) / move.rate;
+        } else {
+            t = total - sqrt(2 * (steps - i) / move.accel);
+        }
+        times.push_back(t * 1e6);
+    }
+}
+
+Result run(const MotorParams &params, const Move &move) {
+    StepperModel model = StepperModel();
+    model.begin(params);
+    model.enable(true, 0);
+
+    std::vector<double> times;
+    profile(move, times);
+    // A stalled motor stays stalled, the rest of the move is not played
+    uint64_t last = 0;
+    for (size_t i = 0; i < times.size() && model.missedSteps() == 0; i++) {
+        last = (uint64_t) llround(times[i]);
+        model.step(true, last);
+    }
+    if (move.reverse) {
+        // Straight back, without ramps the first step back is one period after the last
+        const uint64_t start = last;
+        for (size_t i = 0; i < times.size() && model.missedSteps() == 0; i++) {
+            last = start + (uint64_t) llround(times[i]);
+            model.step(false, last);
+        }
+    }
+    model.update(last + SETTLE_TIME);
+    return {model.missedSteps(), model.firstMiss(), model.peakLoadAngle(), model.peakTime(), last};
+}
+
+bool safe(const Result &result, double margin) {
+    return result.missed == 0 && result.peakLoadAngle <= SLIP_ANGLE - margin;
+}
+
+// Rates tried by the sweep that were unsafe below the fastest safe one
+struct Band {
+    double from; // steps/s
+    double to;
+};
+
+// Fastest safe rate for an acceleration, 0 if none
+// Resonances make safety come and go with the rate, so every rate is tried from the bottom
+// up to twice the fastest safe one, the unsafe ones in between are kept as bands
+double fastest(const MotorParams &params, Move move, double margin, std::vector<Band> &bands) {
+    double best = 0;
+    double above = 0; // first unsafe rate tried above the best
+    Band band = {0, 0};
+    bands.clear();
+    for (double rate = SWEEP_MIN_RATE; rate < SWEEP_MAX_RATE && (best == 0 || rate < 2 * best); rate *= SWEEP_GROWTH) {
+        move.rate = rate;
+        if (safe(run(params, move), margin)) {
+            if (band.from > 0) {
+                bands.push_back(band);
+                band.from = 0;
+            }
+            best = rate;
+            above = 0;
+            continue;
+        }
+        if (band.from == 0) {
+            band.from = rate;
+        }
+        band.to = rate;
+        if (above == 0) {
+            above = rate;
+        }
+    }
+    if (best == 0 || above == 0) {
+        return best;
+    }
+
+    // Narrow down the edge
+    while (above / best > 1 + SWEEP_RESOLUTION) {
+        move.rate = sqrt(best * above);
+        if (safe(run(params, move), margin)) {
+            best = move.rate;
+        } else {
+            above = move.rate;
+        }
+    }
+    return best;
+}
+
+void printResult(const char *motor, const Move &move, const Result &result, double margin) {
+    char ramps[32] = "no ramps";
+    if (move.accel > 0) {
+        snprintf(ramps, sizeof(ramps), "%.0f steps/s2 ramps", move.accel);
+    }
+    printf("%s move: %u steps%s at %.0f steps/s, %s\n", motor, move.steps, move.reverse ? " and back" : "", move.rate, ramps);
+    printf("Time: %.3f s\n", result.duration * 1e-6);
+    if (result.missed > 0) {
+        printf("Missed steps: %llu, first at %.4f s\n", (unsigned long long) result.missed, result.firstMiss * 1e-6);
+    } else {
+        printf("Missed steps: 0\n");
+    }
+    printf("Peak load angle: %.1f deg at %.4f s", result.peakLoadAngle, result.peakTime * 1e-6);
+    if (result.peakLoadAngle < SLIP_ANGLE) {
+        printf(", %.1f deg short of slipping", SLIP_ANGLE - result.peakLoadAngle);
+    }
+    printf(", margin %.0f deg\n", margin);
+    printf("%s\n", safe(result, margin) ? "Safe" : "UNSAFE");
+}
+
+void sweep(const char *motor, const MotorParams &params, Move move, double margin) {
+    printf("%s sweep: %u steps%s, margin %.0f deg\n", motor, move.steps, move.reverse ? " and back" : "", margin);
+    printf("accel_steps_s2,max_rate_steps_s,step_delay_us,peak_load_angle_deg,unsafe_below_steps_s\n");
+    double rates[SWEEP_ACCEL_COUNT];
+    std::vector<Band> startBands;
+    std::vector<Band> bands;
+    for (size_t i = 0; i < SWEEP_ACCEL_COUNT; i++) {
+        move.accel = SWEEP_ACCELS[i];
+        rates[i] = fastest(params, move, margin, bands);
+        if (i == 0) {
+            startBands = bands;
+        }
+        if (rates[i] <= 0) {
+            printf("%.0f,0,,,\n", move.accel);
+            continue;
+        }
+        move.rate = rates[i];
+        Result result = run(params, move);
+        printf("%.0f,%.0f,%.0f,%.1f,", move.accel, rates[i], 1e6 / (2 * rates[i]), result.peakLoadAngle);
+        for (size_t b = 0; b < bands.size(); b++) {
+            printf("%s%.0f-%.0f", b > 0 ? " " : "", bands[b].from, bands[b].to);
+        }
+        printf("\n");
+    }
+
+    // MOTOR_DELAY is half a step period, the firmware jumps to it from rest
+    const char *option = motor[0] == 'S' ? "ss" : "cc";
+    if (rates[0] > 0) {
+        printf("Without ramps: MOTOR_DELAY %.0f us or more, plan --%s-start %.0f\n", ceil(1e6 / (2 * rates[0])), option, rates[0]);
+        for (const Band &band : startBands) {
+            printf("  but not %.0f to %.0f us\n", floor(1e6 / (2 * band.to)), ceil(1e6 / (2 * band.from)));
+        }
+    }
+
+    // The hardest ramp that still reaches the best rate
+    double best = 0;
+    for (size_t i = 1; i < SWEEP_ACCEL_COUNT; i++) {
+        best = rates[i] > best ? rates[i] : best;
+    }
+    for (size_t i = SWEEP_ACCEL_COUNT - 1; i > 0 && best > rates[0]; i--) {
+        if (rates[i] >= best * (1 - SWEEP_RESOLUTION)) {
+            printf("With ramps: %.0f steps/s at %.0f steps/s2, plan --%s-accel %.0f\n", rates[i], SWEEP_ACCELS[i], option, SWEEP_ACCELS[i]);
+            break;
+        }
+    }
+}
+
+int usage(const char *name) {
+    fprintf(stderr, "Usage: %s [--motor <ss|cc>] [--params <file>] [--rate <steps/s>] [--accel <steps/s2>]\n", name);
+    fprintf(stderr, "       [--steps <n>] [--reverse] [--margin <degrees>] [--sweep]\n");
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    MotorParams ss = StepperModel::spindle();
+    MotorParams cc = StepperModel::carriage();
+    bool carriage = false;
+    bool reverse = false;
+    bool doSweep = false;
+    const char *paramsPath = nullptr;
+    Move move = {1e6 / (2 * MOTOR_DELAY), 0, 0, false};
+    double margin = DEFAULT_MARGIN;
+
+    for (int i = 1; i < argc; i++) {
+        const char *key = argv[i];
+        if (strcmp(key, "--reverse") == 0) {
+            reverse = true;
+            continue;
+        }
+        if (strcmp(key, "--sweep") == 0) {
+            doSweep = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return usage(argv[0]);
+        }
+        const char *value = argv[++i];
+        bool ok = true;
+        if (strcmp(key, "--motor") == 0) {
+            ok = strcmp(value, "ss") == 0 || strcmp(value, "cc") == 0;
+            carriage = strcmp(value, "cc") == 0;
+        } else if (strcmp(key, "--params") == 0) {
+            paramsPath = value;
+        } else if (strcmp(key, "--rate") == 0) {
+            move.rate = atof(value);
+            ok = move.rate > 0;
+        } else if (strcmp(key, "--accel") == 0) {
+            move.accel = atof(value);
+            ok = move.accel >= 0;
+        } else if (strcmp(key, "--steps") == 0) {
+            move.steps = atoi(value);
+            ok = move.steps > 0;
+        } else if (strcmp(key, "--margin") == 0) {
+            margin = atof(value);
+            ok = margin >= 0 && margin < SLIP_ANGLE;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            fprintf(stderr, "Bad argument: %s %s\n", key, value);
+            return usage(argv[0]);
+        }
+    }
+    if (paramsPath != nullptr && !StepperModel::load(paramsPath, ss, cc)) {
+        return 1;
+    }
+
+    const MotorParams &params = carriage ? cc : ss;
+    const char *motor = carriage ? "CC" : "SS";
+    if (move.steps == 0) {
+        move.steps = params.stepsPerRevolution;
+    }
+    move.reverse = reverse || carriage;
+
+    if (doSweep) {
+        sweep(motor, params, move, margin);
+        return 0;
+    }
+    Result result = run(params, move);
+    printResult(motor, move, result, margin);
+    return safe(result, margin) ? 0 : 3;
+}
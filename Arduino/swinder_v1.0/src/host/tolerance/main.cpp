@@ -0,0 +1,392 @@
+/*
+Coil tolerance and yield analysis
+Winds a job many times over on paper with the mandrel radius and wound length drawn
+from normal distributions, and reports the spread of the inductance, the share of
+coils inside the spec and the turn count that centres the spread on the target.
+
+Usage: tolerance --preset <A-D> | --length <cm> --radius <cm> --inductance <mH> --gauge <name> [options]
+  --spec <percent>       inductance tolerance of a good coil, default 5
+  --radius-sd <mm>       standard deviation of the mandrel radius, default 0.02
+  --pitch-sd <percent>   standard deviation of the wound length, default 0.5
+  --pattern <name>       layer pattern, helical, orthocyclic or progressive, default helical
+  --grade <1|2>          enamel grade of the wire, default 2
+  --samples <n>          coils simulated, default 1000000
+  --seed <n>             random seed, default 1
+  --threads <n>          default all cores
+  --histogram            print the distribution as CSV
+
+Turns, turns per pass and the layers come from Solenoid and WindPattern as the firmware
+winds them, a job whose layers do not fit is refused. Each sample uses the same single
+radius solenoid as Solenoid::updateTurns(), so a coil wound as set comes out on the target
+and only the spread of the mandrel and pitch moves it. The wire diameter sets the layers
+but not the inductance in that model, so it has no spread of its own. Before the analysis
+Preset A is checked to come out on its 40mH. The adjustment is printed as the
+`set inductance` command that makes the firmware wind the centred turn count.
+*/
+#include <Arduino.h>
+#include <Solenoid.hpp>
+#include <Format.hpp>
+#include <Machine.hpp>
+#include <WindPattern.hpp>
+#include <WireTable.hpp>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+#define MAX_TOLERANCE_LAYERS 1000 // Layers planned before a job is taken as unwindable
+#define HISTOGRAM_BINS 40 // Bins over +-2 spec widths
+#define MODEL_TOLERANCE 0.005 // Largest error of the model on a preset, the turn count is rounded
+
+struct Spread {
+    double radius; // m, standard deviation
+    double pitch; // fraction of the length
+};
+
+// One job as the firmware winds it
+struct Coil {
+    double radius; // m
+    double length; // m
+    uint32_t turns;
+    std::vector<uint32_t> layerTurns; // Turns of each layer, from the mandrel out
+};
+
+struct Result {
+    uint64_t samples;
+    double mean; // H
+    double sd; // H
+    double nominal; // H, no spread
+    double yield; // fraction inside the spec
+    double median; // H
+    double low; // H, 0.1 percentile
+    double high; // H, 99.9 percentile
+    std::vector<uint64_t> histogram;
+};
+
+// Lays the turns of a job out in layers, false if the pattern cannot hold them
+bool plan(Solenoid &solenoid, const WindPattern &pattern, const WireTable &wires, uint32_t turns, Coil &coil) {
+    coil.radius = solenoid.getRadius() * 1e-4;
+    coil.length = solenoid.getLength() * 1e-4;
+    coil.turns = turns;
+    coil.layerTurns.clear();
+
+    const uint32_t perPass = solenoid.turnsPerPass(wires);
+    uint32_t remaining = turns;
+    for (uint32_t layer = 0; remaining > 0; layer++) {
+        const uint32_t capacity = pattern.layerTurns(layer, perPass);
+        if (capacity == 0 || layer >= MAX_TOLERANCE_LAYERS) {
+            return false;
+        }
+        const uint32_t layerTurns = remaining < capacity ? remaining : capacity;
+        coil.layerTurns.push_back(layerTurns);
+        remaining -= layerTurns;
+    }
+    return turns > 0;
+}
+
+// Inverse of Solenoid::updateTurns(), L = K * N^2 * r^2 / l at the mandrel radius
+double inductance(const Coil &coil, double radius, double length) {
+    return K * 1e-11 * coil.turns * coil.turns * radius * radius / length;
+}
+
+// Nominal Preset A on its 40mH target, false if the model has drifted from Solenoid
+bool checkModel(const WindPattern &pattern, const WireTable &wires) {
+    Solenoid preset = Solenoid();
+    preset.begin(Preset::A);
+    Coil coil;
+    if (!plan(preset, pattern, wires, preset.getTurns(), coil)) {
+        fprintf(stderr, "Preset A does not fit its length\n");
+        return false;
+    }
+    const double target = preset.getInductance() * 1e-5;
+    const double nominal = inductance(coil, coil.radius, coil.length);
+    if (fabs(nominal / target - 1) > MODEL_TOLERANCE) {
+        fprintf(stderr, "Model check failed: Preset A is %.4f mH nominal, %.4f mH target\n", nominal * 1e3, target * 1e3);
+        return false;
+    }
+    return true;
+}
+
+// Worker: samples of one thread, its own generator so the runs repeat for a seed and thread count
+void sample(const Coil &coil, const Spread &spread, uint64_t samples, uint64_t seed, std::vector<float> &values) {
+    std::mt19937_64 random = std::mt19937_64(seed);
+    std::normal_distribution<double> normal = std::normal_distribution<double>(0, 1);
+    values.reserve(samples);
+    for (uint64_t i = 0; i < samples; i++) {
+        double radius = coil.radius + spread.radius * normal(random);
+        double length = coil.length * (1 + spread.pitch * normal(random));
+        if (radius <= 0 || length <= 0) {
+            continue;
+        }
+        values.push_back(inductance(coil, radius, length));
+    }
+}
+
+void analyse(const Coil &coil, const Spread &spread, double target, double spec,
+        uint64_t samples, uint64_t seed, uint32_t threads, Result &result) {
+    std::vector<std::vector<float>> partial(threads);
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threads; t++) {
+        uint64_t count = samples / threads + (t < samples % threads ? 1 : 0);
+        workers.emplace_back(sample, std::cref(coil), std::cref(spread), count, seed + t, std::ref(partial[t]));
+    }
+    std::vector<float> values;
+    values.reserve(samples);
+    for (uint32_t t = 0; t < threads; t++) {
+        workers[t].join();
+        values.insert(values.end(), partial[t].begin(), partial[t].end());
+    }
+
+    result.samples = values.size();
+    result.nominal = inductance(coil, coil.radius, coil.length);
+    result.histogram.assign(HISTOGRAM_BINS, 0);
+    if (values.empty()) {
+        return;
+    }
+
+    double sum = 0;
+    double squares = 0;
+    uint64_t good = 0;
+    for (float value : values) {
+        sum += value;
+        squares += (double) value * value;
+        const double error = value / target - 1;
+        if (fabs(error) <= spec) {
+            good++;
+        }
+        int bin = (int) floor((error / (4 * spec) + 0.5) * HISTOGRAM_BINS);
+        result.histogram[std::min(std::max(bin, 0), HISTOGRAM_BINS - 1)]++;
+    }
+    result.mean = sum / values.size();
+    result.sd = sqrt(std::max(squares / values.size() - result.mean * result.mean, 0.0));
+    result.yield = (double) good / values.size();
+
+    auto percentile = [&values](double fraction) {
+        std::vector<float>::iterator at = values.begin() + (size_t) (fraction * (values.size() - 1));
+        std::nth_element(values.begin(), at, values.end());
+        return (double) *at;
+    };
+    result.median = percentile(0.5);
+    result.low = percentile(0.001);
+    result.high = percentile(0.999);
+}
+
+// Turns the firmware winds for an inductance setting
+uint32_t turnsAt(Solenoid &solenoid, uint32_t setting) {
+    const uint32_t inductance = solenoid.getInductance();
+    solenoid.setInductance(setting);
+    const uint32_t turns = solenoid.getTurns();
+    solenoid.setInductance(inductance);
+    return turns;
+}
+
+// Smallest firmware inductance setting that winds at least the turns
+uint32_t settingFor(Solenoid &solenoid, uint32_t turns) {
+    uint32_t low = 1;
+    uint32_t high = MAX_INDUCTANCE;
+    while (low < high) {
+        const uint32_t middle = low + (high - low) / 2;
+        if (turnsAt(solenoid, middle) < turns) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// Turns whose nominal inductance times the bias of the spread is closest to the target
+uint32_t centre(Solenoid &solenoid, const WindPattern &pattern, const WireTable &wires, double bias, double target) {
+    Coil coil;
+    uint32_t low = 1;
+    uint32_t high = solenoid.getTurns() * 4;
+    while (low < high) {
+        const uint32_t middle = low + (high - low) / 2;
+        if (plan(solenoid, pattern, wires, middle, coil) &&
+                inductance(coil, coil.radius, coil.length) * bias >= target) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    // First count at or over the target, the one below may be closer
+    if (low > 1 && plan(solenoid, pattern, wires, low - 1, coil)) {
+        const double under = inductance(coil, coil.radius, coil.length) * bias;
+        plan(solenoid, pattern, wires, low, coil);
+        const double over = inductance(coil, coil.radius, coil.length) * bias;
+        if (target - under < over - target) {
+            return low - 1;
+        }
+    }
+    return low;
+}
+
+void report(const char *title, const Coil &coil, const Result &result, double target) {
+    printf("%s: %u turns in %zu layers\n", title, coil.turns, coil.layerTurns.size());
+    printf("  nominal %.4f mH (%+.2f%%), mean %.4f mH (%+.2f%%), sd %.4f mH (%.2f%%)\n",
+        result.nominal * 1e3, (result.nominal / target - 1) * 100,
+        result.mean * 1e3, (result.mean / target - 1) * 100,
+        result.sd * 1e3, result.sd / target * 100);
+    printf("  median %.4f mH, 99.8%% of coils in %.4f to %.4f mH\n", result.median * 1e3, result.low * 1e3, result.high * 1e3);
+    printf("  yield %.2f%% of %llu coils\n", result.yield * 100, (unsigned long long) result.samples);
+}
+
+int usage(const char *name) {
+    fprintf(stderr, "Usage: %s --preset <A-D> | --length <cm> --radius <cm> --inductance <mH> --gauge <name>\n", name);
+    fprintf(stderr, "       [--spec <percent>] [--radius-sd <mm>] [--pitch-sd <percent>] [--pattern <name>]\n");
+    fprintf(stderr, "       [--grade <1|2>] [--samples <n>] [--seed <n>] [--threads <n>] [--histogram]\n");
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    Solenoid solenoid = Solenoid();
+    solenoid.begin(Preset::None);
+    WindPattern pattern = WindPattern();
+    WireTable wires = WireTable();
+    Spread spread = {0.02e-3, 0.005};
+    double spec = 0.05;
+    uint64_t samples = 1000000;
+    uint64_t seed = 1;
+    uint32_t threads = std::thread::hardware_concurrency();
+    bool histogram = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char *key = argv[i];
+        if (strcmp(key, "--histogram") == 0) {
+            histogram = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return usage(argv[0]);
+        }
+        const char *value = argv[++i];
+        uint32_t number = 0;
+        bool ok = true;
+        if (strcmp(key, "--preset") == 0) {
+            ok = strlen(value) == 1 && value[0] >= 'A' && value[0] <= 'D';
+            if (ok) {
+                solenoid.setPreset(static_cast<Preset>(Preset::A + (value[0] - 'A')));
+            }
+        } else if (strcmp(key, "--length") == 0) {
+            ok = parseVal(String(value), number) && solenoid.setLength(number) == SolenoidError::NO_ERROR;
+        } else if (strcmp(key, "--radius") == 0) {
+            ok = parseVal(String(value), number) && solenoid.setRadius(number) == SolenoidError::NO_ERROR;
+        } else if (strcmp(key, "--inductance") == 0) {
+            ok = parseVal(String(value), number) && solenoid.setInductance(number) == SolenoidError::NO_ERROR;
+        } else if (strcmp(key, "--gauge") == 0) {
+            WireGauge gauge;
+            ok = WireTable::find(value, gauge) && solenoid.setGauge(gauge) == SolenoidError::NO_ERROR;
+        } else if (strcmp(key, "--spec") == 0) {
+            spec = atof(value) / 100;
+            ok = spec > 0;
+        } else if (strcmp(key, "--radius-sd") == 0) {
+            spread.radius = atof(value) * 1e-3;
+            ok = spread.radius >= 0;
+        } else if (strcmp(key, "--pitch-sd") == 0) {
+            spread.pitch = atof(value) / 100;
+            ok = spread.pitch >= 0;
+        } else if (strcmp(key, "--pattern") == 0) {
+            PatternType type;
+            ok = WindPattern::find(value, type) && pattern.setType(type);
+        } else if (strcmp(key, "--grade") == 0) {
+            ok = wires.setGrade(static_cast<WireGrade>(atoi(value)));
+        } else if (strcmp(key, "--samples") == 0) {
+            samples = strtoull(value, nullptr, 10);
+            ok = samples > 0;
+        } else if (strcmp(key, "--seed") == 0) {
+            seed = strtoull(value, nullptr, 10);
+        } else if (strcmp(key, "--threads") == 0) {
+            threads = atoi(value);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            fprintf(stderr, "Bad argument: %s %s\n", key, value);
+            return usage(argv[0]);
+        }
+    }
+    if (solenoid.getLength() == 0 || solenoid.getRadius() == 0 || solenoid.getInductance() == 0 || solenoid.getTurns() == 0) {
+        return usage(argv[0]);
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    if (!checkModel(WindPattern(), wires)) {
+        return 3;
+    }
+
+    const double target = solenoid.getInductance() * 1e-5;
+    Coil coil;
+    if (!plan(solenoid, pattern, wires, solenoid.getTurns(), coil)) {
+        fprintf(stderr, "The wire does not fit the length\n");
+        return 2;
+    }
+    printf("%s mH +-%.1f%%, %s cm long, %s cm radius, %s %s, %s\n",
+        formatVal(solenoid.getInductance(), MAX_INDUCTANCE).c_str(), spec * 100,
+        formatVal(solenoid.getLength(), MAX_LENGTH).c_str(),
+        formatVal(solenoid.getRadius(), MAX_RADIUS).c_str(),
+        solenoid.gaugeString().c_str(),
+        WireTable::gradeString(wires.getGrade()).c_str(),
+        WindPattern::typeString(pattern.getType()).c_str());
+    printf("sd: radius %.3f mm, pitch %.2f%%, %u threads\n\n", spread.radius * 1e3, spread.pitch * 100, threads);
+
+    Result result;
+    analyse(coil, spread, target, spec, samples, seed, threads, result);
+    if (result.samples == 0) {
+        fprintf(stderr, "Every sample had a negative dimension, the spread is too wide\n");
+        return 2;
+    }
+    report("As set", coil, result, target);
+
+    // Turns that put the median on the target
+    const uint32_t ideal = centre(solenoid, pattern, wires, result.median / result.nominal, target);
+    if (ideal == coil.turns) {
+        printf("\nThe turn count is centred\n");
+    } else {
+        // The inductance setting has 0.01mH steps, try the settings either side of the ideal count
+        const uint32_t over = settingFor(solenoid, ideal);
+        uint32_t settings[2] = {over, over > 1 ? over - 1 : over};
+        uint32_t best = 0;
+        Coil bestCoil;
+        Result bestResult;
+        for (uint8_t i = 0; i < 2; i++) {
+            const uint32_t turns = turnsAt(solenoid, settings[i]);
+            Coil candidate;
+            if (turns == 0 || turns == coil.turns || (i == 1 && settings[1] == settings[0]) || !plan(solenoid, pattern, wires, turns, candidate)) {
+                continue;
+            }
+            Result trial;
+            analyse(candidate, spread, target, spec, samples, seed, threads, trial);
+            if (best == 0 || trial.yield > bestResult.yield) {
+                best = settings[i];
+                bestCoil = candidate;
+                bestResult = trial;
+            }
+        }
+
+        if (best == 0 || bestResult.yield <= result.yield) {
+            printf("\n%u turns would centre it, no inductance setting winds closer than the current one\n", ideal);
+        } else {
+            printf("\n");
+            report("Centred", bestCoil, bestResult, target);
+            printf("  %+d turns, %u ideal, yield %+.2f points\n", (int32_t) bestCoil.turns - (int32_t) coil.turns, ideal,
+                (bestResult.yield - result.yield) * 100);
+            printf("\n# Winds %u turns\nset inductance %s\n", bestCoil.turns, formatVal(best, MAX_INDUCTANCE).c_str());
+        }
+    }
+
+    if (histogram) {
+        printf("\nbin_mh,coils,percent\n");
+        for (uint32_t i = 0; i < HISTOGRAM_BINS; i++) {
+            const double error = ((i + 0.5) / HISTOGRAM_BINS - 0.5) * 4 * spec;
+            printf("%.4f,%llu,%.3f\n", target * (1 + error) * 1e3, (unsigned long long) result.histogram[i],
+                100.0 * result.histogram[i] / result.samples);
+        }
+    }
+    return 0;
+}
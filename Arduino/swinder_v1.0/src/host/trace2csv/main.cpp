@@ -0,0 +1,85 @@
+/*
+Step trace converter
+Decodes a TRACEnnn.BIN step trace into CSV for plotting and diffing.
+
+Usage: trace2csv <trace.bin> [out.csv]
+Writes to stdout if no output file is given. A summary goes to stderr.
+*/
+#include <stdio.h>
+#include <StepTrace.hpp>
+
+const char *typeName(uint8_t type) {
+    switch (type) {
+        case TraceEventType::TRACE_STEP: return "step";
+        case TraceEventType::TRACE_DIR: return "dir";
+        case TraceEventType::TRACE_OVERRIDE: return "override";
+        case TraceEventType::TRACE_MARK: return "mark";
+        case TraceEventType::TRACE_META: return "meta";
+        default: return "unknown";
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <trace.bin> [out.csv]\n", argv[0]);
+        return 1;
+    }
+
+    FILE *in = fopen(argv[1], "rb");
+    if (in == nullptr) {
+        perror(argv[1]);
+        return 1;
+    }
+    FILE *out = argc > 2 ? fopen(argv[2], "w") : stdout;
+    if (out == nullptr) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    StepTraceReader reader;
+    TraceEvent event;
+    uint8_t block[TRACE_BLOCK_SIZE];
+    uint64_t startTime = 0;
+    bool first = true;
+    uint64_t ssSteps = 0;
+    uint64_t ccSteps = 0;
+    uint64_t reversals = 0;
+    uint32_t badBlocks = 0;
+
+    fprintf(out, "time_us,event,flags,value\n");
+    while (fread(block, 1, TRACE_BLOCK_SIZE, in) == TRACE_BLOCK_SIZE) {
+        if (!reader.load(block)) {
+            badBlocks++;
+            continue;
+        }
+        while (reader.next(event)) {
+            if (first) {
+                startTime = event.time;
+                first = false;
+            }
+            fprintf(out, "%llu,%s,%u,%ld\n",
+                (unsigned long long) (event.time - startTime),
+                typeName(event.type),
+                event.flags,
+                (long) event.value);
+
+            if (event.type == TraceEventType::TRACE_STEP) {
+                ssSteps += (event.flags & TRACE_SS) ? 1 : 0;
+                ccSteps += (event.flags & TRACE_CC) ? 1 : 0;
+            } else if (event.type == TraceEventType::TRACE_DIR) {
+                reversals++;
+            }
+        }
+    }
+
+    fprintf(stderr, "SS steps: %llu CC steps: %llu direction changes: %llu\n",
+        (unsigned long long) ssSteps, (unsigned long long) ccSteps, (unsigned long long) reversals);
+    fprintf(stderr, "Dropped events: %u missing blocks: %u bad blocks: %u\n",
+        reader.dropped(), reader.missingBlocks(), badBlocks);
+
+    fclose(in);
+    if (out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
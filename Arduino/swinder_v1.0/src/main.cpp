@@ -1,12 +1,46 @@
 #include <Arduino.h>
 #include <Solenoid.hpp>
+#include <Format.hpp>
+#include <Machine.hpp>
+#include <WindKernel.hpp>
+#include <WindPattern.hpp>
+#include <Sections.hpp>
+#include <JobEstimate.hpp>
+#include <SpeedProfile.hpp>
+#include <WireTable.hpp>
+#include <FaultMonitor.hpp>
+#include <DeadlineMonitor.hpp>
+#include <Watchdog.hpp>
+#include <Checkpoint.hpp>
+#include <JobLog.hpp>
+#include <Console.hpp>
+#include <StepTrace.hpp>
+#include <SdTraceSink.hpp>
+#include <FileTraceSink.hpp>
+#include <DmaStepper.hpp>
+#include <QuadDecoder.hpp>
+#include <Menu.hpp>
 #include <Encoder.h>
 #include <LiquidCrystal_I2C.h>
 
 // Debug mode
-// Enables serial
+// Enables serial debug output, the command console is always available
 #define DEBUG false
 
+// Step backend
+// Plays precomputed step waveforms with DMA instead of pulsing the STEP pins from the loop
+#define STEP_DMA false
+
+// Encoder backend
+// Counts the rotary encoder with the ENC1 quadrature decoder instead of pin interrupts
+// A and B must then be wired to XBAR pins, see QuadDecoder
+#define ENCODER_HW false
+
+// Mirrored jobs
+// Starts a job from whichever end of the winding area the last one left the carriage at, winding it backwards
+// The coil is the same with its leads at the other ends
+#define CARRIAGE_MIRROR false
+
 // Solonoid spin motor
 #define SS_STEP_PIN 36
 #define SS_DIR_PIN 35
@@ -25,8 +59,13 @@
 
 // Rotary encoder
 #define RE_BUTTON_PIN 21
-#define RE_A_PIN 22
-#define RE_B_PIN 23
+#if ENCODER_HW
+  #define RE_A_PIN 2
+  #define RE_B_PIN 3
+#else
+  #define RE_A_PIN 22
+  #define RE_B_PIN 23
+#endif
 
 // Limit switches
 #define LS_START_PIN 7
@@ -35,57 +74,225 @@
 // Misc constants
 #define VERSION "V1.0"
 #define BUTTON_DELAY 200
-#define CARRIAGE_OFFSET 500 // 0.5 cm
-#define PADDING 5 // Potentially needed error correction value to add/subtract from the start and end; 0.001 accuracy
-#define MOTOR_DELAY 800 //ps
+#define BUTTON_DEBOUNCE 20 // ms after a release before the button is read again
+#define RATE_WINDOW 256 // SS steps per peak rate measurement
+#define BENCH_STEPS 200000 // Default SS steps timed by the bench command
+#define CONSOLE_POLL_STEPS 64 // Steps of either motor between console polls while winding
+#define SPLASH_TEXT "Robojackets!"
+#define SPLASH_CHAR_TIME 100 // ms per splash character
+#define SPLASH_HOLD_TIME 500 // ms the finished splash stays up
 
 enum Tasks {
   ChoosePreset,
   ValEdit,
   ConfirmScreen,
   Spin,
+  Fault,
   End,
+  Resume,
 };
 
 // Variables
 Tasks task = Tasks::ChoosePreset;
 
-// Stepper Values
-#define SS_STEPS_PER_REVOLUTION 200 // Whole steps
-#define CC_STEPS_PER_REVOLUTION 400 // Half steps
-#define DISTANCE_PER_REVOLUTION 800 // 0.8 cm of carriage travel
-#define DISTANCE_PER_STEP 2 // 0.002 cm of carriage travel
-
 
 // Define LCD
 LiquidCrystal_I2C lcd(0x27, 16, 2);
 
 // Define Rotary Encoder
-Encoder encoder(RE_A_PIN, RE_B_PIN);
+#if ENCODER_HW
+  QuadDecoder encoder = QuadDecoder();
+#else
+  Encoder encoder(RE_A_PIN, RE_B_PIN);
+#endif
+
+// Define menu engine, screens are the tables below
+Menu menu = Menu();
 
 // Define solenoid
 Solenoid solenoid = Solenoid();
 
+// Define sections of a multi-section job, none for a single solenoid job
+Sections sections = Sections();
+
+// Define winding kernel and the layer pattern it winds
+WindKernel windKernel = WindKernel();
+WindPattern windPattern = WindPattern();
+
+// Carriage position kept between jobs, homing is only needed at power on and after a fault or an abort
+bool carriageKnown = false; // Set by a completed job, the carriage driver stayed awake since
+int32_t carriageAt = 0; // Position relative to the offset, 0.001cm
+bool mirrored = false; // The current job winds from the far end, see machinePosition()
+bool ccForwardLevel = CC_DIR_SET; // DIR level for forward travel of the plan
+
+// Define wire table, the loaded enamel grade and diameters measured on the spool
+WireTable wireTable = WireTable();
+
+// Define time left and wire used estimate of the job being wound
+JobEstimate jobEstimate = JobEstimate();
+
+// Define SS rate schedule by layer radius and carriage position, enabled from the console
+SpeedProfile speedProfile = SpeedProfile();
+bool speedProfiled = false;
+uint32_t stepDelay = MOTOR_DELAY; // us, half period of the SS step being taken
+
+// Define motor fault monitor
+FaultMonitor faultMonitor = FaultMonitor();
+
+// Define step deadline monitor and the watchdog behind it
+DeadlineMonitor deadlineMonitor = DeadlineMonitor();
+Watchdog watchdog = Watchdog();
+bool watchdogReset = false; // Last reset was the watchdog
+volatile bool watchdogWarned = false; // Warning ran, a winding loop that comes round stops as on a fault
+
+// Define job checkpoint
+Checkpoint checkpoint = Checkpoint();
+
+// Define production log and current job record
+JobLog jobLog = JobLog();
+JobRecord currentJob;
+JobSummary logSummary; // Kept for the status command, reading the log is too slow between steps
+uint32_t jobStartTime = 0; // ms
+uint32_t lastJobEnd = 0; // ms
+uint32_t jobSteps = 0; // SS steps actually stepped in this job, excludes steps before a power cycle
+uint32_t segmentStart = 0; // ms, start of stepping since the last stop
+uint32_t rateWindowStart = 0; // us, start of the current peak rate window
+uint32_t rateWindowSteps = 0;
+
+// Startup splash, drawn while the machine starts
+uint32_t splashStart = 0; // ms
+uint8_t splashDrawn = 0; // characters on the display, the version is the last
+long splashEncoder = 0; // encoder position when the splash started
+bool splashRunning = false;
+
+// Define serial command console
+Console console = Console();
+
+// Define step trace recorder, enabled from the console
+#if defined(ARDUINO_TEENSY41)
+  SdTraceSink traceSink = SdTraceSink();
+#else
+  FileTraceSink traceSink = FileTraceSink("TRACE.BIN"); // Host simulation builds
+#endif
+StepTrace stepTrace = StepTrace();
+bool traceEnabled = false;
+
+// Define DMA step backend, falls back to the loop when the pins are not DMA capable
+#if STEP_DMA
+  DmaStepper dmaStepper = DmaStepper();
+#endif
+bool dmaStepping = false;
+
 // Function definition
 void choosePreset();
 void valSelect();
 void confirmScreen();
 void spin();
-void zeroCarriage();
-void motorFault(String);
+bool windGpio();
+bool windDma();
+bool pauseWinding();
+void startRateWindow();
+void countSteps(uint32_t);
+void showPercent(uint8_t);
+void printProgress(uint8_t);
+bool zeroCarriage();
+bool homeCarriage();
+bool moveCarriage(int32_t, int32_t);
+int32_t machinePosition(int32_t);
+void faultStop();
+void faultScreen();
+void watchdogWarning();
+void feedWatchdog();
 void stepCC();
 void stepSS();
 void stepBoth();
+void stepIdle();
 void pauseSpin();
 void completionScreen();
-String formatVal(uint32_t, uint32_t);
-uint32_t valEditor(uint32_t, uint32_t);
-WireGauge gaugeEditor(WireGauge);
+void startSplash();
+void updateSplash(bool);
+void resumeScreen();
+void resumeJob();
+void discardJob();
+void startJob();
+void finishJob(JobStatus, uint32_t);
+void logCommand(String);
+void statsCommand(String);
+void faultsCommand(String);
+void traceCommand(String);
+void benchCommand(String);
+void setCommand(String);
+void pitchesCommand(String);
+void sectionCommand(String);
+void wireCommand(String);
+void statusCommand(String);
+void startCommand(String);
+void resumeCommand(String);
+void timingCommand(String);
+void homeCommand(String);
+void speedCommand(String);
+int16_t runMenu();
+uint32_t getLength();
+uint32_t getRadius();
+uint32_t getInductance();
+uint32_t getGauge();
+uint32_t getPattern();
+uint32_t getTurns();
+uint32_t getCoilsPerHour();
+uint32_t getAvgWindTime();
+void setLength(uint32_t);
+void setRadius(uint32_t);
+void setInductance(uint32_t);
+void setGauge(uint32_t);
+void setPattern(uint32_t);
+String formatGauge(uint32_t);
+String formatPattern(uint32_t);
+String formatTurns(uint32_t);
+String formatRestart(uint32_t);
+String formatTenths(uint32_t);
+String formatMinutes(uint32_t);
+String formatEta(uint32_t);
+String formatWire(uint32_t);
+String formatDiameter(uint32_t);
+
+// Menu tables
+const char *const presetLabels[] PROGMEM = {"A", "B", "C", "D", "None"};
+const Preset presetValues[] PROGMEM = {Preset::A, Preset::B, Preset::C, Preset::D, Preset::None};
+const MenuOptions presetMenu PROGMEM = {"Presets:", presetLabels, 5};
+
+const MenuField jobFields[] PROGMEM = {
+  {"length", "Length (cm)", MenuFieldType::FIELD_NUMBER, MAX_LENGTH, getLength, setLength, nullptr},
+  {"radius", "Radius (cm)", MenuFieldType::FIELD_NUMBER, MAX_RADIUS, getRadius, setRadius, nullptr},
+  {"inductance", "Inductance (mH)", MenuFieldType::FIELD_NUMBER, MAX_INDUCTANCE, getInductance, setInductance, nullptr},
+  {"gauge", "Wire Gauge", MenuFieldType::FIELD_CHOICE, MAX_GAUGE, getGauge, setGauge, formatGauge},
+  {"pattern", "Pattern", MenuFieldType::FIELD_CHOICE, MAX_PATTERN, getPattern, setPattern, formatPattern},
+  {"turns", "Confirm", MenuFieldType::FIELD_ACTION, 0, getTurns, nullptr, formatTurns},
+};
+#define JOB_FIELD_COUNT (sizeof(jobFields) / sizeof(jobFields[0]))
+
+const char *const confirmLabels[] PROGMEM = {"Yes", "No"};
+const MenuOptions confirmMenu PROGMEM = {"Begin Process?", confirmLabels, 2};
 
+const char *const pauseLabels[] PROGMEM = {"Resume", "Restart"};
+const MenuOptions pauseMenu PROGMEM = {"Paused", pauseLabels, 2};
 
-void setup() {
+const char *const faultLabels[] PROGMEM = {"Retry", "Abort"};
+const MenuOptions faultMenu PROGMEM = {"FAULT", faultLabels, 2};
+
+const char *const resumeLabels[] PROGMEM = {"Resume", "Discard"};
+const MenuOptions resumeMenu PROGMEM = {"Unfinished job", resumeLabels, 2};
+
+const MenuField completionFields[] PROGMEM = {
+  {"done", "Completed!", MenuFieldType::FIELD_ACTION, 0, getTurns, nullptr, formatRestart},
+  {"coils", "Coils/h", MenuFieldType::FIELD_ACTION, 0, getCoilsPerHour, nullptr, formatTenths},
+  {"wind", "Avg wind time", MenuFieldType::FIELD_ACTION, 0, getAvgWindTime, nullptr, formatMinutes},
+};
+#define COMPLETION_FIELD_COUNT (sizeof(completionFields) / sizeof(completionFields[0]))
+
+
+FLASHMEM void setup() {
+  Serial.begin(9600);
   #if DEBUG 
-    Serial.begin(9600);
     Serial.println("Swinder v1.0 - Debug Mode");
   #endif
 
@@ -93,12 +300,19 @@ void setup() {
   lcd.init();
   lcd.clear();
   lcd.backlight();
-  lcd.setCursor(0, 0);
-  lcd.print("Hello World!");
 
   // Initialize Rotary Encoder
+  #if ENCODER_HW
+    if (!encoder.begin(RE_A_PIN, RE_B_PIN)) {
+      Serial.println("Encoder pins have no hardware decoder input");
+    }
+  #endif
   encoder.write(0);
   pinMode(RE_BUTTON_PIN, INPUT);
+  menu.begin(lcd);
+
+  // Splash runs on from loop() while the rest starts
+  startSplash();
 
   // Initialize Solenoid
   solenoid.begin(Preset::None);
@@ -123,10 +337,67 @@ void setup() {
   pinMode(SS_FAULT_PIN, INPUT);
   digitalWrite(SS_DIR_PIN, SS_DIR_SET);
   digitalWrite(SS_SLEEP_PIN, LOW);
+  updateSplash(false);
+
+  // Initialize fault monitoring and job checkpoint
+  faultMonitor.begin(SS_FAULT_PIN, CC_FAULT_PIN);
+  checkpoint.begin();
+
+  // Initialize deadline counters, a hang is counted once the machine is back
+  deadlineMonitor.begin();
+  watchdogReset = Watchdog::causedReset();
+  if (watchdogReset) {
+    deadlineMonitor.recordWatchdogReset();
+  }
+
+  // Unfinished work goes straight to its prompt
+  if (checkpoint.valid()) {
+    task = Tasks::Resume;
+    updateSplash(true);
+  }
+
+  // Initialize wire table
+  wireTable.begin();
+
+  // Initialize production log
+  jobLog.begin();
+  logSummary = jobLog.summary();
+  updateSplash(false);
+
+  // Initialize serial commands
+  console.begin(Serial);
+  console.addCommand("log", "Dump the job log as CSV", logCommand);
+  console.addCommand("stats", "Coils per hour and average wind time", statsCommand);
+  console.addCommand("faults", "Lifetime motor fault counts", faultsCommand);
+  console.addCommand("trace", "on|off, record step traces to SD", traceCommand);
+  console.addCommand("bench", "[steps], time the step logic for the highest step rate", benchCommand);
+  console.addCommand("set", "<field> <value>, jump a job value, e.g. set inductance 12345.67", setCommand);
+  console.addCommand("pitches", "[pitch...], custom pattern pitch per layer, percent of the wire", pitchesCommand);
+  console.addCommand("section", "[add <offset> <length> <turns> <gauge> | clear], coils on one mandrel", sectionCommand);
+  console.addCommand("wire", "[grade <1|2> | <gauge> <diameter um> | <gauge> clear], wire diameters", wireCommand);
+  console.addCommand("status", "Machine state and job progress", statusCommand);
+  console.addCommand("start", "Start a job with the current values", startCommand);
+  console.addCommand("resume", "[discard], continue or drop the job left unfinished at power on", resumeCommand);
+  console.addCommand("timing", "Step deadline overruns and watchdog resets", timingCommand);
+  console.addCommand("home", "Home the carriage before the next job", homeCommand);
+  console.addCommand("speed", "on|off, SS rate by layer radius and carriage position", speedCommand);
+  if (watchdogReset) {
+    console.stream().println("Reset by the watchdog");
+  }
 
-  #if !DEBUG
-    startupAnimation();
+  // Initialize step trace
+  stepTrace.begin(traceSink);
+  traceSink.setWait(feedWatchdog);
+
+  // Initialize DMA step backend
+  #if STEP_DMA
+    dmaStepping = dmaStepper.begin(SS_STEP_PIN, CC_STEP_PIN, CC_DIR_PIN, CC_DIR_SET);
+    dmaStepper.attachTrace(stepTrace);
+    if (!dmaStepping) {
+      Serial.println("DMA stepping unavailable, using GPIO");
+    }
   #endif
+
   #if DEBUG
     // Math checks
     solenoid.setPreset(Preset::Debug);
@@ -137,6 +408,9 @@ void setup() {
     Serial.println("Num Turns: " + String(solenoid.getTurns()));
     Serial.println("Expected Values: L = 1234, 12.34 : R = 123, 1.23 : I = 1234567, 12345.67 : Gauge = AWG24 : Num Turns = 50504");
   #endif
+
+  // Every loop that can run for seconds feeds it from here on
+  watchdog.begin(watchdogWarning);
 }
 
 void loop() {
@@ -149,6 +423,17 @@ void loop() {
   -End
   -Restart
   */
+  watchdog.feed();
+
+  // Startup splash, any input or a serial command that moves on ends it
+  if (splashRunning) {
+    const Tasks bootTask = task;
+    console.poll();
+    updateSplash(task != bootTask);
+    delay(1);
+    return;
+  }
+
   switch (task) {
     case Tasks::ChoosePreset:
       #if DEBUG
@@ -174,12 +459,24 @@ void loop() {
       #endif
       spin();
       break;
+    case Tasks::Fault:
+      #if DEBUG
+        Serial.println("Current Task: faultScreen");
+      #endif
+      faultScreen();
+      break;
     case Tasks::End:
       #if DEBUG
         Serial.println("Current Task: end");
       #endif
       completionScreen();
       break;
+    case Tasks::Resume:
+      #if DEBUG
+        Serial.println("Current Task: resumeScreen");
+      #endif
+      resumeScreen();
+      break;
     default:
       task = Tasks::ChoosePreset;
   }
@@ -188,436 +485,253 @@ void loop() {
 
 /*
 Select preset screen
--Rotate Clockwise: Move Cursor Right
--Rotate Counterclockwise: Move Cursor Left
+-Rotate: Move between presets
 -Press: Select Preset
 */
 void choosePreset() {
-  uint8_t cursorIndex = 1;
-  long reOldPosition = encoder.read() / 4;
-
-  // Screen setup
-  lcd.clear();
-  lcd.setCursor(0, 0);
-  lcd.print("Presets:");
-  lcd.setCursor(0, 1);
-  lcd.print(" A B C D None");
-  lcd.setCursor(cursorIndex, 1);
-  lcd.cursor();
-  lcd.blink();
+  menu.showOptions(presetMenu, 0);
+  int16_t selected = runMenu();
+  if (selected == MENU_NONE) {
+    return;
+  }
 
-  // Selection loop
-  while (true) {
-    // Trigger selection on button press
-    if (digitalRead(RE_BUTTON_PIN) == LOW) {
-      delay(BUTTON_DELAY);
+  #if DEBUG
+    Serial.println("Preset: " + String(presetLabels[selected]));
+  #endif
 
-      #if DEBUG
-        Serial.println("B!");
-      #endif
+  solenoid.setPreset(presetValues[selected]);
+  task = Tasks::ValEdit;
+}
 
-      // Set preset
-      switch (cursorIndex) {
-        case 1:
-          solenoid.setPreset(Preset::A);
-          break;
-        case 3:
-          solenoid.setPreset(Preset::B);
-          break;
-        case 5:
-          solenoid.setPreset(Preset::C);
-          break;
-        case 7:
-          solenoid.setPreset(Preset::D);
-          break;
-        default:
-          solenoid.setPreset(Preset::None);
-      }
-      
-      // Set task to val editing
-      task = Tasks::ValEdit;
+/*
+Value select screen
+-Rotate: Move between values
+-Press: Edit value, or continue on Confirm
+While editing:
+-Rotate: Move between digits and Done
+-Press on a digit: Start/stop changing it
+-Press on Done: Keep the value
+*/
+void valSelect() {
+  menu.showFields(jobFields, JOB_FIELD_COUNT, 0);
+  if (runMenu() != MENU_NONE) {
+    task = Tasks::ConfirmScreen;
+  }
+}
 
-      // Reset lcd
-      lcd.noCursor();
-      lcd.noBlink();
+/*
+Confirmation screen
+-Rotate: Move between Yes/No
+-Press: Confirm Yes/No
+*/
+void confirmScreen() {
+  menu.showOptions(confirmMenu, 0);
+  int16_t selected = runMenu();
+  if (selected == 0) {
+    // Fresh job, drop anything left over from an aborted one
+    checkpoint.clear();
+    startJob();
+    task = Tasks::Spin;
+  } else if (selected != MENU_NONE) {
+    task = Tasks::ValEdit;
+  }
+}
 
-      return;
+// Runs the current menu screen until something is selected
+// Returns MENU_NONE if a serial command moved on to another task
+int16_t runMenu() {
+  const Tasks screenTask = task;
+  while (true) {
+    int16_t selected = menu.update(encoder.read() / 4, digitalRead(RE_BUTTON_PIN) == LOW);
+    if (selected != MENU_NONE) {
+      menu.hideCursor();
+
+      // The next screen or the spin loop must not see the same press
+      while (digitalRead(RE_BUTTON_PIN) == LOW) {
+        watchdog.feed();
+        console.poll();
+        delay(1);
+      }
+      delay(BUTTON_DEBOUNCE);
+      return selected;
     }
 
-    // Read encoder
-    long reNewPosition = encoder.read() / 4;
-    int16_t dir = reNewPosition - reOldPosition;
-    if (dir > 0 && cursorIndex < 9) {
-      cursorIndex += 2;
-    } else if (dir < 0 && cursorIndex > 1) {
-      cursorIndex -= 2;
+    // Serial commands
+    watchdog.feed();
+    console.poll();
+    if (task != screenTask) {
+      menu.hideCursor();
+      return MENU_NONE;
     }
-    reOldPosition = reNewPosition;
-
-    // Update cursor
-    lcd.setCursor(cursorIndex, 1);
 
     // Stability delay
     delay(1);
   }
 }
 
-/*
-Value select Screen
--Rotate Clockwise: Move to next value
--Rotate Counterclockwise: Move to previous value
--Press: Begin editing value
-*/
-void valSelect() {
-  // Local vars
-  uint8_t screenIndex = 0;
-  bool screenChange = true;
-  long reOldPosition = encoder.read() / 4;
+// Menu field accessors
+uint32_t getLength() {
+  return solenoid.getLength();
+}
 
-  // Setup screen
-  lcd.clear();
+uint32_t getRadius() {
+  return solenoid.getRadius();
+}
 
-  while (true) {
-    if (screenChange) {
-      lcd.clear();
-      switch (screenIndex) {
-        case 0: // Length (cm)
-          lcd.setCursor(0, 0);
-          lcd.print("Length (cm)");
-          lcd.setCursor(0, 1);
-          lcd.print(formatVal(solenoid.getLength(), MAX_LENGTH));
-          break;
-        case 1: // Radius (cm)
-          lcd.setCursor(0, 0);
-          lcd.print("Radius (cm)");
-          lcd.setCursor(0, 1);
-          lcd.print(formatVal(solenoid.getRadius(), MAX_RADIUS));
-          break;
-        case 2: // Inductance (mH)
-          lcd.setCursor(0, 0);
-          lcd.print("Inductance (mH)");
-          lcd.setCursor(0, 1);
-          lcd.print(formatVal(solenoid.getInductance(), MAX_INDUCTANCE));
-          break;
-        case 3:
-          lcd.setCursor(0, 0);
-          lcd.print("Wire Gauge");
-          lcd.setCursor(0, 1);
-          lcd.print(solenoid.gaugeString());
-          break;
-        case 4: // Confirmation Screen
-          lcd.setCursor(0, 0);
-          lcd.print("Turns: ");
-          lcd.print(String(solenoid.getTurns()));
-          lcd.setCursor(0, 1);
-          lcd.print("Confirm");
-          break;
-      }
-      screenChange = false;
-    }
+uint32_t getInductance() {
+  return solenoid.getInductance();
+}
 
-    // Read button
-    if (digitalRead(RE_BUTTON_PIN) == LOW) {
-      delay(BUTTON_DELAY);
-      switch (screenIndex) {
-        case 0: // Length
-          solenoid.setLength(valEditor(solenoid.getLength(), MAX_LENGTH));
-          break;
-        case 1: // Radius
-          solenoid.setRadius(valEditor(solenoid.getRadius(), MAX_RADIUS));
-          break;
-        case 2: // Inductance
-          solenoid.setInductance(valEditor(solenoid.getInductance(), MAX_INDUCTANCE));
-          break;
-        case 3: // Gauge
-          solenoid.setGauge(gaugeEditor(solenoid.getGauge()));
-          break;
-        case 4: // Turns
-          task = Tasks::ConfirmScreen;
-          return;
-      }
-      reOldPosition = encoder.read() / 4;
-      screenChange = true;
-    }
+uint32_t getGauge() {
+  return solenoid.getGauge();
+}
 
-    // Read Encoder
-    long reNewPosition = encoder.read() / 4;
-    int16_t dir = reNewPosition - reOldPosition;
-    if (dir > 0 && screenIndex < 4) {
-      screenIndex += 1;
-      screenChange = true;
-    } else if (dir < 0 && screenIndex > 0) {
-      screenIndex -= 1;
-      screenChange = true;
-    }
-    reOldPosition = reNewPosition;
+uint32_t getPattern() {
+  return windPattern.getType();
+}
 
-    delay(1);
-  }
+uint32_t getTurns() {
+  return sections.count() > 0 ? sections.totalTurns() : solenoid.getTurns();
 }
 
-/*
-Decimal value editing Screen
-While not editing:
--Rotate Clockwise: Move cursor right
--Rotate Counterclockwise: Move cursor left
--Press: Begin editing digit or return if on 'Done'
-While editing:
--Rotate Clockwise: Increase current digit by 1
--Rotate Counterclockwise: Decrease current digit by 1
--Press: Finish editing
-*/
-uint32_t valEditor(uint32_t num, uint32_t max) {
-  uint32_t scaler = 1;
-  uint8_t maxLength = String(max).length() + 1;
-  uint8_t cursor_idx = maxLength - 1;
-  long reOldPosition = encoder.read() / 4;
-  bool editingDigit = false;
-  bool screenChange = true;
-
-  
-  lcd.setCursor(11, 1);
-  lcd.print("Done");
-  lcd.setCursor(cursor_idx, 1);
-  lcd.cursor_on();
+uint32_t getCoilsPerHour() {
+  return jobLog.summary().coilsPerHourX10;
+}
 
-  while (true) {
-    
-    // Read button
-    if (digitalRead(RE_BUTTON_PIN) == LOW) {
-      delay(BUTTON_DELAY * 2);
-      if (cursor_idx == 11) {
-        lcd.cursor_off();
-        lcd.blink_off();
-        return num;
-      } else {
-        editingDigit = !editingDigit;
-        if (editingDigit) {
-          lcd.blink_on();
-        } else {
-          lcd.blink_off();
-        }
-      }
-    }
+uint32_t getAvgWindTime() {
+  return jobLog.summary().avgWindTime;
+}
 
-    // Read Encoder
-    long reNewPosition = encoder.read() / 4;
-    int16_t dir = reNewPosition - reOldPosition;
-    if (editingDigit) { // Editing digit
-      if (dir > 0 && num + scaler <= max) {
-        num += scaler;
-        screenChange = true;
-      } else if (dir < 0 && num - scaler >= 0) {
-        num -= scaler;
-        screenChange = true;
-      }
-    } else { // Selecting digit
-      if (dir > 0 && cursor_idx < maxLength) {
-        cursor_idx++;
-        // Skip .
-        if (cursor_idx == maxLength - 3) {
-          cursor_idx++;
-        }
-        // Jump to done
-        if (cursor_idx == maxLength) {
-          cursor_idx = 11;
-        } else {
-          scaler /= 10;
-        }
-        
-        screenChange = true;
-      } else if (dir < 0 && cursor_idx > 0) {
-        cursor_idx--;
-        // Skip .
-        if (cursor_idx == maxLength - 3) {
-          cursor_idx--;
-        }
-        // Jump from done
-        if (cursor_idx == 10) {
-          cursor_idx = maxLength;
-        } else {
-          scaler *= 10;
-        }
-        
-        screenChange = true;
-      }
-    }
-    reOldPosition = reNewPosition;
+void setLength(uint32_t value) {
+  solenoid.setLength(value);
+}
 
-    // Update screen
-    if (screenChange) {
-      lcd.setCursor(0, 1);
-      lcd.print(formatVal(num, max));
-      lcd.setCursor(cursor_idx, 1);
-      screenChange = false;
-    }
-    
-    // Stability delay
-    delay(1);
-  }
+void setRadius(uint32_t value) {
+  solenoid.setRadius(value);
 }
 
-/*
-Gauge editing Screen
-While not editing:
--Rotate Clockwise: Move cursor right
--Rotate Counterclockwise: Move cursor left
--Press: Begin editing gauge or return if on 'Done'
-While editing:
--Rotate Clockwise: Increase gauge by 1
--Rotate Counterclockwise: Decrease gauge by 1
--Press: Finish editing
-*/
-WireGauge gaugeEditor(WireGauge gauge) {
-  uint8_t cursorIndex = 4;
-  bool editingGauge = false;
-  bool screenUpdate = true;
-  long reOldPosition = encoder.read() / 4;
+void setInductance(uint32_t value) {
+  solenoid.setInductance(value);
+}
 
-  lcd.setCursor(11, 1);
-  lcd.print("Done");
-  lcd.setCursor(cursorIndex, 1);
-  lcd.cursor_on();
+void setGauge(uint32_t value) {
+  solenoid.setGauge(static_cast<WireGauge>(value));
+}
 
-  while (true) {
-    // Read button
-    if (digitalRead(RE_BUTTON_PIN) == LOW) {
-      delay(BUTTON_DELAY);
-      if (cursorIndex == 11) {
-        lcd.cursor_off();
-        lcd.blink_off();
-        return gauge;
-      } else {
-        editingGauge = !editingGauge;
-        if (editingGauge) {
-          lcd.blink_on();
-        } else {
-          lcd.blink_off();
-        }
-      }
-    }
+void setPattern(uint32_t value) {
+  windPattern.setType(static_cast<PatternType>(value));
+}
 
-    long reNewPosition = encoder.read() / 4;
-    int16_t dir = reNewPosition - reOldPosition;
-    if (editingGauge) {
-      if (dir > 0 && gauge < MAX_GAUGE) {
-        gauge = static_cast<WireGauge>(gauge + 1);
-        screenUpdate = true;
-      } else if (dir < 0 && gauge > 0) {
-        gauge = static_cast<WireGauge>(gauge - 1);
-        screenUpdate = true;
-      }
-    } else {
-      if (dir > 0 && cursorIndex == 4) {
-        cursorIndex = 11;
-        screenUpdate = true;
-      } else if (dir < 0 && cursorIndex == 11) {
-        cursorIndex = 4;
-        screenUpdate = true;
-      }
-    }
-    reOldPosition = reNewPosition;
+String formatGauge(uint32_t value) {
+  return Solenoid::gaugeString(static_cast<WireGauge>(value));
+}
 
-    if (screenUpdate) {
-      lcd.setCursor(0, 1);
-      solenoid.setGauge(gauge);
-      lcd.print(solenoid.gaugeString());
-      lcd.setCursor(cursorIndex, 1);
-      screenUpdate = false;
-    }
-  }
+String formatPattern(uint32_t value) {
+  return WindPattern::typeString(static_cast<PatternType>(value));
 }
 
-/*
-Confirmation screen
--Rotate Clockwise: Move Cursor Right
--Rotate Counterclockwise: Move Cursor Left
--Press: Confirm Y/N
-*/
-void confirmScreen() {
-  uint8_t cursor_idx = 0;
-  long reOldPosition = encoder.read() / 4;
+String formatTurns(uint32_t value) {
+  return "Turns: " + String(value);
+}
 
-  lcd.clear();
-  lcd.setCursor(0, 0);
-  lcd.print("Begin Process?");
-  lcd.setCursor(0, 1);
-  lcd.print("Y/N");
-  lcd.setCursor(cursor_idx, 1);
-  lcd.cursor_on();
-  lcd.blink_on();
+String formatRestart(uint32_t value) {
+  return "Press to restart";
+}
 
-  while (true) {
-    // Read button
-    if (digitalRead(RE_BUTTON_PIN) == LOW) {
-      delay(BUTTON_DELAY);
-      lcd.blink_off();
-      lcd.cursor_off();
-
-      if (cursor_idx == 0) {
-        task = Tasks::Spin;
-        return;
-      } else {
-        task = Tasks::ValEdit;
-        return;
-      }
-    }
+String formatTenths(uint32_t value) {
+  return String(value / 10) + "." + String(value % 10);
+}
 
-    // Read encoder
-    long reNewPosition = encoder.read() / 4;
-    int16_t dir = reNewPosition - reOldPosition;
-    if (dir > 0 && cursor_idx == 0) {
-      cursor_idx = 2;
-    } else if (dir < 0 && cursor_idx == 2) {
-      cursor_idx = 0;
-    }
-    reOldPosition = reNewPosition;
+String formatMinutes(uint32_t value) {
+  return String(value / 60000) + "m" + String((value / 1000) % 60) + "s";
+}
 
-    lcd.setCursor(cursor_idx, 1);
+// Seconds as 12m05s, or 3h20m from an hour
+String formatEta(uint32_t value) {
+  if (value >= 100 * 3600) {
+    return "99h+";
+  }
+  uint32_t high = value >= 3600 ? value / 3600 : value / 60;
+  uint32_t low = value >= 3600 ? (value / 60) % 60 : value % 60;
+  return String(high) + (value >= 3600 ? "h" : "m") + (low < 10 ? "0" : "") + String(low) + (value >= 3600 ? "m" : "s");
+}
 
-    // Stability delay
-    delay(1);
-  } 
+// mm as metres, a decimal below 100m
+String formatWire(uint32_t value) {
+  if (value >= 100000) {
+    return String(value / 1000);
+  }
+  return String(value / 1000) + "." + String((value / 100) % 10);
+}
+
+// 0.001mm as 0.541mm
+String formatDiameter(uint32_t value) {
+  String micrometres = String(value % 1000);
+  while (micrometres.length() < 3) {
+    micrometres = "0" + micrometres;
+  }
+  return String(value / 1000) + "." + micrometres + "mm";
 }
 
 /*
 Major spin task
 -Press: Pauses
+Resumes from the checkpoint if one was left by a motor fault
 */
 void spin() {
-  // Start by zeroing carriage
-  zeroCarriage();
-  
-  // Calculate necessary values
-  const uint32_t SS_STEPS = solenoid.getTurns() * SS_STEPS_PER_REVOLUTION;
-  const uint32_t CC_DISTANCE_PER_REVOLUTION = (solenoid.gaugeDiameter() * 100) / DISTANCE_PER_STEP;
-  const uint32_t SS_STEP_PER_CC_STEP = (CC_STEPS_PER_REVOLUTION * 1000) / CC_DISTANCE_PER_REVOLUTION;
-
-  uint32_t stepCount = 0; // Step count
-  uint32_t subStepCount = 0; // Specifically to time carriage steps to avoid costly mod ops
-  int32_t carriagePosition = 0; // Should be zero after zeroing; 0.001 cm accuracy
-  bool direction = true; // True = forward
-  uint8_t oldPercentComplete = 0;
-
-  // Wake CC Motor
-  digitalWrite(CC_SLEEP_PIN, HIGH);
-  delay(20);
+  // Plan the job, continuing an interrupted one
+  const bool resuming = checkpoint.valid();
+  if (resuming) {
+    checkpoint.restore(solenoid, sections, windPattern);
+  }
+  if (sections.count() > 0) {
+    windKernel.begin(sections, windPattern, wireTable);
+  } else {
+    windKernel.begin(solenoid, windPattern, wireTable);
+  }
+  if (resuming) {
+    const JobCheckpoint &saved = checkpoint.data();
+    windKernel.restore(saved.stepCount, saved.subStepCount, saved.carriagePosition, saved.direction, saved.layer);
 
-  // Set starting directions
-  digitalWrite(CC_DIR_PIN, CC_DIR_SET);
+    // Progress is only in RAM from here, a power cut must not resume from this older point
+    checkpoint.clear();
+  }
+  jobEstimate.begin(windKernel, solenoid.getRadius(), 2 * MOTOR_DELAY);
+  speedProfile.begin(windKernel, solenoid.getRadius());
+
+  // A new job starts from the end of the winding area nearer the carriage
+  if (resuming) {
+    mirrored = checkpoint.data().mirrored;
+  } else {
+    mirrored = CARRIAGE_MIRROR && carriageKnown && abs(windKernel.mirrorEnd() - carriageAt) < abs(carriageAt);
+  }
+  ccForwardLevel = mirrored ? !CC_DIR_SET : CC_DIR_SET;
+  #if STEP_DMA
+    dmaStepper.setForwardLevel(ccForwardLevel);
+  #endif
 
-  // Apply starting offset
-  while (carriagePosition < CARRIAGE_OFFSET + PADDING) {
-    // Check for motor fault
-    if (digitalRead(CC_FAULT_PIN) == LOW) {
-      motorFault("CC");
+  // A hang from here on is saved by the watchdog warning from the progress kept in RAM
+  checkpoint.stage(solenoid, sections, windPattern, mirrored);
+  checkpoint.progress(windKernel.stepCount(), windKernel.subStepCount(), windKernel.position(), windKernel.forward(), windKernel.layer());
+
+  // Clear faults from before this job
+  faultMonitor.arm();
+
+  // The last job left the carriage in place, only power on, a fault or an abort needs homing
+  if (carriageKnown) {
+    carriageKnown = false; // Known again once this job completes
+    lcd.clear();
+    lcd.setCursor(0, 0);
+    lcd.print("Returning...");
+    if (!moveCarriage(carriageAt, machinePosition(windKernel.position()))) {
+      faultStop();
+      return;
     }
-
-    stepCC();
-    carriagePosition += DISTANCE_PER_STEP;
+  } else if (!homeCarriage()) {
+    faultStop();
+    return;
   }
-  // Set new offset position as 0 position
-  carriagePosition = 0;
+  digitalWrite(CC_DIR_PIN, windKernel.forward() ? ccForwardLevel : !ccForwardLevel);
 
   // Wake SS motor
   digitalWrite(SS_SLEEP_PIN, HIGH);
@@ -627,70 +741,133 @@ void spin() {
   digitalWrite(SS_DIR_PIN, SS_DIR_SET);
 
   // Setup Screen
-  lcd.clear();
-  lcd.setCursor(0, 0);
-  lcd.print("Percent Complete");
-  lcd.setCursor(0, 1);
-  lcd.print(String(oldPercentComplete) + "%");
+  showPercent(windKernel.percentComplete());
+
+  // Start step trace
+  if (traceEnabled && stepTrace.start(micros())) {
+    uint32_t now = micros();
+    stepTrace.mark(resuming ? TraceMark::MARK_RESUME : TraceMark::MARK_JOB_START, now);
+    stepTrace.meta(TraceMeta::META_LENGTH, solenoid.getLength(), now);
+    stepTrace.meta(TraceMeta::META_RADIUS, solenoid.getRadius(), now);
+    stepTrace.meta(TraceMeta::META_INDUCTANCE, solenoid.getInductance(), now);
+    stepTrace.meta(TraceMeta::META_GAUGE, solenoid.getGauge(), now);
+    stepTrace.meta(TraceMeta::META_TURNS, getTurns(), now);
+    stepTrace.meta(TraceMeta::META_STEP_COUNT, windKernel.stepCount(), now);
+    stepTrace.speedOverride(100, now);
+    stepTrace.direction(windKernel.forward(), windKernel.position(), now);
+  }
+
+  // Job statistics
+  segmentStart = millis();
+  startRateWindow();
+
+  // The DMA waveform has one step period, a scheduled rate needs the loop
+  if (!(dmaStepping && !speedProfiled ? windDma() : windGpio())) {
+    return;
+  }
+
+  // The carriage driver stays awake, the next job starts from here
+  carriageAt = machinePosition(windKernel.position());
+  carriageKnown = true;
+
+  // Job finished, nothing to resume
+  stepTrace.mark(TraceMark::MARK_JOB_END, micros());
+  stepTrace.stop();
+  currentJob.windTime += millis() - segmentStart;
+  finishJob(JobStatus::COMPLETED, windKernel.stepCount());
+  checkpoint.clear();
+
+  task = Tasks::End;
+  return;
+}
+
+/*
+Winding loop pulsing the STEP pins directly
+Returns false if a fault or an abort ended the job
+*/
+FASTRUN bool windGpio() {
+  uint8_t oldPercentComplete = windKernel.percentComplete();
+  uint16_t speedPercent = 100; // Rate of the step against MOTOR_DELAY, last traced
+  uint16_t pollCountdown = CONSOLE_POLL_STEPS; // Loop passes to the next console poll, carriage only steps count too
+  stepDelay = MOTOR_DELAY;
 
   #if DEBUG
     long startTime = micros();
   #endif
-  while (stepCount < SS_STEPS) {
-    // Check for motor faults
-    if (digitalRead(CC_FAULT_PIN) == LOW) {
-      motorFault("CC");
-    }
-    if (digitalRead(SS_FAULT_PIN) == LOW) {
-      motorFault("SS");
+  // Every step edge is due one step period after the last
+  deadlineMonitor.start(2 * MOTOR_DELAY, micros());
+  while (!windKernel.done()) {
+    watchdog.feed();
+
+    // Check for motor faults, latched by interrupt, and a stall the watchdog warned of, the drivers are asleep after both
+    if (faultMonitor.tripped() || watchdogWarned) {
+      currentJob.windTime += millis() - segmentStart;
+      faultStop();
+      return false;
     }
 
     // Read button
     if (digitalRead(RE_BUTTON_PIN) == LOW) {
-      delay(BUTTON_DELAY);
-
-      pauseSpin();
+      if (!pauseWinding()) {
+        return false;
+      }
+      speedProfile.restart();
+      deadlineMonitor.start(2 * MOTOR_DELAY, micros());
+    }
 
-      // Reset display after pause
-      lcd.clear();
-      lcd.setCursor(0, 0);
-      lcd.print("Percent Complete");
-      lcd.setCursor(0, 1);
-      lcd.print(String(oldPercentComplete) + "%");
+    // Serial commands, the next step is late by however long they take
+    if (--pollCountdown == 0) {
+      pollCountdown = CONSOLE_POLL_STEPS;
+      // Between steps, a hang resumes at most this many steps back
+      checkpoint.progress(windKernel.stepCount(), windKernel.subStepCount(), windKernel.position(), windKernel.forward(), windKernel.layer());
+      deadlineMonitor.enter(Subsystem::SUB_CONSOLE, micros());
+      console.poll();
+      deadlineMonitor.enter(Subsystem::SUB_ESTIMATE, micros());
+      jobEstimate.update(windKernel);
+      deadlineMonitor.enter(Subsystem::SUB_KERNEL, micros());
     }
 
+    uint8_t mask = windKernel.next();
+
     // Reverse carriage
-    if (carriagePosition > int(solenoid.getLength()) * 10 + PADDING) {
-      digitalWrite(CC_DIR_PIN, !CC_DIR_SET);
-      direction = false;
-    }
-    if (carriagePosition < PADDING) {
-      digitalWrite(CC_DIR_PIN, CC_DIR_SET);
-      direction = true;
+    if (mask & STEP_REVERSED) {
+      digitalWrite(CC_DIR_PIN, windKernel.forward() ? ccForwardLevel : !ccForwardLevel);
+      stepTrace.direction(windKernel.forward(), windKernel.lastReversal(), micros());
     }
 
-    // Step motor(s)
-    if (subStepCount == SS_STEP_PER_CC_STEP) {
+    // Step motor(s), the carriage moves alone between sections
+    const uint32_t now = micros();
+    deadlineMonitor.tick(now);
+    stepTrace.step(mask & (STEP_SS | STEP_CC), now);
+    if (!(mask & STEP_SS)) {
+      deadlineMonitor.setPeriod(2 * MOTOR_DELAY);
+      stepCC();
+      continue;
+    }
+    if (speedProfiled) {
+      stepDelay = speedProfile.next(windKernel);
+      deadlineMonitor.setPeriod(2 * stepDelay);
+      // Traced when the ramp changes level, the percent comes from the table of the layer
+      if (speedProfile.percent() != speedPercent) {
+        speedPercent = speedProfile.percent();
+        stepTrace.speedOverride(speedPercent, now);
+      }
+    }
+    if (mask & STEP_CC) {
       stepBoth();
-      carriagePosition += (direction ? DISTANCE_PER_STEP : -DISTANCE_PER_STEP);
-      subStepCount = 0;
     } else {
       stepSS();
     }
-
-    // Update counts
-    subStepCount++;
-    stepCount++;
+    countSteps(1);
 
     // Update % completion
-    
-    uint8_t newPercentComplete = (stepCount * 100) / SS_STEPS;
+    uint8_t newPercentComplete = windKernel.percentComplete();
     if (newPercentComplete != oldPercentComplete) {
-      lcd.setCursor(0, 1);
-      lcd.print(String(newPercentComplete) + "%");
+      deadlineMonitor.enter(Subsystem::SUB_DISPLAY, micros());
+      printProgress(newPercentComplete);
+      deadlineMonitor.enter(Subsystem::SUB_KERNEL, micros());
       oldPercentComplete = newPercentComplete;
     }
-    
 
     #if DEBUG
       long endTime = micros();
@@ -698,13 +875,166 @@ void spin() {
       startTime = endTime;
     #endif
   }
+  deadlineMonitor.stop();
+  return true;
+}
 
-  task = Tasks::End;
-  return;
+/*
+Winding loop refilling the DMA waveform buffers
+The kernel runs ahead of the motors, halting rewinds it to the played steps
+Returns false if a fault or an abort ended the job
+*/
+FASTRUN bool windDma() {
+  #if STEP_DMA
+    uint8_t oldPercentComplete = windKernel.percentComplete();
+
+    // A half buffer must be refilled before the other one has played
+    dmaStepper.start(windKernel, MOTOR_DELAY, 2);
+    deadlineMonitor.start(DMA_BLOCK_SLOTS * MOTOR_DELAY, micros());
+    while (dmaStepper.fill()) {
+      deadlineMonitor.tick(micros());
+      watchdog.feed();
+
+      // Every filled step plays out if the loop hangs from here, the progress the warning saves
+      checkpoint.progress(windKernel.stepCount(), windKernel.subStepCount(), windKernel.position(), windKernel.forward(), windKernel.layer());
+
+      // Check for motor faults, latched by interrupt, and a stall the watchdog warned of
+      if (faultMonitor.tripped() || watchdogWarned) {
+        dmaStepper.halt();
+        countSteps(dmaStepper.takePlayedSteps());
+        currentJob.windTime += millis() - segmentStart;
+        faultStop();
+        return false;
+      }
+
+      // Read button
+      if (digitalRead(RE_BUTTON_PIN) == LOW) {
+        dmaStepper.halt();
+        countSteps(dmaStepper.takePlayedSteps());
+        if (!pauseWinding()) {
+          return false;
+        }
+        dmaStepper.start(windKernel, MOTOR_DELAY, 2);
+        deadlineMonitor.start(DMA_BLOCK_SLOTS * MOTOR_DELAY, micros());
+      }
+
+      countSteps(dmaStepper.takePlayedSteps());
+
+      // Update % completion, ahead by at most the buffered steps
+      deadlineMonitor.enter(Subsystem::SUB_ESTIMATE, micros());
+      jobEstimate.update(windKernel);
+      uint8_t newPercentComplete = windKernel.percentComplete();
+      if (newPercentComplete != oldPercentComplete) {
+        deadlineMonitor.enter(Subsystem::SUB_DISPLAY, micros());
+        printProgress(newPercentComplete);
+        oldPercentComplete = newPercentComplete;
+      }
+
+      // Idle time is used to write the step trace and answer serial commands
+      deadlineMonitor.enter(Subsystem::SUB_TRACE, micros());
+      stepTrace.service();
+      deadlineMonitor.enter(Subsystem::SUB_CONSOLE, micros());
+      console.poll();
+      deadlineMonitor.enter(Subsystem::SUB_KERNEL, micros());
+    }
+    deadlineMonitor.stop();
+    countSteps(dmaStepper.takePlayedSteps());
+
+    #if DEBUG
+      Serial.println("DMA underruns: " + String(dmaStepper.underruns()));
+    #endif
+  #endif
+  return true;
+}
+
+// Pauses the winding loop, returns false if restart was chosen and the job aborted
+bool pauseWinding() {
+  deadlineMonitor.stop();
+  currentJob.windTime += millis() - segmentStart;
+  currentJob.pauses++;
+  stepTrace.mark(TraceMark::MARK_PAUSE, micros());
+  delay(BUTTON_DELAY);
+
+  // A machine switched off while paused offers to resume at the next power on
+  checkpoint.save(solenoid, sections, windPattern, windKernel.stepCount(), windKernel.subStepCount(), windKernel.position(), windKernel.forward(), mirrored, windKernel.layer());
+
+  pauseSpin();
+  checkpoint.clear();
+  checkpoint.stage(solenoid, sections, windPattern, mirrored);
+
+  // Restart chosen from the pause screen
+  if (task != Tasks::Spin) {
+    stepTrace.mark(TraceMark::MARK_JOB_END, micros());
+    stepTrace.stop();
+    finishJob(JobStatus::ABORTED, windKernel.stepCount());
+    return false;
+  }
+  stepTrace.mark(TraceMark::MARK_RESUME, micros());
+
+  // Faults while paused are not relevant, drivers were asleep
+  faultMonitor.arm();
+
+  // Restart statistics timing
+  segmentStart = millis();
+  startRateWindow();
+
+  // Reset display after pause
+  showPercent(windKernel.percentComplete());
+  return true;
+}
+
+// Starts a new peak rate window
+void startRateWindow() {
+  rateWindowStart = micros();
+  rateWindowSteps = 0;
+}
+
+// Counts stepped SS steps and tracks the peak step rate
+FASTRUN void countSteps(uint32_t steps) {
+  jobSteps += steps;
+  rateWindowSteps += steps;
+  if (rateWindowSteps >= RATE_WINDOW) {
+    uint32_t now = micros();
+    uint32_t rate = ((uint64_t) rateWindowSteps * 1000000UL) / (now - rateWindowStart);
+    if (rate > currentJob.peakRate) {
+      currentJob.peakRate = rate;
+    }
+    jobEstimate.measure(rate);
+    rateWindowStart = now;
+    rateWindowSteps = 0;
+  }
+}
+
+// Draws the spin screen
+void showPercent(uint8_t percent) {
+  lcd.clear();
+  printProgress(percent);
+}
+
+// Writes percent and time left on the top line, wire used of the job below
+// Lines are padded so a shorter one covers the last
+void printProgress(uint8_t percent) {
+  String top = String(percent) + "%";
+  while (top.length() < 5) {
+    top += " ";
+  }
+  top += "Left " + formatEta(jobEstimate.remainingTime(windKernel));
+  String bottom = "Wire " + formatWire(jobEstimate.wireUsed(windKernel)) + "/" + formatWire(jobEstimate.wireTotal()) + "m";
+  while (top.length() < 16) {
+    top += " ";
+  }
+  while (bottom.length() < 16) {
+    bottom += " ";
+  }
+  lcd.setCursor(0, 0);
+  lcd.print(top);
+  lcd.setCursor(0, 1);
+  lcd.print(bottom);
 }
 
 // Moves carriage towards 0 position till the start limit switch is hit
-void zeroCarriage() {
+// Returns false if a motor fault stopped the move
+bool zeroCarriage() {
   // Setup Screen
   lcd.clear();
   lcd.setCursor(0, 0);
@@ -720,9 +1050,11 @@ void zeroCarriage() {
   digitalWrite(CC_DIR_PIN, !CC_DIR_SET);
 
   while (true) {
+    watchdog.feed();
+
     // Check for fault
-    if (digitalRead(CC_FAULT_PIN) == LOW) {
-      motorFault("CC");
+    if (faultMonitor.tripped() || watchdogWarned) {
+      return false;
     }
 
     // Usual behavior is to check start limit switch, but allow manual zero as well for debugging
@@ -732,96 +1064,209 @@ void zeroCarriage() {
       lcd.print("Zeroing Complete");
       delay(BUTTON_DELAY);
 
-      return;
+      return true;
     } else {
       stepCC();
     }
   }
 }
 
+// Zeroes the carriage and moves it out to the offset, then to where the job starts or stopped
+// Returns false if a motor fault stopped the move
+bool homeCarriage() {
+  int32_t carriagePosition = 0; // Should be zero after zeroing; 0.001 cm accuracy
+
+  // Start by zeroing carriage
+  if (!zeroCarriage()) {
+    return false;
+  }
+
+  // Wake CC Motor
+  digitalWrite(CC_SLEEP_PIN, HIGH);
+  delay(20);
+
+  // Set starting directions
+  digitalWrite(CC_DIR_PIN, CC_DIR_SET);
+
+  // Apply starting offset
+  while (carriagePosition < CARRIAGE_OFFSET + PADDING) {
+    watchdog.feed();
+
+    // Check for motor fault or a stall
+    if (faultMonitor.tripped() || watchdogWarned) {
+      return false;
+    }
+
+    stepCC();
+    carriagePosition += DISTANCE_PER_STEP;
+  }
+  // Set new offset position as 0 position
+  carriagePosition = 0;
+
+  // Return to where an interrupted job stopped
+  while (carriagePosition < machinePosition(windKernel.position())) {
+    watchdog.feed();
+    if (faultMonitor.tripped() || watchdogWarned) {
+      return false;
+    }
+
+    stepCC();
+    carriagePosition += DISTANCE_PER_STEP;
+  }
+  return true;
+}
+
+// Moves the carriage between positions relative to the offset, ramped from CARRIAGE_RAPID_START
+// Stops on the target or one step past it, returns false if a motor fault stopped the move
+bool moveCarriage(int32_t from, int32_t to) {
+  const uint32_t steps = (abs(to - from) + DISTANCE_PER_STEP - 1) / DISTANCE_PER_STEP;
+  digitalWrite(CC_DIR_PIN, to > from ? CC_DIR_SET : !CC_DIR_SET);
+
+  for (uint32_t i = 0; i < steps; i++) {
+    watchdog.feed();
+    if (faultMonitor.tripped() || watchdogWarned) {
+      return false;
+    }
+
+    // Accelerates away from the start and brakes into the target, whichever is nearer
+    const uint32_t ramp = i < steps - 1 - i ? i : steps - 1 - i;
+    float rate = sqrtf((float) CARRIAGE_RAPID_START * CARRIAGE_RAPID_START + 2.0f * CARRIAGE_RAPID_ACCEL * ramp);
+    if (rate > CARRIAGE_RAPID_RATE) {
+      rate = CARRIAGE_RAPID_RATE;
+    }
+    const uint32_t halfPeriod = 500000.0f / rate;
+    digitalWrite(CC_STEP_PIN, HIGH);
+    delayMicroseconds(halfPeriod);
+    digitalWrite(CC_STEP_PIN, LOW);
+    delayMicroseconds(halfPeriod);
+  }
+  return true;
+}
+
+// Carriage position relative to the offset of a position of the plan
+int32_t machinePosition(int32_t position) {
+  return mirrored ? windKernel.mirrorEnd() - position : position;
+}
+
 /*
 Pause screen
--Rotate Clockwise: Move Cursor Right
--Rotate Counterclockwise: Move Cursor Left
+-Rotate: Move between Resume/Restart
 -Press: Confirm Resume/Restart
 */
 void pauseSpin() {
-  uint8_t cursorIndex = 0;
-  long reOldPosition = encoder.read() / 4;
-
   // Sleep Motors
   digitalWrite(CC_SLEEP_PIN, LOW);
   digitalWrite(SS_SLEEP_PIN, LOW);
 
-  // Setup Screen
-  lcd.clear();
-  lcd.setCursor(0, 0);
-  lcd.print("Paused");
-  lcd.setCursor(0, 1);
-  lcd.print("Resume  Restart");
-  lcd.setCursor(cursorIndex, 1);
-  lcd.cursor_on();
-  lcd.blink_on();
+  menu.showOptions(pauseMenu, 0);
+  if (runMenu() == 0) {
+    // Wake motors and return
+    digitalWrite(CC_SLEEP_PIN, HIGH);
+    digitalWrite(SS_SLEEP_PIN, HIGH);
+  } else {
+    // Return to value editor
+    task = Tasks::ValEdit;
+  }
+}
 
-  while (true) {
-    // Read Button
-    if (digitalRead(RE_BUTTON_PIN) == LOW) {
-      delay(BUTTON_DELAY);
-      lcd.blink_off();
-      lcd.cursor_off();
-      if (cursorIndex == 0) {
-        // Wake motors and return
-        digitalWrite(CC_SLEEP_PIN, HIGH);
-        digitalWrite(SS_SLEEP_PIN, HIGH);
-        return;
-      } else {
-        // Return to value editor
-        task = Tasks::ValEdit;
-        return;
-      }
-    }
+/*
+Controlled stop on a latched motor fault or a stall the watchdog warned of
+Sleeps both drivers and saves the kernel progress so the job can be retried
+*/
+FASTRUN void faultStop() {
+  // Sleep both motors
+  digitalWrite(SS_SLEEP_PIN, LOW);
+  digitalWrite(CC_SLEEP_PIN, LOW);
+  deadlineMonitor.stop();
+  watchdogWarned = false;
 
-    // Read encoder
-    long reNewPosition = encoder.read() / 4;
-    int16_t dir = reNewPosition - reOldPosition;
-    if (dir > 0 && cursorIndex == 0) {
-      cursorIndex = 8;
-    } else if (dir < 0 && cursorIndex == 8) {
-      cursorIndex = 0;
-    }
-    reOldPosition = reNewPosition;
+  #if DEBUG
+    Serial.println("Motor fault at step " + String(windKernel.stepCount()) + ", SS: " + String(faultMonitor.tripped(Motor::SS_MOTOR)) + " CC: " + String(faultMonitor.tripped(Motor::CC_MOTOR)));
+  #endif
 
-    // Stability delay
-    delay(1);
+  stepTrace.mark(TraceMark::MARK_FAULT, micros());
+  stepTrace.stop();
+
+  faultMonitor.commit();
+  if (currentJob.faults < 0xFF) {
+    currentJob.faults++;
   }
+  checkpoint.save(solenoid, sections, windPattern, windKernel.stepCount(), windKernel.subStepCount(), windKernel.position(), windKernel.forward(), mirrored, windKernel.layer());
+
+  task = Tasks::Fault;
+}
+
+/*
+Watchdog warning, the loop has not come round for seconds and the reset follows
+Leaves the drivers asleep and writes the job at the last progress the winding loop kept,
+never the kernel it may have interrupted mid-step. If the loop comes round after all it
+stops the job as on a fault
+*/
+FASTRUN void watchdogWarning() {
+  digitalWrite(SS_SLEEP_PIN, LOW);
+  digitalWrite(CC_SLEEP_PIN, LOW);
+  watchdogWarned = true;
+  checkpoint.commit();
+}
+
+// Keeps the watchdog fed through the slow SD card operations of the step trace
+void feedWatchdog() {
+  watchdog.feed();
 }
 
 /*
 Motor fault screen
-Unresolvable error - requires restart
+-Rotate: Move between Retry/Abort
+-Press: Retry once the driver has recovered / Abort the job
 */
-void motorFault(String motorName) {
+void faultScreen() {
+  // Build fault message from latched motors
+  String message = "FAULT ";
+  for (uint8_t i = 0; i < MOTOR_COUNT; i++) {
+    Motor motor = static_cast<Motor>(i);
+    if (faultMonitor.tripped(motor)) {
+      message += FaultMonitor::motorName(motor) + " #" + String(faultMonitor.count(motor)) + " ";
+    }
+  }
+  // Neither driver faulted, the watchdog warned of a stall
+  if (!faultMonitor.tripped()) {
+    message += "STALL";
+  }
+
   #if DEBUG
-    Serial.println("Motor fault on motor: " + motorName);
+    Serial.println("Lifetime faults, SS: " + String(faultMonitor.count(Motor::SS_MOTOR)) + " CC: " + String(faultMonitor.count(Motor::CC_MOTOR)));
   #endif
 
-  // Sleep both motors
-  digitalWrite(SS_SLEEP_PIN, LOW);
-  digitalWrite(CC_SLEEP_PIN, LOW);
+  menu.showOptions(faultMenu, 0);
+  menu.setTitle(message);
+  while (true) {
+    if (runMenu() == 1) {
+      // Drop the job and return to value editor
+      finishJob(JobStatus::ABORTED, checkpoint.data().stepCount);
+      checkpoint.clear();
+      task = Tasks::ValEdit;
+      return;
+    }
 
-  // Error message
-  lcd.clear();
-  lcd.setCursor(0, 0);
-  lcd.print("!!MOTOR  FAULT!!");
-  lcd.setCursor(0, 1);
-  lcd.print(motorName + " Motor");
-  
-  // Infinite loop till restart
-  while (true) {delay(1);}
+    // Waking resets the DRV8825 fault latch, overtemperature clears on its own
+    digitalWrite(SS_SLEEP_PIN, HIGH);
+    digitalWrite(CC_SLEEP_PIN, HIGH);
+    delay(FAULT_RECOVERY_DELAY);
+
+    if (faultMonitor.recovered()) {
+      task = Tasks::Spin;
+      return;
+    }
+
+    // Still faulted, back to sleep
+    digitalWrite(SS_SLEEP_PIN, LOW);
+    digitalWrite(CC_SLEEP_PIN, LOW);
+    menu.setTitle("Not recovered");
+  }
 }
 
 // Step carriage control motor one step
-void stepCC() {
+FASTRUN void stepCC() {
   digitalWrite(CC_STEP_PIN, HIGH);
   delayMicroseconds(MOTOR_DELAY);
   digitalWrite(CC_STEP_PIN, LOW);
@@ -829,86 +1274,555 @@ void stepCC() {
 }
 
 // Step solenoid spin motor one step
-void stepSS() {
+FASTRUN void stepSS() {
   digitalWrite(SS_STEP_PIN, HIGH);
-  delayMicroseconds(MOTOR_DELAY);
+  delayMicroseconds(stepDelay);
   digitalWrite(SS_STEP_PIN, LOW);
-  delayMicroseconds(MOTOR_DELAY);
+  stepIdle();
 }
 
 // Combined step function to eliminate out of sync steps and stuttering
-void stepBoth() {
+FASTRUN void stepBoth() {
   digitalWrite(CC_STEP_PIN, HIGH);
   digitalWrite(SS_STEP_PIN, HIGH);
-  delayMicroseconds(MOTOR_DELAY);
+  delayMicroseconds(stepDelay);
   digitalWrite(CC_STEP_PIN, LOW);
   digitalWrite(SS_STEP_PIN, LOW);
-  delayMicroseconds(MOTOR_DELAY);
+  stepIdle();
+}
+
+// Low half of a winding step, idle time is used to write the step trace
+FASTRUN void stepIdle() {
+  uint32_t start = micros();
+  deadlineMonitor.enter(Subsystem::SUB_TRACE, start);
+  stepTrace.service();
+  uint32_t elapsed = micros() - start;
+  deadlineMonitor.enter(Subsystem::SUB_KERNEL, start + elapsed);
+  if (elapsed < stepDelay) {
+    delayMicroseconds(stepDelay - elapsed);
+  }
 }
 
+/*
+Completion screen
+-Rotate: Move between completion and production stats
+-Press: Restart
+*/
 void completionScreen() {
-  // Setup Screen
+  menu.showFields(completionFields, COMPLETION_FIELD_COUNT, 0);
+  if (runMenu() != MENU_NONE) {
+    task = Tasks::ValEdit;
+  }
+}
+
+// Starts the startup splash, updateSplash() draws it
+FLASHMEM void startSplash() {
   lcd.clear();
-  lcd.setCursor(0, 0);
-  lcd.print("Completed!");
-  lcd.setCursor(0, 1);
-  lcd.print("Press to restart");
+  lcd.setCursor(2, 0);
+  splashStart = millis();
+  splashDrawn = 0;
+  splashEncoder = encoder.read();
+  splashRunning = true;
+}
 
-  while (true) {
-    // Read button
-    if (digitalRead(RE_BUTTON_PIN) == LOW) {
-      delay(BUTTON_DELAY);
-      
-      task = Tasks::ValEdit;
-      return;
-    }
+/*
+  Draws the splash characters that are due, one every SPLASH_CHAR_TIME then the version
+  Ends after SPLASH_HOLD_TIME, or straight away on skip or a turn or press of the encoder
+*/
+void updateSplash(bool skip) {
+  if (!splashRunning) {
+    return;
+  }
+  if (skip || digitalRead(RE_BUTTON_PIN) == LOW || encoder.read() != splashEncoder) {
+    splashRunning = false;
+    return;
+  }
 
-    delay(1);
+  const uint8_t length = sizeof(SPLASH_TEXT) - 1;
+  const uint32_t elapsed = millis() - splashStart;
+  while (splashDrawn < length && elapsed >= (uint32_t) splashDrawn * SPLASH_CHAR_TIME) {
+    lcd.print(SPLASH_TEXT[splashDrawn]);
+    splashDrawn++;
+  }
+  if (splashDrawn == length && elapsed >= (uint32_t) length * SPLASH_CHAR_TIME) {
+    lcd.setCursor(5, 1);
+    lcd.print(VERSION);
+    splashDrawn++;
+  }
+  if (elapsed >= (uint32_t) length * SPLASH_CHAR_TIME + SPLASH_HOLD_TIME) {
+    splashRunning = false;
   }
 }
 
 /*
-  Simple animation to play at startup
-  Total delay: 1600ms
+Resume screen, shown at power on when a pause or a fault left a job unfinished
+-Rotate: Move between Resume/Discard
+-Press: Continue the job from its checkpoint / Log it as aborted and edit its values
 */
-void startupAnimation() {
-  String s = "Robojackets!";
-  lcd.clear();
-  lcd.setCursor(2, 0);
-  for (size_t i = 0; i < s.length(); i++) {
-    lcd.print(s.charAt(i));
-    delay(100);
-  }
-  lcd.setCursor(5, 1);
-  lcd.print(VERSION);
-  delay(500);
-}
-
-// Assumes 2 decimal place precision
-String formatVal(uint32_t num, uint32_t max) {
-  uint8_t maxLength = String(max).length() + 1; // Cannot be greater than 10
-  String returnString = "";
-  String numberString = String(num);
-  
-  // Add leading zeros to match length
-  for (size_t i = 0; i < maxLength - numberString.length() - 1; i++) {
-    if (int(i) == maxLength - 3) {
-        returnString += ".";
+void resumeScreen() {
+  checkpoint.restore(solenoid, sections, windPattern);
+  uint64_t total = (uint64_t) getTurns() * SS_STEPS_PER_REVOLUTION;
+  uint32_t percent = total > 0 ? ((uint64_t) checkpoint.data().stepCount * 100) / total : 0;
+
+  menu.showOptions(resumeMenu, 0);
+  menu.setTitle("Unfinished " + String(percent) + "%");
+  int16_t selected = runMenu();
+  if (selected == 0) {
+    resumeJob();
+  } else if (selected != MENU_NONE) {
+    discardJob();
+  }
+}
+
+// Continues the job in the checkpoint, the record of it from before the power cycle is lost
+void resumeJob() {
+  checkpoint.restore(solenoid, sections, windPattern);
+  startJob();
+  task = Tasks::Spin;
+}
+
+// Logs the job in the checkpoint as aborted and leaves its values to edit
+void discardJob() {
+  checkpoint.restore(solenoid, sections, windPattern);
+  startJob();
+  finishJob(JobStatus::ABORTED, checkpoint.data().stepCount);
+  checkpoint.clear();
+  task = Tasks::ValEdit;
+}
+
+// Resets the job record for a freshly confirmed job
+void startJob() {
+  currentJob = JobRecord();
+  currentJob.length = solenoid.getLength();
+  currentJob.radius = solenoid.getRadius();
+  currentJob.inductance = solenoid.getInductance();
+  currentJob.gauge = solenoid.getGauge();
+  currentJob.turnsTarget = getTurns();
+
+  jobStartTime = millis();
+  currentJob.setupTime = jobStartTime - lastJobEnd;
+  jobSteps = 0;
+  deadlineMonitor.reset();
+}
+
+// Completes the job record and appends it to the production log
+void finishJob(JobStatus status, uint32_t stepCount) {
+  currentJob.status = status;
+  currentJob.turnsWound = stepCount / SS_STEPS_PER_REVOLUTION;
+  currentJob.wallTime = millis() - jobStartTime;
+  currentJob.avgRate = currentJob.windTime > 0 ? ((uint64_t) jobSteps * 1000) / currentJob.windTime : 0;
+  jobLog.append(currentJob);
+  logSummary = jobLog.summary();
+  deadlineMonitor.commit();
+
+  lastJobEnd = millis();
+}
+
+// Serial command: dump the job log
+FLASHMEM void logCommand(String args) {
+  jobLog.dump(console.stream());
+}
+
+// Serial command: production throughput
+FLASHMEM void statsCommand(String args) {
+  JobSummary summary = jobLog.summary();
+  console.stream().println("Jobs: " + String(summary.jobs) + " Completed: " + String(summary.completed));
+  console.stream().println("Coils/h: " + String(summary.coilsPerHourX10 / 10) + "." + String(summary.coilsPerHourX10 % 10));
+  console.stream().println("Avg wind time: " + String(summary.avgWindTime / 1000) + "s");
+}
+
+// Serial command: lifetime motor faults
+FLASHMEM void faultsCommand(String args) {
+  console.stream().println("SS: " + String(faultMonitor.count(Motor::SS_MOTOR)) + " CC: " + String(faultMonitor.count(Motor::CC_MOTOR)));
+}
+
+// Serial command: enable or disable step traces for the next jobs
+FLASHMEM void traceCommand(String args) {
+  if (args == "on") {
+    traceEnabled = true;
+  } else if (args == "off") {
+    traceEnabled = false;
+  }
+  console.stream().println(String("Trace: ") + (traceEnabled ? "on" : "off"));
+}
+
+// Serial command: time the winding step logic on target to find the highest sustainable step rate
+// Drivers stay asleep so the step pins toggle without moving anything
+void benchCommand(String args) {
+  if (task == Tasks::Spin || task == Tasks::Fault) {
+    console.stream().println("Job in progress");
+    return;
+  }
+
+  uint32_t steps = args.length() > 0 ? args.toInt() : BENCH_STEPS;
+  if (steps == 0) {
+    steps = BENCH_STEPS;
+  }
+
+  digitalWrite(SS_SLEEP_PIN, LOW);
+  digitalWrite(CC_SLEEP_PIN, LOW);
+  // The carriage is free to move by hand while asleep
+  carriageKnown = false;
+
+  Solenoid benchSolenoid = Solenoid();
+  benchSolenoid.begin(Preset::A);
+  WindKernel kernel = WindKernel();
+  kernel.begin(benchSolenoid);
+  uint8_t oldPercentComplete = 0;
+  uint32_t skipped = 0;
+
+  uint32_t start = micros();
+  for (uint32_t i = 0; i < steps; i++) {
+    if (kernel.done()) {
+      kernel.restore(0, 0, 0, true, 0);
+    }
+
+    // Same checks as the spin() loop, results are ignored
+    watchdog.feed();
+    if (faultMonitor.tripped() || digitalRead(RE_BUTTON_PIN) == LOW) {
+      skipped++;
+    }
+
+    uint8_t mask = kernel.next();
+    if (mask & STEP_REVERSED) {
+      digitalWrite(CC_DIR_PIN, kernel.forward() ? CC_DIR_SET : !CC_DIR_SET);
+      stepTrace.direction(kernel.forward(), kernel.lastReversal(), micros());
+    }
+    stepTrace.step(mask & (STEP_SS | STEP_CC), micros());
+    if (mask & STEP_CC) {
+      digitalWrite(CC_STEP_PIN, HIGH);
+    }
+    digitalWrite(SS_STEP_PIN, HIGH);
+    digitalWrite(CC_STEP_PIN, LOW);
+    digitalWrite(SS_STEP_PIN, LOW);
+
+    uint8_t newPercentComplete = kernel.percentComplete();
+    if (newPercentComplete != oldPercentComplete) {
+      oldPercentComplete = newPercentComplete;
+    }
+  }
+  uint32_t elapsed = micros() - start;
+  digitalWrite(CC_DIR_PIN, CC_DIR_SET);
+
+  // Logic time plus the shortest pulse the driver accepts
+  uint32_t nsPerStep = ((uint64_t) elapsed * 1000) / steps;
+  uint32_t maxRate = 1000000000UL / (nsPerStep + 2 * DRIVER_MIN_PULSE * 1000);
+  console.stream().println("Step logic: " + String(nsPerStep) + " ns/step over " + String(steps) + " steps");
+  console.stream().println("Highest sustainable rate: " + String(maxRate) + " steps/s");
+  console.stream().println("Current rate: " + String(1000000UL / (2 * MOTOR_DELAY)) + " steps/s");
+  if (skipped > 0) {
+    console.stream().println("Button or fault active during " + String(skipped) + " steps");
+  }
+}
+
+// Serial command: set a job value directly instead of dialing it in
+FLASHMEM void setCommand(String args) {
+  int split = args.indexOf(' ');
+  String key = split < 0 ? args : args.substring(0, split);
+  String text = split < 0 ? String("") : args.substring(split + 1);
+
+  // Parameters are fixed once the job is planned
+  if (task == Tasks::Spin || task == Tasks::Fault) {
+    console.stream().println("Job in progress");
+    return;
+  }
+
+  for (uint8_t i = 0; i < JOB_FIELD_COUNT; i++) {
+    const MenuField &field = jobFields[i];
+    if (key != field.key || field.set == nullptr) {
+      continue;
+    }
+
+    uint32_t value = 0;
+    bool valid = false;
+    if (field.type == MenuFieldType::FIELD_NUMBER) {
+      valid = parseVal(text, value) && value <= field.max;
     } else {
-        returnString += "0";
+      // Choices by label, e.g. AWG24
+      for (uint32_t choice = 0; choice <= field.max && !valid; choice++) {
+        if (field.format(choice).equalsIgnoreCase(text)) {
+          value = choice;
+          valid = true;
+        }
+      }
+    }
+    if (!valid) {
+      console.stream().println("Invalid " + key + ": " + text);
+      return;
     }
+
+    field.set(value);
+    menu.refresh();
+    console.stream().println(key + " = " + (field.format != nullptr ? field.format(value) : formatVal(value, field.max)));
+    return;
   }
-  
-  // Add actual value
-  // Short value case
-  if (numberString.length() < 3) {
-    returnString += "." + numberString;
-    return returnString;
+
+  String keys = "";
+  for (uint8_t i = 0; i < JOB_FIELD_COUNT; i++) {
+    if (jobFields[i].set != nullptr) {
+      keys += String(" ") + jobFields[i].key;
+    }
   }
+  console.stream().println("Fields:" + keys);
+}
 
-  // Split case
-  returnString += numberString.substring(0, numberString.length() - 2);
-  returnString += ".";
-  returnString += numberString.substring(numberString.length() - 2);
-  return returnString;
-}
\ No newline at end of file
+// Serial command: pitch table of the custom pattern, e.g. pitches 100 100 110 120
+FLASHMEM void pitchesCommand(String args) {
+  if (args.length() > 0) {
+    if (task == Tasks::Spin || task == Tasks::Fault) {
+      console.stream().println("Job in progress");
+      return;
+    }
+
+    uint8_t pitches[PATTERN_TABLE_SIZE];
+    uint8_t count = 0;
+    bool valid = true;
+    String list = args + " ";
+    int start = 0;
+    int split;
+    while ((split = list.indexOf(' ', start)) >= 0 && valid) {
+      if (split > start) {
+        long pitch = list.substring(start, split).toInt();
+        valid = count < PATTERN_TABLE_SIZE && pitch >= MIN_PITCH && pitch <= MAX_PITCH;
+        pitches[count++] = pitch;
+      }
+      start = split + 1;
+    }
+    if (!valid || !windPattern.setPitches(pitches, count)) {
+      console.stream().println("Up to " + String(PATTERN_TABLE_SIZE) + " pitches from " + String(MIN_PITCH) + " to " + String(MAX_PITCH) + "%");
+      return;
+    }
+  }
+
+  String table = "";
+  for (uint8_t i = 0; i < windPattern.pitchCount(); i++) {
+    table += String(" ") + String(windPattern.pitches()[i]);
+  }
+  console.stream().println("pitches =" + table);
+}
+
+// Serial command: list, add or clear the sections of a multi-section job
+// e.g. section add 0.50 2.00 120 AWG24 for 120 turns over 2cm, 0.5cm in
+FLASHMEM void sectionCommand(String args) {
+  if (args.length() > 0 && (task == Tasks::Spin || task == Tasks::Fault)) {
+    console.stream().println("Job in progress");
+    return;
+  }
+
+  if (args == "clear") {
+    sections.clear();
+    menu.refresh();
+  } else if (args.startsWith("add ")) {
+    // offset, length, turns, gauge
+    String fields[4];
+    String list = args.substring(4) + " ";
+    uint8_t count = 0;
+    int start = 0;
+    int split;
+    while ((split = list.indexOf(' ', start)) >= 0 && count < 4) {
+      if (split > start) {
+        fields[count++] = list.substring(start, split);
+      }
+      start = split + 1;
+    }
+
+    Section section = {0, 0, 0, 0};
+    bool valid = count == 4 && parseVal(fields[0], section.offset) && parseVal(fields[1], section.length);
+    section.turns = valid ? fields[2].toInt() : 0;
+    WireGauge gauge;
+    const bool gaugeFound = WireTable::find(fields[3].c_str(), gauge);
+    section.gauge = gaugeFound ? gauge : 0;
+    if (!valid || !gaugeFound || sections.add(section) != SolenoidError::NO_ERROR) {
+      console.stream().println("Invalid section, up to " + String(MAX_SECTIONS) + " in order along the mandrel, within " + formatVal(MAX_LENGTH, MAX_LENGTH) + "cm");
+      return;
+    }
+    menu.refresh();
+  } else if (args.length() > 0) {
+    console.stream().println("Usage: section [add <offset cm> <length cm> <turns> <gauge> | clear]");
+    return;
+  }
+
+  if (sections.count() == 0) {
+    console.stream().println("No sections, single solenoid job");
+    return;
+  }
+  for (uint8_t i = 0; i < sections.count(); i++) {
+    const Section &section = sections.get(i);
+    console.stream().println(String(i + 1) + ": offset " + formatVal(section.offset, MAX_LENGTH) + "cm, length " +
+      formatVal(section.length, MAX_LENGTH) + "cm, " + String(section.turns) + " turns, " +
+      Solenoid::gaugeString(static_cast<WireGauge>(section.gauge)));
+  }
+}
+
+// Serial command: the wire table, the loaded enamel grade and diameters measured on the spool
+// e.g. wire grade 1, wire AWG24 541 for 0.541mm over the enamel, wire AWG24 clear
+FLASHMEM void wireCommand(String args) {
+  if (args.length() > 0 && (task == Tasks::Spin || task == Tasks::Fault)) {
+    console.stream().println("Job in progress");
+    return;
+  }
+
+  int split = args.indexOf(' ');
+  String key = split < 0 ? args : args.substring(0, split);
+  String text = split < 0 ? String("") : args.substring(split + 1);
+  uint8_t first = 0;
+  uint8_t last = MAX_GAUGE;
+  if (key == "grade") {
+    if (!wireTable.setGrade(static_cast<WireGrade>(text.toInt()))) {
+      console.stream().println("Grade 1 or 2");
+      return;
+    }
+  } else if (args.length() > 0) {
+    WireGauge gauge;
+    const bool gaugeFound = WireTable::find(key.c_str(), gauge);
+    if (gaugeFound) {
+      first = gauge;
+      last = gauge;
+    }
+    // Just the gauge lists it
+    uint32_t diameter = text == "clear" ? 0 : text.toInt();
+    bool valid = gaugeFound && (text.length() == 0 || ((diameter != 0 || text == "clear") && wireTable.setMeasured(static_cast<WireGauge>(first), diameter)));
+    if (!valid) {
+      console.stream().println("Usage: wire [grade <1|2> | <gauge> <diameter um> | <gauge> clear], diameters from " +
+        formatDiameter(MIN_MEASURED_DIAMETER) + " to " + formatDiameter(MAX_MEASURED_DIAMETER));
+      return;
+    }
+  }
+
+  console.stream().println(WireTable::gradeString(wireTable.getGrade()));
+  for (uint8_t i = first; i <= last; i++) {
+    WireGauge gauge = static_cast<WireGauge>(i);
+    console.stream().println(WireTable::name(gauge) + ": copper " + formatDiameter(WireTable::copperDiameter(gauge)) +
+      ", wound at " + formatDiameter(wireTable.diameter(gauge)) + (wireTable.measured(gauge) != 0 ? " measured" : ""));
+  }
+}
+
+// Serial command: one line of machine state for the fleet controller
+// e.g. state=spin percent=37 turns=1665/4502 jobs=12 completed=11 eta=815 wire=5123/13840 layer=4/11 rate=612
+// eta is seconds, wire is mm used/needed, rate is the averaged SS steps/s
+FLASHMEM void statusCommand(String args) {
+  const char *state;
+  switch (task) {
+    case Tasks::ChoosePreset: state = "preset"; break;
+    case Tasks::ValEdit: state = "edit"; break;
+    case Tasks::ConfirmScreen: state = "confirm"; break;
+    case Tasks::Spin: state = "spin"; break;
+    case Tasks::Fault: state = "fault"; break;
+    case Tasks::End: state = "done"; break;
+    case Tasks::Resume: state = "resume"; break;
+    default: state = "unknown";
+  }
+
+  // Progress is only meaningful once a job was planned
+  bool planned = task == Tasks::Spin || task == Tasks::Fault || task == Tasks::End;
+  uint32_t turns = planned ? windKernel.stepCount() / SS_STEPS_PER_REVOLUTION : 0;
+  // Layer being wound, the estimate only counts the ones finished
+  uint32_t layer = planned ? jobEstimate.layersDone() + 1 : 0;
+  if (layer > jobEstimate.layerCount()) {
+    layer = jobEstimate.layerCount();
+  }
+  console.stream().println(String("state=") + state +
+    " percent=" + String(planned ? windKernel.percentComplete() : 0) +
+    " turns=" + String(turns) + "/" + String(getTurns()) +
+    " jobs=" + String(logSummary.jobs) +
+    " completed=" + String(logSummary.completed) +
+    " eta=" + String(planned ? jobEstimate.remainingTime(windKernel) : 0) +
+    " wire=" + String(planned ? jobEstimate.wireUsed(windKernel) : 0) + "/" + String(planned ? jobEstimate.wireTotal() : 0) +
+    " layer=" + String(layer) + "/" + String(planned ? jobEstimate.layerCount() : 0) +
+    " rate=" + String(planned ? jobEstimate.rate() : 0) +
+    " overruns=" + String(deadlineMonitor.job().overruns) +
+    " late=" + String(deadlineMonitor.job().worstLateness));
+}
+
+// Serial command: start a job with the current values, as if confirmed on the screen
+FLASHMEM void startCommand(String args) {
+  if (task == Tasks::Spin || task == Tasks::Fault) {
+    console.stream().println("Job in progress");
+    return;
+  }
+  if (task == Tasks::Resume) {
+    console.stream().println("Unfinished job, resume or discard it first");
+    return;
+  }
+  if (getTurns() == 0) {
+    console.stream().println("No turns to wind, set the job values first");
+    return;
+  }
+
+  // The screen waiting in runMenu() returns once it sees the new task
+  checkpoint.clear();
+  startJob();
+  task = Tasks::Spin;
+  console.stream().println("Started " + String(getTurns()) + " turns");
+}
+
+// Serial command: continue the job left unfinished at power on, or log it as aborted
+FLASHMEM void resumeCommand(String args) {
+  if (task != Tasks::Resume) {
+    console.stream().println("Nothing to resume");
+    return;
+  }
+  args.trim();
+  if (args == "discard") {
+    discardJob();
+    console.stream().println("Discarded");
+  } else if (args.length() == 0) {
+    resumeJob();
+    console.stream().println("Resumed at " + String(checkpoint.data().stepCount / SS_STEPS_PER_REVOLUTION) + " of " + String(getTurns()) + " turns");
+  } else {
+    console.stream().println("Usage: resume [discard]");
+  }
+}
+
+// Serial command: step deadline counters of the last job and of the machine
+FLASHMEM void timingCommand(String args) {
+  const DeadlineStats *stats[] = {&deadlineMonitor.job(), &deadlineMonitor.lifetime()};
+  const char *names[] = {"job", "machine"};
+  for (uint8_t i = 0; i < 2; i++) {
+    String line = String(names[i]) +
+      " deadlines=" + String(stats[i]->deadlines) +
+      " overruns=" + String(stats[i]->overruns) +
+      " worst=" + String(stats[i]->worstLateness) + "us";
+    if (stats[i]->overruns > 0) {
+      line += " in " + DeadlineMonitor::subsystemName(static_cast<Subsystem>(stats[i]->worstSubsystem));
+    }
+    for (uint8_t sub = 0; sub < SUBSYSTEM_COUNT; sub++) {
+      line += " " + DeadlineMonitor::subsystemName(static_cast<Subsystem>(sub)) + "=" + String(stats[i]->subsystemOverruns[sub]);
+    }
+    console.stream().println(line);
+  }
+  console.stream().println("watchdog resets=" + String(deadlineMonitor.watchdogResets()) + (watchdogReset ? ", last reset was the watchdog" : ""));
+}
+
+// Serial command: home the carriage before the next job, after moving it by hand
+FLASHMEM void homeCommand(String args) {
+  if (task == Tasks::Spin || task == Tasks::Fault) {
+    console.stream().println("Job in progress");
+    return;
+  }
+  if (carriageKnown) {
+    console.stream().println("Carriage at " + String(carriageAt / 1000.0, 3) + "cm, the next job homes it");
+  } else {
+    console.stream().println("The next job homes the carriage");
+  }
+  carriageKnown = false;
+}
+
+// Serial command: schedule the SS rate by layer radius and carriage position for the next jobs
+FLASHMEM void speedCommand(String args) {
+  if (task == Tasks::Spin || task == Tasks::Fault) {
+    console.stream().println("Job in progress");
+    return;
+  }
+  if (args == "on") {
+    speedProfiled = true;
+  } else if (args == "off") {
+    speedProfiled = false;
+  }
+  console.stream().println(String("Speed profile: ") + (speedProfiled ? "on" : "off") +
+    ", " + String(SPEED_START_RATE) + " to " + String(SPEED_MAX_RATE) + " steps/s" +
+    ", wire " + String(SPEED_WIRE_LIMIT) + "mm/s");
+  if (speedProfiled && dmaStepping) {
+    console.stream().println("Steps from the loop while on, not by DMA");
+  }
+}